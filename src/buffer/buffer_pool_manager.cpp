@@ -28,6 +28,7 @@ BufferPoolManager::~BufferPoolManager() {
 
 /*根据逻辑页号获取对应的数据页，如果该数据页不在内存中，则需要从磁盘中进行读取；*/
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   frame_id_t frame_id;
   Page *page_ptr;
   auto page_itr = page_table_.find(page_id);
@@ -65,6 +66,7 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
 
 /*分配一个新的数据页，并将逻辑页号于page_id中返回*/
 Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   // 查看缓冲池中是否有空闲页（数Pin的个数）
   size_t i;
   frame_id_t frame_id;
@@ -102,6 +104,7 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
 
 /*释放一个数据页*/
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   frame_id_t frame_id;
   Page *page_ptr;
   // 查找要删除的页
@@ -126,6 +129,8 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   page_ptr->page_id_ = INVALID_PAGE_ID;
   page_ptr->pin_count_ = 0;
   page_ptr->is_dirty_ = false;
+  // 从replacer中移除，避免同一个frame既在free_list_又能被换出
+  replacer_->Pin(frame_id);
   // 添加到free_list_
   free_list_.emplace_back(frame_id);
   return true;
@@ -133,6 +138,7 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
 
 /*取消固定一个数据页*/
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   frame_id_t frame_id;
   Page *page_ptr;
   auto page_itr = page_table_.find(page_id);
@@ -140,14 +146,15 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
     return true;
   frame_id = page_itr->second;
   page_ptr = &pages_[frame_id];
-  page_ptr->is_dirty_ = is_dirty;
+  // 其他持有者写过的页不能因为本次只读而丢失脏标记
+  page_ptr->is_dirty_ = page_ptr->is_dirty_ || is_dirty;
   if (page_ptr->pin_count_ == 0)
     return false;
   else
     page_ptr->pin_count_--;
+  // 页仍在缓冲池中，只交给replacer；放进free_list_会让之后重新pin的页被新页覆盖
   if (page_ptr->pin_count_ == 0) {
     replacer_->Unpin(frame_id);
-    free_list_.emplace_back(frame_id);
   }
   return true;
 }
@@ -155,6 +162,7 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
 
 /*将数据页转储到磁盘中*/
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   auto page_itr = page_table_.find(page_id);
   frame_id_t frame_id;
   Page *page_ptr;
@@ -185,6 +193,7 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
 
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   bool res = true;
   for (size_t i = 0; i < pool_size_; i++) {
     if (pages_[i].pin_count_ != 0) {
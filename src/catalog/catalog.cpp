@@ -1,5 +1,7 @@
 #include "catalog/catalog.h"
 
+#include <algorithm>
+
 void CatalogMeta::SerializeTo(char *buf) const {
   ASSERT(GetSerializedSize() <= PAGE_SIZE, "Failed to serialize catalog metadata to disk.");
   MACH_WRITE_UINT32(buf, CATALOG_METADATA_MAGIC_NUM);
@@ -92,6 +94,12 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
 
 CatalogManager::~CatalogManager() {
   FlushCatalogMetaPage();
+  // DML维护的计数器在关闭时落盘
+  for (auto iter : tables_) {
+    if (iter.second->GetStatistics()->IsDirty()) {
+      FlushTableMetaPage(iter.first);
+    }
+  }
   delete catalog_meta_;
   for (auto iter : tables_) {
     delete iter.second;
@@ -103,16 +111,36 @@ CatalogManager::~CatalogManager() {
 
 /* CreateTable */
 dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schema, Transaction *txn,
-                                    TableInfo *&table_info) {
-  // step1: 检查table是否已经存在
+                                    TableInfo *&table_info, TableLayout layout,
+                                    const std::vector<uint32_t> &dictionary_columns) {
+  // step1: 检查table是否已经存在，字典编码只能用于一个值放得进字典页的char列
   if (table_names_.find(table_name) != table_names_.end())
     return DB_TABLE_ALREADY_EXIST;
+  for (auto column_id : dictionary_columns) {
+    if (column_id >= schema->GetColumnCount() || schema->GetColumn(column_id)->GetType() != TypeId::kTypeChar ||
+        schema->GetColumn(column_id)->GetLength() > Dictionary::MAX_VALUE_LENGTH)
+      return DB_FAILED;
+  }
   // step2: 新建TableInfo,TableMetaData,TableHeap
   table_info = TableInfo::Create();
   table_id_t table_id = next_table_id_++;
   Schema *deep_copy_schema = Schema::DeepCopySchema(schema);
-  TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, deep_copy_schema, nullptr, log_manager_, lock_manager_);
-  TableMetadata *meta_data = TableMetadata::Create(table_id, table_name, table_heap->GetFirstPageId(), deep_copy_schema);
+  std::vector<Dictionary *> dictionaries;
+  if (!dictionary_columns.empty()) {
+    dictionaries.resize(schema->GetColumnCount(), nullptr);
+    for (auto column_id : dictionary_columns) {
+      if (dictionaries[column_id] == nullptr)
+        dictionaries[column_id] = Dictionary::Create(buffer_pool_manager_);
+    }
+  }
+  TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, deep_copy_schema, nullptr, log_manager_,
+                                            lock_manager_, layout, dictionaries);
+  TableMetadata *meta_data =
+      TableMetadata::Create(table_id, table_name, table_heap->GetFirstPageId(), deep_copy_schema, layout);
+  for (uint32_t i = 0; i < dictionaries.size(); i++) {
+    if (dictionaries[i] != nullptr)
+      meta_data->SetDictionaryPage(i, dictionaries[i]->GetFirstPageId());
+  }
   table_info->Init(meta_data, table_heap);
   // step3: 更新CatalogManager和CatalogMetaData
   table_names_[table_name] = table_id;
@@ -120,9 +148,9 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   page_id_t meta_data_page_id;
   Page *meta_data_page = buffer_pool_manager_->NewPage(meta_data_page_id);
   ASSERT(meta_data_page != nullptr, "NULL in New a table meta data Page");
-  meta_data->SerializeTo(meta_data_page->GetData());
   catalog_meta_->table_meta_pages_[table_id] = meta_data_page_id;
-  buffer_pool_manager_->UnpinPage(meta_data_page_id,true);
+  buffer_pool_manager_->UnpinPage(meta_data_page_id, false);
+  FlushTableMetaPage(table_id);
   FlushCatalogMetaPage();
   return DB_SUCCESS;
 }
@@ -146,10 +174,13 @@ dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const {
 /* CreateIndex */
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<std::string> &index_keys, Transaction *txn,
-                                    IndexInfo *&index_info, const string &index_type) {
+                                    IndexInfo *&index_info, const string &index_type, bool unique,
+                                    const std::vector<std::string> &include_keys) {
   // step1: 检查Table是否已经存在，Index是否已经存在
   if (table_names_.find(table_name) == table_names_.end()) return DB_TABLE_NOT_EXIST;
   if (index_names_[table_name].find(index_name) != index_names_[table_name].end()) return DB_INDEX_ALREADY_EXIST;
+  // 哈希索引不会被选为覆盖索引，INCLUDE列没有用处
+  if (index_type == "hash" && !include_keys.empty()) return DB_FAILED;
   // step2: 新建IndexMetaData,IndexInfo
   index_info = IndexInfo::Create();
   index_id_t index_id = next_index_id_++;
@@ -162,10 +193,29 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
       return DB_COLUMN_NAME_NOT_EXIST;
     key_map.push_back(key_index);
   }
+  // INCLUDE的列跟在key列之后，已经是key列的不再重复存放
+  uint32_t include_count = 0;
+  for (const auto &include_key_name : include_keys) {
+    uint32_t key_index;
+    if (table_info->GetSchema()->GetColumnIndex(include_key_name, key_index) == DB_COLUMN_NAME_NOT_EXIST)
+      return DB_COLUMN_NAME_NOT_EXIST;
+    if (std::find(key_map.begin(), key_map.end(), key_index) == key_map.end()) {
+      key_map.push_back(key_index);
+      include_count++;
+    }
+  }
   // 新建IndexMetaData并init index_info
-  IndexMetadata *meta_data = IndexMetadata::Create(index_id, index_name, table_id, key_map);
+  IndexMetadata *meta_data = IndexMetadata::Create(index_id, index_name, table_id, key_map, unique, include_count,
+                                                   index_type);
   index_info->Init(meta_data, table_info, buffer_pool_manager_);
-  // step3: 更新CatalogMetaData和CatalogManager
+  // step3: 表中已有的记录排序后自底向上装入索引，唯一索引的键重复时建索引失败
+  if (index_info->GetIndex() == nullptr ||
+      index_info->GetIndex()->BulkLoad(table_info->GetTableHeap(), key_map, txn) != DB_SUCCESS) {
+    delete index_info;
+    index_info = nullptr;
+    return DB_FAILED;
+  }
+  // step4: 更新CatalogMetaData和CatalogManager
   if (index_names_.find(table_name) == index_names_.end()){
     std::unordered_map<std::string, index_id_t> map;
     map[index_name] = index_id;
@@ -181,6 +231,7 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   meta_data->SerializeTo(meta_data_page->GetData());
   catalog_meta_->index_meta_pages_[index_id] = meta_data_page_id;
   buffer_pool_manager_->UnpinPage(meta_data_page_id, true);
+  buffer_pool_manager_->FlushPage(meta_data_page_id);
   FlushCatalogMetaPage();
   return DB_SUCCESS;
 }
@@ -232,8 +283,12 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
   auto table_id_it = table_names_.find(table_name);
   if (table_id_it == table_names_.end()) return DB_TABLE_NOT_EXIST;
   table_id_t table_id = table_id_it->second;
-  // 删除储存table的页和储存matadata的页
+  // 删除储存table的页、字典页和储存matadata的页
   if (!buffer_pool_manager_->DeletePage(tables_[table_id]->GetRootPageId())) return DB_FAILED;
+  TableHeap *table_heap = tables_[table_id]->GetTableHeap();
+  for (uint32_t i = 0; i < tables_[table_id]->GetSchema()->GetColumnCount(); i++) {
+    if (table_heap->GetDictionary(i) != nullptr) table_heap->GetDictionary(i)->Destroy();
+  }
   if (!buffer_pool_manager_->DeletePage(catalog_meta_->table_meta_pages_[table_id])) return DB_FAILED;
   // 删除各个map中对应的table
   tables_.erase(tables_.find(table_id));
@@ -306,6 +361,54 @@ dberr_t CatalogManager::FlushCatalogMetaPage() const {
   return DB_SUCCESS;
 }
 
+/* 全表扫描重新计算统计信息并写回table meta page */
+dberr_t CatalogManager::AnalyzeTable(const std::string &table_name) {
+  TableInfo *table_info = nullptr;
+  if (GetTable(table_name, table_info) != DB_SUCCESS) return DB_TABLE_NOT_EXIST;
+  TableStatistics *statistics = table_info->GetStatistics();
+  TableHeap *table_heap = table_info->GetTableHeap();
+  statistics->Analyze(table_heap);
+  // 取值很少且重复多的char列改用字典编码，值放不进字典页的列除外
+  Schema *schema = table_info->GetSchema();
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    double distinct = statistics->GetColumnStatistics(i).GetDistinctCount();
+    if (table_info->GetLayout() != TableLayout::kRow || schema->GetColumn(i)->GetType() != TypeId::kTypeChar ||
+        schema->GetColumn(i)->GetLength() > Dictionary::MAX_VALUE_LENGTH || table_heap->GetDictionary(i) != nullptr || distinct < 1 || distinct > DICT_AUTO_MAX_DISTINCT ||
+        distinct * DICT_AUTO_MIN_REPEAT > statistics->GetRowCount())
+      continue;
+    Dictionary *dictionary = Dictionary::Create(buffer_pool_manager_);
+    if (dictionary == nullptr) return DB_FAILED;
+    if (!table_heap->EnableDictionary(i, dictionary)) {
+      dictionary->Destroy();
+      delete dictionary;
+      continue;
+    }
+    table_info->GetTableMeta()->SetDictionaryPage(i, dictionary->GetFirstPageId());
+  }
+  return FlushTableMetaPage(table_info->GetTableId());
+}
+
+/* 统计信息紧跟在TableMetadata之后，放不下时缩小直方图 */
+dberr_t CatalogManager::FlushTableMetaPage(table_id_t table_id) {
+  auto page_it = catalog_meta_->table_meta_pages_.find(table_id);
+  if (page_it == catalog_meta_->table_meta_pages_.end()) return DB_TABLE_NOT_EXIST;
+  TableInfo *table_info = tables_[table_id];
+  auto meta_data_page = buffer_pool_manager_->FetchPage(page_it->second);
+  if (meta_data_page == nullptr) return DB_FAILED;
+  uint32_t meta_size = table_info->GetTableMeta()->SerializeTo(meta_data_page->GetData());
+  TableStatistics *statistics = table_info->GetStatistics();
+  statistics->Fit(PAGE_SIZE - meta_size);
+  if (meta_size + statistics->GetSerializedSize() <= PAGE_SIZE) {
+    statistics->SerializeTo(meta_data_page->GetData() + meta_size);
+  } else if (meta_size + sizeof(uint32_t) <= PAGE_SIZE) {
+    // 列太多时不保存统计信息
+    MACH_WRITE_UINT32(meta_data_page->GetData() + meta_size, 0);
+  }
+  buffer_pool_manager_->UnpinPage(page_it->second, true);
+  buffer_pool_manager_->FlushPage(page_it->second);
+  return DB_SUCCESS;
+}
+
 /* 读取page_id存的table_meta_data,并更新CatalogManager*/
 dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t page_id) {
   // 拿到存meta_data的页
@@ -315,15 +418,22 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
   TableInfo *table_info = TableInfo::Create();
   // meta_data_page->RLatch();
   TableMetadata *meta_data = nullptr;
-  TableMetadata::DeserializeFrom(meta_data_page->GetData(), meta_data);
+  uint32_t meta_size = TableMetadata::DeserializeFrom(meta_data_page->GetData(), meta_data);
   //  meta_data_page->RUnlatch();
   ASSERT(table_id == meta_data->GetTableId(), "False Table ID in LoadTable!");
   // 插入table_names_
   table_names_[meta_data->GetTableName()] = table_id;
   // init table_info插入tables_
   // 新建table_heap
-  TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, meta_data->GetFirstPageId(), meta_data->GetSchema(),log_manager_, lock_manager_);
+  std::vector<Dictionary *> dictionaries;
+  for (auto iter : meta_data->GetDictionaryPages()) {
+    dictionaries.resize(meta_data->GetSchema()->GetColumnCount(), nullptr);
+    dictionaries[iter.first] = Dictionary::Load(buffer_pool_manager_, iter.second);
+  }
+  TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, meta_data->GetFirstPageId(), meta_data->GetSchema(),
+                                            log_manager_, lock_manager_, meta_data->GetLayout(), dictionaries);
   table_info->Init(meta_data, table_heap);
+  table_info->GetStatistics()->DeserializeFrom(meta_data_page->GetData() + meta_size);
   tables_[table_id] = table_info;
   buffer_pool_manager_->UnpinPage(page_id, false);
   return DB_SUCCESS;
@@ -1,12 +1,20 @@
 #include "catalog/indexes.h"
 
 IndexMetadata::IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                             const std::vector<uint32_t> &key_map)
-    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map) {}
+                             const std::vector<uint32_t> &key_map, bool unique, uint32_t include_count,
+                             const std::string &index_type)
+    : index_id_(index_id),
+      index_name_(index_name),
+      table_id_(table_id),
+      key_map_(key_map),
+      unique_(unique),
+      include_count_(include_count),
+      index_type_(index_type) {}
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name, const table_id_t table_id,
-                                     const vector<uint32_t> &key_map) {
-  return new IndexMetadata(index_id, index_name, table_id, key_map);
+                                     const vector<uint32_t> &key_map, bool unique, uint32_t include_count,
+                                     const string &index_type) {
+  return new IndexMetadata(index_id, index_name, table_id, key_map, unique, include_count, index_type);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
@@ -35,6 +43,17 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
     MACH_WRITE_UINT32(buf, col_index);
     buf += 4;
   }
+  // unique
+  MACH_WRITE_UINT32(buf, unique_ ? 1 : 0);
+  buf += 4;
+  // include count
+  MACH_WRITE_UINT32(buf, include_count_);
+  buf += 4;
+  // index type
+  MACH_WRITE_UINT32(buf, index_type_.length());
+  buf += 4;
+  MACH_WRITE_STRING(buf, index_type_);
+  buf += index_type_.length();
   ASSERT(buf - p == ofs, "Unexpected serialize size.");
   return ofs;
 }
@@ -42,7 +61,8 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
 /* 获得序列化的长度 */
 uint32_t IndexMetadata::GetSerializedSize() const {
   return sizeof(uint32_t) + sizeof(index_id_t) + sizeof(uint32_t) + index_name_.size() * sizeof(char) +
-         sizeof(table_id_t) + sizeof(uint32_t) + key_map_.size() * sizeof(uint32_t);
+         sizeof(table_id_t) + sizeof(uint32_t) + key_map_.size() * sizeof(uint32_t) + sizeof(uint32_t) +
+         sizeof(uint32_t) + sizeof(uint32_t) + index_type_.size() * sizeof(char);
 }
 
 uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
@@ -75,34 +95,49 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
     buf += 4;
     key_map.push_back(key_index);
   }
+  // unique
+  bool unique = MACH_READ_UINT32(buf) != 0;
+  buf += 4;
+  // include count
+  uint32_t include_count = MACH_READ_UINT32(buf);
+  buf += 4;
+  // index type
+  len = MACH_READ_UINT32(buf);
+  buf += 4;
+  std::string index_type(buf, len);
+  buf += len;
   // allocate space for index meta data
-  index_meta = new IndexMetadata(index_id, index_name, table_id, key_map);
+  index_meta = new IndexMetadata(index_id, index_name, table_id, key_map, unique, include_count, index_type);
   return buf - p;
 }
 
 Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type) {
-  size_t max_size = 0;
-  for (auto col : key_schema_->GetColumns()) {
-    max_size += col->GetLength();
+  // 键按KeyManager的保序编码存放
+  size_t max_size = KeyManager::GetEncodedSize(key_schema_);
+  // 非唯一索引的键带RowId后缀
+  bool unique = meta_data_->IsUnique();
+  if (!unique) {
+    max_size += KeyManager::SUFFIX_SIZE;
   }
 
   if (index_type == "bptree") {
-    if (max_size <= 8)
-      max_size = 16;
-    else if (max_size <= 24)
-      max_size = 32;
-    else if (max_size <= 56)
-      max_size = 64;
-    else if (max_size <= 120)
-      max_size = 128;
-    else if (max_size <= 248)
-      max_size = 256;
-    else {
+    // 叶子按实际键长和前缀长度计算容量，不再向上取整
+    if (max_size > 256) {
+      LOG(ERROR) << "GenericKey size is too large";
+      return nullptr;
+    }
+  } else if (index_type == "hash") {
+    // 桶页按实际键长存放entry
+    if (max_size > 256) {
       LOG(ERROR) << "GenericKey size is too large";
       return nullptr;
     }
+    return new ExtendibleHashIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, unique,
+                                   meta_data_->GetIncludeCount());
   } else {
+    LOG(ERROR) << "Unknown index type " << index_type;
     return nullptr;
   }
-  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, unique,
+                            meta_data_->GetIncludeCount());
 }
\ No newline at end of file
@@ -0,0 +1,352 @@
+#include "catalog/statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "common/hash_util.h"
+#include "storage/table_heap.h"
+
+namespace {
+
+constexpr uint32_t HLL_INDEX_BITS = 6;
+static_assert((1U << HLL_INDEX_BITS) == STATS_HLL_REGISTERS, "HLL index bits do not match the register count.");
+
+}  // namespace
+
+ColumnStatistics::ColumnStatistics(TypeId type) : type_(type) {}
+
+bool ColumnStatistics::ToDouble(const Field &field, double *value) {
+  if (field.IsNull()) {
+    return false;
+  }
+  char buf[sizeof(int32_t)];
+  if (field.GetTypeId() == TypeId::kTypeInt) {
+    field.SerializeTo(buf);
+    *value = MACH_READ_INT32(buf);
+    return true;
+  }
+  if (field.GetTypeId() == TypeId::kTypeFloat) {
+    field.SerializeTo(buf);
+    *value = MACH_READ_FROM(float, buf);
+    return true;
+  }
+  return false;
+}
+
+void ColumnStatistics::AddDistinct(const Field &field) {
+  if (field.IsNull()) {
+    return;
+  }
+  uint64_t hash;
+  if (field.GetTypeId() == TypeId::kTypeChar) {
+    hash = HashBytes(field.GetData(), field.GetLength());
+  } else {
+    char buf[sizeof(int32_t)];
+    field.SerializeTo(buf);
+    hash = HashBytes(buf, sizeof(buf));
+  }
+  uint32_t index = hash & (STATS_HLL_REGISTERS - 1);
+  uint64_t rest = hash >> HLL_INDEX_BITS;
+  // 剩余位中第一个1出现的位置
+  uint8_t rank = 1;
+  while (rank <= 64 - HLL_INDEX_BITS && (rest & 1) == 0) {
+    rest >>= 1;
+    rank++;
+  }
+  registers_[index] = std::max(registers_[index], rank);
+}
+
+double ColumnStatistics::GetDistinctCount() const {
+  double m = STATS_HLL_REGISTERS;
+  double sum = 0;
+  uint32_t zeros = 0;
+  for (auto reg : registers_) {
+    sum += std::ldexp(1.0, -reg);
+    zeros += reg == 0;
+  }
+  if (zeros == STATS_HLL_REGISTERS) {
+    return 0;
+  }
+  double estimate = 0.709 * m * m / sum;
+  // 基数较小时用linear counting修正
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * std::log(m / zeros);
+  }
+  return estimate;
+}
+
+void ColumnStatistics::BuildHistogram(std::vector<double> &values, uint32_t bucket_count) {
+  bounds_.clear();
+  if (values.empty() || bucket_count == 0) {
+    return;
+  }
+  std::sort(values.begin(), values.end());
+  size_t n = values.size();
+  for (uint32_t i = 0; i <= bucket_count; i++) {
+    bounds_.push_back(values[std::min(n - 1, i * n / bucket_count)]);
+  }
+}
+
+void ColumnStatistics::ShrinkHistogram(uint32_t bucket_count) {
+  uint32_t old_count = GetBucketCount();
+  if (bucket_count >= old_count) {
+    return;
+  }
+  if (bucket_count == 0) {
+    bounds_.clear();
+    return;
+  }
+  std::vector<double> bounds;
+  for (uint32_t i = 0; i <= bucket_count; i++) {
+    bounds.push_back(bounds_[i * old_count / bucket_count]);
+  }
+  bounds_.swap(bounds);
+}
+
+double ColumnStatistics::EstimateLessThan(double value, bool strict) const {
+  uint32_t bucket_count = GetBucketCount();
+  double fraction = 0;
+  for (uint32_t i = 0; i < bucket_count; i++) {
+    double lo = bounds_[i];
+    double hi = bounds_[i + 1];
+    if (strict ? hi < value : hi <= value) {
+      fraction += 1;
+    } else if (lo < value) {
+      fraction += (value - lo) / (hi - lo);
+    }
+  }
+  return fraction / bucket_count;
+}
+
+double ColumnStatistics::EstimateSelectivity(const std::string &op, const Field &value) const {
+  // 没有统计信息可用时的默认值
+  constexpr double DEFAULT_EQ = 0.005;
+  constexpr double DEFAULT_RANGE = 1.0 / 3;
+  if (value.IsNull()) {
+    return 0;
+  }
+  double not_null = 1 - null_frac_;
+  double ndv = GetDistinctCount();
+  double eq = ndv >= 1 ? 1 / ndv : DEFAULT_EQ;
+  double v;
+  if (bounds_.empty() || !ToDouble(value, &v)) {
+    if (op == "=") return not_null * eq;
+    if (op == "<>") return not_null * (1 - eq);
+    return not_null * DEFAULT_RANGE;
+  }
+  if (op == "=" || op == "<>") {
+    if (v < bounds_.front() || v > bounds_.back()) {
+      eq = 0;
+    } else {
+      // 高频值会占满至少一个桶
+      eq = std::max(eq, EstimateLessThan(v, false) - EstimateLessThan(v, true));
+    }
+    return not_null * (op == "=" ? eq : 1 - eq);
+  }
+  if (op == "<") return not_null * EstimateLessThan(v, true);
+  if (op == "<=") return not_null * EstimateLessThan(v, false);
+  if (op == ">") return not_null * (1 - EstimateLessThan(v, false));
+  if (op == ">=") return not_null * (1 - EstimateLessThan(v, true));
+  return not_null * DEFAULT_RANGE;
+}
+
+uint32_t ColumnStatistics::SerializeTo(char *buf) const {
+  char *p = buf;
+  MACH_WRITE_UINT32(buf, static_cast<uint32_t>(type_));
+  buf += 4;
+  MACH_WRITE_TO(double, buf, null_frac_);
+  buf += sizeof(double);
+  memcpy(buf, registers_, STATS_HLL_REGISTERS);
+  buf += STATS_HLL_REGISTERS;
+  MACH_WRITE_UINT32(buf, bounds_.size());
+  buf += 4;
+  for (auto bound : bounds_) {
+    MACH_WRITE_TO(double, buf, bound);
+    buf += sizeof(double);
+  }
+  return buf - p;
+}
+
+uint32_t ColumnStatistics::GetSerializedSize() const {
+  return 8 + sizeof(double) + STATS_HLL_REGISTERS + bounds_.size() * sizeof(double);
+}
+
+uint32_t ColumnStatistics::DeserializeFrom(char *buf, ColumnStatistics *column_stats) {
+  char *p = buf;
+  column_stats->type_ = static_cast<TypeId>(MACH_READ_UINT32(buf));
+  buf += 4;
+  column_stats->null_frac_ = MACH_READ_FROM(double, buf);
+  buf += sizeof(double);
+  memcpy(column_stats->registers_, buf, STATS_HLL_REGISTERS);
+  buf += STATS_HLL_REGISTERS;
+  uint32_t bound_count = MACH_READ_UINT32(buf);
+  buf += 4;
+  column_stats->bounds_.clear();
+  for (uint32_t i = 0; i < bound_count; i++) {
+    column_stats->bounds_.push_back(MACH_READ_FROM(double, buf));
+    buf += sizeof(double);
+  }
+  return buf - p;
+}
+
+TableStatistics::TableStatistics(Schema *schema) : schema_(schema) {
+  for (auto column : schema_->GetColumns()) {
+    columns_.emplace_back(column->GetType());
+  }
+}
+
+void TableStatistics::Analyze(TableHeap *table_heap) {
+  uint32_t column_count = schema_->GetColumnCount();
+  std::vector<ColumnStatistics> columns;
+  for (auto column : schema_->GetColumns()) {
+    columns.emplace_back(column->GetType());
+  }
+  std::vector<uint64_t> null_counts(column_count, 0);
+  std::vector<uint64_t> seen(column_count, 0);
+  std::vector<std::vector<double>> samples(column_count);
+  std::mt19937_64 random(column_count);
+  uint64_t row_count = 0;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+    row_count++;
+    for (uint32_t i = 0; i < column_count; i++) {
+      Field *field = it->GetField(i);
+      if (field->IsNull()) {
+        null_counts[i]++;
+        continue;
+      }
+      columns[i].AddDistinct(*field);
+      double value;
+      if (!ColumnStatistics::ToDouble(*field, &value)) {
+        continue;
+      }
+      // reservoir sampling，直方图最多由STATS_SAMPLE_SIZE个值构建
+      uint64_t pos = seen[i]++;
+      if (pos < STATS_SAMPLE_SIZE) {
+        samples[i].push_back(value);
+      } else {
+        uint64_t slot = random() % (pos + 1);
+        if (slot < STATS_SAMPLE_SIZE) {
+          samples[i][slot] = value;
+        }
+      }
+    }
+  }
+  for (uint32_t i = 0; i < column_count; i++) {
+    columns[i].SetNullFraction(row_count == 0 ? 0 : static_cast<double>(null_counts[i]) / row_count);
+    columns[i].BuildHistogram(samples[i], STATS_HISTOGRAM_BUCKETS);
+  }
+  std::vector<page_id_t> page_ids;
+  table_heap->GetPageIds(page_ids);
+  std::lock_guard<std::mutex> guard(latch_);
+  columns_.swap(columns);
+  row_count_ = row_count;
+  page_count_ = page_ids.size();
+  modified_rows_ = 0;
+  analyzed_ = true;
+  dirty_ = true;
+}
+
+void TableStatistics::OnInsert(const Row &row) {
+  std::lock_guard<std::mutex> guard(latch_);
+  row_count_++;
+  modified_rows_++;
+  dirty_ = true;
+  for (uint32_t i = 0; i < columns_.size() && i < row.GetFieldCount(); i++) {
+    columns_[i].AddDistinct(*row.GetField(i));
+  }
+}
+
+void TableStatistics::OnDelete() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (row_count_ > 0) {
+    row_count_--;
+  }
+  modified_rows_++;
+  dirty_ = true;
+}
+
+void TableStatistics::OnUpdate(const Row &new_row) {
+  std::lock_guard<std::mutex> guard(latch_);
+  modified_rows_++;
+  dirty_ = true;
+  for (uint32_t i = 0; i < columns_.size() && i < new_row.GetFieldCount(); i++) {
+    columns_[i].AddDistinct(*new_row.GetField(i));
+  }
+}
+
+void TableStatistics::Fit(uint32_t max_size) {
+  std::lock_guard<std::mutex> guard(latch_);
+  uint32_t bucket_count = STATS_HISTOGRAM_BUCKETS;
+  while (GetSerializedSize() > max_size && bucket_count > 0) {
+    bucket_count /= 2;
+    for (auto &column : columns_) {
+      column.ShrinkHistogram(bucket_count);
+    }
+  }
+}
+
+uint32_t TableStatistics::SerializeTo(char *buf) {
+  std::lock_guard<std::mutex> guard(latch_);
+  char *p = buf;
+  MACH_WRITE_UINT32(buf, TABLE_STATISTICS_MAGIC_NUM);
+  buf += 4;
+  MACH_WRITE_UINT32(buf, analyzed_);
+  buf += 4;
+  MACH_WRITE_TO(uint64_t, buf, row_count_);
+  buf += 8;
+  MACH_WRITE_UINT32(buf, page_count_);
+  buf += 4;
+  MACH_WRITE_TO(uint64_t, buf, modified_rows_);
+  buf += 8;
+  MACH_WRITE_UINT32(buf, columns_.size());
+  buf += 4;
+  for (const auto &column : columns_) {
+    buf += column.SerializeTo(buf);
+  }
+  dirty_ = false;
+  return buf - p;
+}
+
+uint32_t TableStatistics::GetSerializedSize() const {
+  uint32_t size = 32;
+  for (const auto &column : columns_) {
+    size += column.GetSerializedSize();
+  }
+  return size;
+}
+
+uint32_t TableStatistics::DeserializeFrom(char *buf) {
+  char *p = buf;
+  // 老版本的表没有统计信息
+  if (MACH_READ_UINT32(buf) != TABLE_STATISTICS_MAGIC_NUM) {
+    return 0;
+  }
+  buf += 4;
+  bool analyzed = MACH_READ_UINT32(buf);
+  buf += 4;
+  uint64_t row_count = MACH_READ_FROM(uint64_t, buf);
+  buf += 8;
+  uint32_t page_count = MACH_READ_UINT32(buf);
+  buf += 4;
+  uint64_t modified_rows = MACH_READ_FROM(uint64_t, buf);
+  buf += 8;
+  uint32_t column_count = MACH_READ_UINT32(buf);
+  buf += 4;
+  if (column_count != schema_->GetColumnCount()) {
+    return 0;
+  }
+  std::vector<ColumnStatistics> columns;
+  for (uint32_t i = 0; i < column_count; i++) {
+    columns.emplace_back(schema_->GetColumn(i)->GetType());
+    buf += ColumnStatistics::DeserializeFrom(buf, &columns.back());
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  columns_.swap(columns);
+  analyzed_ = analyzed;
+  row_count_ = row_count;
+  page_count_ = page_count;
+  modified_rows_ = modified_rows;
+  dirty_ = false;
+  return buf - p;
+}
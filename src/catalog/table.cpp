@@ -20,6 +20,18 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
     buf += 4;
     // table schema
     buf += schema_->SerializeTo(buf);
+    // table layout
+    MACH_WRITE_UINT32(buf, static_cast<uint32_t>(layout_));
+    buf += 4;
+    // dictionary pages
+    MACH_WRITE_UINT32(buf, dictionary_pages_.size());
+    buf += 4;
+    for (auto iter : dictionary_pages_) {
+        MACH_WRITE_UINT32(buf, iter.first);
+        buf += 4;
+        MACH_WRITE_TO(page_id_t, buf, iter.second);
+        buf += 4;
+    }
     ASSERT(buf - p == ofs, "Unexpected serialize size.");
     return ofs;
 }
@@ -29,8 +41,9 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
 //  return 0;
 //}
 uint32_t TableMetadata::GetSerializedSize() const {
-  // magic_number(4)+table_id_t(4)+table_name_(MACH_STR_SERIALIZED_SIZE(table_name_))+root_page_id_(4)
-  return 12 + MACH_STR_SERIALIZED_SIZE(table_name_) + schema_->GetSerializedSize();
+  // magic_number(4)+table_id_t(4)+table_name_(MACH_STR_SERIALIZED_SIZE(table_name_))+root_page_id_(4)+layout_(4)
+  // +dictionary count(4)+(column id(4)+page id(4))*count
+  return 20 + MACH_STR_SERIALIZED_SIZE(table_name_) + schema_->GetSerializedSize() + 8 * dictionary_pages_.size();
 }
 
 uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
@@ -56,8 +69,20 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
     // table schema
     TableSchema *schema = nullptr;
     buf += TableSchema::DeserializeFrom(buf, schema);
+    // table layout
+    auto layout = static_cast<TableLayout>(MACH_READ_UINT32(buf));
+    buf += 4;
     // allocate space for table metadata
-    table_meta = new TableMetadata(table_id, table_name, root_page_id, schema);
+    table_meta = new TableMetadata(table_id, table_name, root_page_id, schema, layout);
+    // dictionary pages
+    uint32_t dictionary_count = MACH_READ_UINT32(buf);
+    buf += 4;
+    for (uint32_t i = 0; i < dictionary_count; i++) {
+        uint32_t column_id = MACH_READ_UINT32(buf);
+        buf += 4;
+        table_meta->dictionary_pages_[column_id] = MACH_READ_FROM(page_id_t, buf);
+        buf += 4;
+    }
     return buf - p;
 }
 
@@ -67,10 +92,11 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
  * @param heap Memory heap passed by TableInfo
  */
 TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
-                                     TableSchema *schema) {
+                                     TableSchema *schema, TableLayout layout) {
   // allocate space for table metadata
-  return new TableMetadata(table_id, table_name, root_page_id, schema);
+  return new TableMetadata(table_id, table_name, root_page_id, schema, layout);
 }
 
-TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema)
-    : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema) {}
+TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                             TableLayout layout)
+    : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema), layout_(layout) {}
@@ -0,0 +1,28 @@
+#include "common/arena.h"
+
+Arena::~Arena() {
+  for (auto &block : blocks_) {
+    delete[] block.first;
+  }
+}
+
+void Arena::Reset() {
+  // 只保留第一块，超大的块也一并释放
+  for (size_t i = 1; i < blocks_.size(); i++) {
+    delete[] blocks_[i].first;
+  }
+  if (!blocks_.empty()) {
+    blocks_.resize(1);
+    cur_ = blocks_[0].first;
+    remaining_ = blocks_[0].second;
+  }
+  bytes_used_ = 0;
+}
+
+void Arena::NewBlock(size_t min_size) {
+  size_t size = min_size > block_size_ ? min_size : block_size_;
+  char *block = new char[size];
+  blocks_.emplace_back(block, size);
+  cur_ = block;
+  remaining_ = size;
+}
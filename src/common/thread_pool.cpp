@@ -0,0 +1,51 @@
+#include "common/thread_pool.h"
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  for (size_t i = 0; i < num_threads; i++) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+std::future<void> ThreadPool::Submit(std::function<void()> task) {
+  std::packaged_task<void()> packaged(std::move(task));
+  auto future = packaged.get_future();
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    tasks_.emplace_back(std::move(packaged));
+  }
+  cv_.notify_one();
+  return future;
+}
+
+ThreadPool &ThreadPool::Instance() {
+  static ThreadPool pool(std::max(1U, std::thread::hardware_concurrency()));
+  return pool;
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::packaged_task<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      cv_.wait(lock, [this] { return shutdown_ || !tasks_.empty(); });
+      // 退出前先把队列中的任务做完
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
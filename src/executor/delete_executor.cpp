@@ -21,6 +21,7 @@ bool DeleteExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
   // 删除失败
   if(!table_info_->GetTableHeap()->MarkDelete(row->GetRowId(), nullptr)) 
     return false;
+  table_info_->GetStatistics()->OnDelete();
   // 删索引
   for( auto index : index_info_ ){
       // 取出key
@@ -2,9 +2,11 @@
 #include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <algorithm>
 #include <chrono>
 #include "common/result_writer.h"
 #include "executor/executors/delete_executor.h"
+#include "executor/executors/index_only_scan_executor.h"
 #include "executor/executors/index_scan_executor.h"
 #include "executor/executors/insert_executor.h"
 #include "executor/executors/seq_scan_executor.h"
@@ -52,7 +54,11 @@ std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *
     }
     // Create a new index scan executor
     case PlanType::IndexScan: {
-      return std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan.get()));
+      auto index_scan_plan = dynamic_cast<const IndexScanPlanNode *>(plan.get());
+      if (index_scan_plan->index_only_) {
+        return std::make_unique<IndexOnlyScanExecutor>(exec_ctx, index_scan_plan);
+      }
+      return std::make_unique<IndexScanExecutor>(exec_ctx, index_scan_plan);
     }
     // Create a new update executor
     case PlanType::Update: {
@@ -82,6 +88,10 @@ std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *
 dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<Row> *result_set, Transaction *txn,
                                    ExecuteContext *exec_ctx) {
   // Construct the executor for the abstract plan node
+  // 查询结果保留到语句结束，行分配在arena中随上下文整体释放；DML逐行丢弃子节点的行，仍用堆
+  if (result_set != nullptr && (plan->GetType() == PlanType::SeqScan || plan->GetType() == PlanType::IndexScan)) {
+    exec_ctx->EnableArena();
+  }
   auto executor = CreateExecutor(exec_ctx, plan);
   try {
     executor->Init();
@@ -89,7 +99,7 @@ dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<
     Row row{};
     while (executor->Next(&row, &rid)) {
       if (result_set != nullptr) {
-        result_set->push_back(row);
+        result_set->push_back(std::move(row));
       }
     }
   } catch (const exception &ex) {
@@ -131,6 +141,8 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
       return ExecuteCreateIndex(ast, context.get());
     case kNodeDropIndex:
       return ExecuteDropIndex(ast, context.get());
+    case kNodeAnalyze:
+      return ExecuteAnalyze(ast, context.get());
     case kNodeTrxBegin:
       return ExecuteTrxBegin(ast, context.get());
     case kNodeTrxCommit:
@@ -202,6 +214,11 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
   } else {
     writer.EndInformation(result_set.size(), duration_time, false);
   }
+#ifdef ENABLE_EXECUTE_DEBUG
+  if (context != nullptr && context->GetPagesSkipped() > 0) {
+    LOG(INFO) << context->GetPagesSkipped() << " page(s) skipped by zone map." << std::endl;
+  }
+#endif
   std::cout << writer.stream_.rdbuf();
   return DB_SUCCESS;
 }
@@ -334,6 +351,7 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
   }
   // 存信息的map
   vector<string> names,unique;
+  vector<uint32_t> dictionary_columns;
   unordered_map<string ,bool> UniqueC;
   unordered_map<string ,string> TypeC;
   unordered_map<string ,int> LenC;
@@ -353,18 +371,49 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     string column_type=column->child_->next_->val_;
     names.push_back(column_name);
     TypeC.emplace(column_name,column_type);
-    if (column->val_!= nullptr){
+    if (column->val_!= nullptr && string(column->val_)=="unique"){
       unique.push_back(column_name);
       UniqueC.emplace(column_name, true);
     }
+    // name char(n) dictionary: 字典编码存储
+    if (column->val_!= nullptr && string(column->val_)=="dictionary"){
+      if (column_type!="char"){
+        cout<<"Only char columns can be dictionary encoded"<<endl;
+        return DB_FAILED;
+      }
+      dictionary_columns.push_back(names.size()-1);
+    }
     if (column_type=="char"){
       string len=column->child_->next_->child_->val_;
       int length=atoi(len.data());
       if (length<=0) return DB_FAILED;
+      // 行存表中超过TUPLE_INLINE_VALUE_MAX的值存到溢出页
+      if (static_cast<uint32_t>(length)>=VARCHAR_MAX_LEN){
+        cout<<"Char length exceeds "<<VARCHAR_MAX_LEN-1<<endl;
+        return DB_FAILED;
+      }
+      // 字典的一个值要放进一页
+      if (column->val_!= nullptr && string(column->val_)=="dictionary" &&
+          static_cast<uint32_t>(length)>Dictionary::MAX_VALUE_LENGTH){
+        cout<<"Dictionary encoded char length exceeds "<<Dictionary::MAX_VALUE_LENGTH<<endl;
+        return DB_FAILED;
+      }
       LenC.emplace(column_name,length);
     }
     column=column->next_;
   }
+  // 存储格式: create table ... using row|pax
+  TableLayout layout = TableLayout::kRow;
+  auto layout_node = ast->child_->next_->next_;
+  if (layout_node != nullptr && layout_node->type_ == kNodeTableLayout) {
+    string layout_name = layout_node->child_->val_;
+    if (layout_name == "pax")
+      layout = TableLayout::kPax;
+    else if (layout_name != "row") {
+      cout << "Unknown table layout " << layout_name << endl;
+      return DB_FAILED;
+    }
+  }
   //create column
   vector<Column*> columns;
   columns.clear();
@@ -390,7 +439,7 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
   // 开始建表
   Schema *schema=new Schema(columns);
   TableInfo *table_info_new=nullptr;
-  dberr_t create_table = db_catalog->CreateTable(new_table,schema, nullptr,table_info_new);
+  dberr_t create_table = db_catalog->CreateTable(new_table,schema, nullptr,table_info_new,layout,dictionary_columns);
   if (create_table)
       return create_table;
   // primary key
@@ -400,11 +449,14 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     prikey.push_back(column->val_);
     column=column->next_;
   }
+  // 没有声明主键时不建索引，空key会让所有记录被当成重复
   string index_name=new_table+ " primary key";
-  IndexInfo *index_info= nullptr;
-  dberr_t NewIndex=db_catalog->CreateIndex(new_table,index_name,prikey,nullptr,index_info,"bptree");
-  if(NewIndex)
-      return NewIndex;
+  if (!prikey.empty()) {
+    IndexInfo *index_info= nullptr;
+    dberr_t NewIndex=db_catalog->CreateIndex(new_table,index_name,prikey,nullptr,index_info,"bptree");
+    if(NewIndex)
+        return NewIndex;
+  }
   // index
   prikey.clear();
   for (auto &uni:unique){
@@ -480,9 +532,30 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
     keymap.push_back(string(key_node->val_));
     key_node=key_node->next_;
   }
-  // 创建索引
+  // INCLUDE的列只存放在叶子中
+  vector<string> include_keys;
+  auto include_node=ast->child_->next_->next_->next_;
+  if (include_node!= nullptr && include_node->type_==kNodeColumnList){
+    for (auto node=include_node->child_; node!= nullptr; node=node->next_){
+      include_keys.push_back(string(node->val_));
+    }
+  }
+  // USING指定索引结构，默认为B+树
+  string index_type="bptree";
+  for (auto node=ast->child_->next_->next_->next_; node!= nullptr; node=node->next_){
+    if (node->type_==kNodeIndexType && node->child_!= nullptr){
+      index_type=node->child_->val_;
+      std::transform(index_type.begin(),index_type.end(),index_type.begin(),::tolower);
+    }
+  }
+  if (index_type=="hash" && !include_keys.empty()){
+    cout<<"Only B+ tree indexes can include columns"<<endl;
+    return DB_FAILED;
+  }
+  // 创建索引，create unique index建唯一索引
+  bool unique=ast->val_!=nullptr && string(ast->val_)=="unique";
   IndexInfo *index_info= nullptr;
-  dberr_t NewIndex=db_catalog->CreateIndex(table_name,index_name,keymap, nullptr,index_info,"bptree");
+  dberr_t NewIndex=db_catalog->CreateIndex(table_name,index_name,keymap, nullptr,index_info,index_type,unique,include_keys);
   return NewIndex;
 }
 
@@ -515,6 +588,35 @@ dberr_t ExecuteEngine::ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context
   return DB_INDEX_NOT_FOUND;
 }
 
+/* ExecuteAnalyze */
+dberr_t ExecuteEngine::ExecuteAnalyze(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteAnalyze" << std::endl;
+#endif
+  auto db=dbs_.find(current_db_);
+  if (db==dbs_.end()){
+    return DB_NOT_EXIST;
+  }
+  string table_name=ast->child_->val_;
+  auto db_catalog=db->second->catalog_mgr_;
+  dberr_t err=db_catalog->AnalyzeTable(table_name);
+  if (err) return err;
+  TableInfo *table_info=nullptr;
+  db_catalog->GetTable(table_name,table_info);
+  TableStatistics *stats=table_info->GetStatistics();
+  cout<<table_name<<": "<<stats->GetRowCount()<<" row(s) in "<<stats->GetPageCount()<<" page(s)"<<endl;
+  Schema *schema=table_info->GetSchema();
+  for (uint32_t i=0;i<schema->GetColumnCount();i++){
+    const ColumnStatistics &column=stats->GetColumnStatistics(i);
+    cout<<"  "<<schema->GetColumn(i)->GetName()<<": ~"<<static_cast<uint64_t>(column.GetDistinctCount()+0.5)
+        <<" distinct, "<<column.GetNullFraction()*100<<"% null, "<<column.GetBucketCount()<<" bucket(s)";
+    if (table_info->GetTableHeap()->GetDictionary(i)!=nullptr){
+      cout<<", dictionary encoded";
+    }
+    cout<<endl;
+  }
+  return DB_SUCCESS;
+}
 
 dberr_t ExecuteEngine::ExecuteTrxBegin(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
@@ -0,0 +1,42 @@
+#include "executor/executors/index_only_scan_executor.h"
+
+#include "index/b_plus_tree_index.h"
+
+IndexOnlyScanExecutor::IndexOnlyScanExecutor(ExecuteContext *exec_ctx, const IndexScanPlanNode *plan)
+        : IndexScanExecutor(exec_ctx, plan) {}
+
+void IndexOnlyScanExecutor::Init() {
+    IndexScanExecutor::Init();
+    key_ids_.clear();
+    for (auto col : index_info_->GetIndexKeySchema()->GetColumns()) {
+        uint32_t col_index;
+        table_info_->GetSchema()->GetColumnIndex(col->GetName(), col_index);
+        key_ids_.push_back(col_index);
+    }
+}
+
+bool IndexOnlyScanExecutor::Next(Row *row, RowId *rid) {
+    auto index = dynamic_cast<BPlusTreeIndex *>(index_info_->GetIndex());
+    uint32_t column_count = table_info_->GetSchema()->GetColumnCount();
+    while (iter_ != end_) {
+        auto entry = *iter_;
+        RowId row_id = entry.second;
+        // 解码出的字段放到表中的位置上，谓词和投影只会访问这些列
+        Row key(row_id);
+        [[maybe_unused]] bool complete = index->DecodeKey(entry.first, &key);
+        ASSERT(complete, "Index key holds a value longer than its column.");
+        ++iter_;
+        Row src(row_id);
+        auto &fields = src.GetFields();
+        fields.assign(column_count, nullptr);
+        for (size_t i = 0; i < key_ids_.size(); i++) {
+            fields[key_ids_[i]] = key.GetFields()[i];
+        }
+        key.GetFields().clear();
+        if (ProduceRow(src, row)) {
+            *rid = row_id;
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,82 +1,241 @@
 #include "executor/executors/index_scan_executor.h"
 
+#include "index/b_plus_tree_index.h"
+#include "index/extendible_hash_index.h"
+#include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
+
 IndexScanExecutor::IndexScanExecutor(ExecuteContext *exec_ctx, const IndexScanPlanNode *plan)
-        : AbstractExecutor(exec_ctx), plan_(plan) {result_rid.clear();result_row.clear();}
-// 递归地dfs遍历子节点来寻找比较的项
-void dfs(vector<ComparisonExpression*>& vec, AbstractExpressionRef curr){
-    //只有and的情况
-    if(curr.get()->GetType() == ExpressionType::LogicExpression){
-        for( auto child : curr->GetChildren() ){
-            dfs(vec,child); //遍历每个字节点
+        : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+namespace {
+
+// 谓词中的一项 column op constant，常量在左侧时翻转比较符
+struct KeyPredicate {
+    uint32_t col_idx;
+    std::string op;
+    const Field *val;
+};
+
+// 递归地遍历AND连接的子节点，收集可以用于确定范围的比较
+void CollectKeyPredicates(const AbstractExpressionRef &expr, std::vector<KeyPredicate> &preds) {
+    if (expr->GetType() == ExpressionType::LogicExpression) {
+        if (dynamic_cast<LogicExpression *>(expr.get())->logic_type_ != LogicType::And) {
+            return;
+        }
+        for (const auto &child : expr->GetChildren()) {
+            CollectKeyPredicates(child, preds);
+        }
+        return;
+    }
+    if (expr->GetType() != ExpressionType::ComparisonExpression) {
+        return;
+    }
+    std::string op = dynamic_cast<ComparisonExpression *>(expr.get())->GetComparisonType();
+    auto lhs = expr->GetChildAt(0);
+    auto rhs = expr->GetChildAt(1);
+    if (lhs->GetType() == ExpressionType::ConstantExpression && rhs->GetType() == ExpressionType::ColumnExpression) {
+        std::swap(lhs, rhs);
+        if (op[0] == '<') {
+            op[0] = '>';
+        } else if (op[0] == '>') {
+            op[0] = '<';
+        }
+        if (op == "><") {
+            op = "<>";
         }
     }
-    // 如果是compare类型的，就压入用于分析
-    else if(curr.get()->GetType() == ExpressionType::ComparisonExpression){
-        vec.emplace_back(dynamic_cast<ComparisonExpression*>(curr.get()));
+    if (lhs->GetType() != ExpressionType::ColumnExpression || rhs->GetType() != ExpressionType::ConstantExpression) {
         return;
     }
-    else{
-        throw "Scan for index error";
+    if (op != "=" && op != "<" && op != "<=" && op != ">" && op != ">=") {
+        return;
     }
+    const Field *val = &dynamic_cast<ConstantValueExpression *>(rhs.get())->val_;
+    if (val->IsNull()) {
+        return;
+    }
+    preds.push_back({dynamic_cast<ColumnValueExpression *>(lhs.get())->GetColIdx(), op, val});
 }
 
-bool cmp(const RowId& A, const RowId& B){
-    return A.Get() < B.Get();
+// 单侧的界，val为nullptr表示无界
+struct Bound {
+    const Field *val{nullptr};
+    bool inclusive{true};
+};
+
+// tighter_than为CompareGreaterThan时收紧下界，为CompareLessThan时收紧上界
+void Tighten(Bound *bound, const Field *val, bool inclusive, CmpBool (Field::*tighter_than)(const Field &) const) {
+    if (bound->val == nullptr || (val->*tighter_than)(*bound->val) == CmpBool::kTrue) {
+        bound->val = val;
+        bound->inclusive = inclusive;
+    } else if (val->CompareEquals(*bound->val) == CmpBool::kTrue) {
+        bound->inclusive = bound->inclusive && inclusive;
+    }
 }
 
+}  // namespace
+
 void IndexScanExecutor::Init() {
-    // 获取表名, 目录管理器
-    std::string table_name = plan_->GetTableName();
     CatalogManager *catalog = exec_ctx_->GetCatalog();
-    // 检查表是否存在
-    TableInfo *table_info = nullptr;
-    auto predicate_root = plan_->GetPredicate();
-    vector<ComparisonExpression*> predicates(0);
-    dfs(predicates, predicate_root);
-    // 遍历索引
-    for (auto predicate : predicates){
-        auto col_expr = dynamic_cast<ColumnValueExpression*>(predicate->GetChildAt(0).get());
-        for (auto index : plan_->indexes_){
-            auto col_id = index->GetIndexKeySchema()->GetColumn(0)->GetTableInd() - 1;
-            // 找到索引对应的条件，并存到fields中
-            vector<Field> fields;
-            fields.clear();
-            fields.emplace_back(Field(predicate->GetChildAt(1)->Evaluate(nullptr)));
-            Row key(fields);
-            vector<RowId> result_temp(0);
-            if(col_expr->GetColIdx() == col_id){
-                index->GetIndex()->ScanKey(key, result_temp, nullptr, predicate->GetComparisonType());
-                //与之前的结果求交集
-                vector<RowId> temp; // 创建暂存向量
-                // 对要处理的两个向量进行排序
-                std::sort(result_rid.begin(), result_rid.end(), cmp);
-                std::sort(result_temp.begin(), result_temp.end(), cmp);
-                // 取交集
-                set_intersection(result_rid.begin(),result_rid.end(),result_temp.begin(),result_temp.end(),insert_iterator<vector<RowId>>(temp,temp.begin()), cmp);
-                result_rid.clear();
-                result_rid = temp;
+    catalog->GetTable(plan_->GetTableName(), table_info_);
+    Schema *schema = table_info_->GetSchema();
+    output_ids_.clear();
+    for (auto col : plan_->OutputSchema()->GetColumns()) {
+        uint32_t col_index;
+        schema->GetColumnIndex(col->GetName(), col_index);
+        output_ids_.push_back(col_index);
+    }
+    arena_ = exec_ctx_->GetArena();
+    std::vector<KeyPredicate> preds;
+    if (plan_->GetPredicate() != nullptr) {
+        CollectKeyPredicates(plan_->GetPredicate(), preds);
+    }
+    // 每个索引按key列顺序匹配等值前缀，再加上下一列的范围；等值列多者优先，其次是范围的边数
+    // 哈希索引要求每个key列都有等值条件，一次查找即可，比同样列数的B+树前缀更优先
+    IndexInfo *best_index = nullptr;
+    std::vector<const Field *> best_low, best_high;
+    bool best_low_inclusive = true, best_high_inclusive = true;
+    int best_score = -1;
+    for (auto index_info : plan_->indexes_) {
+        if (dynamic_cast<ExtendibleHashIndex *>(index_info->GetIndex()) != nullptr) {
+            std::vector<const Field *> key_vals;
+            for (uint32_t i = 0; i < index_info->GetKeyColumnCount(); i++) {
+                const Column *key_column = index_info->GetIndexKeySchema()->GetColumn(i);
+                for (const auto &pred : preds) {
+                    if (pred.op == "=" && pred.col_idx == key_column->GetTableInd() &&
+                        pred.val->GetTypeId() == key_column->GetType() &&
+                        (pred.val->GetTypeId() != TypeId::kTypeChar ||
+                         pred.val->GetLength() <= key_column->GetLength())) {
+                        key_vals.push_back(pred.val);
+                        break;
+                    }
+                }
+            }
+            int score = 3 * static_cast<int>(key_vals.size()) + 1;
+            if (key_vals.size() == index_info->GetKeyColumnCount() && score > best_score) {
+                best_index = index_info;
+                best_low = std::move(key_vals);
+                best_high.clear();
+                best_score = score;
             }
+            continue;
         }
-    }
-    vector<RowId> temp(0);
-    for(int i = 0; i < result_rid.size(); i++){
-        auto row = Row(result_rid[i]);
-        table_info->GetTableHeap()->GetTuple(&row, nullptr);
-        //最后用所有谓词扫描一遍
-        if(!plan_->need_filter_ || plan_->GetPredicate()->Evaluate(&row).CompareEquals(Field(kTypeInt, 1)) == kTrue){
-            result_row.emplace_back(row);
-            temp.emplace_back(result_rid[i]);
+        if (dynamic_cast<BPlusTreeIndex *>(index_info->GetIndex()) == nullptr) {
+            continue;
+        }
+        std::vector<const Field *> low_vals, high_vals;
+        bool low_inclusive = true, high_inclusive = true;
+        int score = 0;
+        for (uint32_t i = 0; i < index_info->GetKeyColumnCount(); i++) {
+            const Column *key_column = index_info->GetIndexKeySchema()->GetColumn(i);
+            uint32_t col_idx;
+            if (schema->GetColumnIndex(key_column->GetName(), col_idx) != DB_SUCCESS) {
+                break;
+            }
+            Bound low, high;
+            for (const auto &pred : preds) {
+                // 类型不同或超出列宽的常量序列化后不再保序，留给谓词过滤
+                if (pred.col_idx != col_idx || pred.val->GetTypeId() != key_column->GetType() ||
+                    (pred.val->GetTypeId() == TypeId::kTypeChar && pred.val->GetLength() > key_column->GetLength())) {
+                    continue;
+                }
+                if (pred.op == "=" || pred.op[0] == '>') {
+                    Tighten(&low, pred.val, pred.op != ">", &Field::CompareGreaterThan);
+                }
+                if (pred.op == "=" || pred.op[0] == '<') {
+                    Tighten(&high, pred.val, pred.op != "<", &Field::CompareLessThan);
+                }
+            }
+            if (low.val != nullptr && high.val != nullptr && low.inclusive && high.inclusive &&
+                low.val->CompareEquals(*high.val) == CmpBool::kTrue) {
+                low_vals.push_back(low.val);
+                high_vals.push_back(high.val);
+                score += 3;
+                continue;
+            }
+            // 范围列之后的列不能再缩小区间
+            if (low.val != nullptr) {
+                low_vals.push_back(low.val);
+                low_inclusive = low.inclusive;
+                score++;
+            }
+            if (high.val != nullptr) {
+                high_vals.push_back(high.val);
+                high_inclusive = high.inclusive;
+                score++;
+            }
+            break;
+        }
+        if (score > best_score) {
+            best_index = index_info;
+            best_low = std::move(low_vals);
+            best_high = std::move(high_vals);
+            best_low_inclusive = low_inclusive;
+            best_high_inclusive = high_inclusive;
+            best_score = score;
         }
     }
-    result_rid.swap(temp);
+    ASSERT(best_index != nullptr, "Index scan without a usable index.");
+    low_fields_.clear();
+    high_fields_.clear();
+    for (auto val : best_low) {
+        low_fields_.push_back(*val);
+    }
+    for (auto val : best_high) {
+        high_fields_.push_back(*val);
+    }
+    Row low_key(low_fields_);
+    Row high_key(high_fields_);
+    index_info_ = best_index;
+    rids_.clear();
+    rid_pos_ = 0;
+    if (dynamic_cast<ExtendibleHashIndex *>(best_index->GetIndex()) != nullptr) {
+        iter_ = IndexIterator();
+        best_index->GetIndex()->ScanKey(low_key, rids_, exec_ctx_->GetTransaction(), "=");
+        return;
+    }
+    iter_ = dynamic_cast<BPlusTreeIndex *>(best_index->GetIndex())
+                ->GetRangeIterator(low_fields_.empty() ? nullptr : &low_key, best_low_inclusive,
+                                   high_fields_.empty() ? nullptr : &high_key, best_high_inclusive);
+}
+
+bool IndexScanExecutor::ProduceRow(const Row &src, Row *row) const {
+    auto predicate = plan_->GetPredicate();
+    if (predicate != nullptr && !Field(TypeId::kTypeInt, 1).CompareEquals(predicate->Evaluate(&src))) {
+        return false;
+    }
+    Row output(arena_);
+    auto &fields = output.GetFields();
+    fields.reserve(output_ids_.size());
+    for (auto col_index : output_ids_) {
+        fields.push_back(output.NewField(*src.GetField(col_index)));
+    }
+    output.SetRowId(src.GetRowId());
+    *row = std::move(output);
+    return true;
 }
 
 bool IndexScanExecutor::Next(Row *row, RowId *rid) {
-    // 找下一个节点
-    if (cursor_ < result_rid.size()){
-        *row = result_row[cursor_];
-        *rid = result_rid[cursor_];
-        cursor_++;
+    // 逐个取出范围内的row id，回表后用完整谓词过滤
+    TableHeap *table_heap = table_info_->GetTableHeap();
+    Transaction *txn = exec_ctx_->GetTransaction();
+    while (rid_pos_ < rids_.size()) {
+        RowId row_id = rids_[rid_pos_++];
+        Row src(row_id);
+        if (table_heap->GetTuple(&src, txn) && ProduceRow(src, row)) {
+            *rid = row_id;
+            return true;
+        }
+    }
+    while (iter_ != end_) {
+        RowId row_id = (*iter_).second;
+        ++iter_;
+        Row src(row_id);
+        if (table_heap->GetTuple(&src, txn) && ProduceRow(src, row)) {
+            *rid = row_id;
+            return true;
+        }
     }
     return false;
 }
@@ -1,5 +1,7 @@
 #include "executor/executors/insert_executor.h"
 
+#include <algorithm>
+
 InsertExecutor::InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
         : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
@@ -10,43 +12,45 @@ void InsertExecutor::Init() {
     CatalogManager *catalog = exec_ctx_->GetCatalog();
     dberr_t ret = catalog->GetTable(plan_->table_name_, table_info_);
     catalog->GetTableIndexes(plan_->table_name_,index_info_);
+    // 唯一索引排在前面，重复时回滚的entry最少
+    std::stable_partition(index_info_.begin(), index_info_.end(),
+                          [](IndexInfo *index) { return index->IsUnique(); });
+    // 预先算好每个索引的key列
+    index_key_ids_.clear();
+    for (auto index : index_info_) {
+        std::vector<uint32_t> key_ids;
+        for (auto col : index->GetIndexKeySchema()->GetColumns()) {
+            uint32_t col_index;
+            table_info_->GetSchema()->GetColumnIndex(col->GetName(), col_index);
+            key_ids.push_back(col_index);
+        }
+        index_key_ids_.push_back(std::move(key_ids));
+    }
 }
 
 bool InsertExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
-    Row* insert = new Row();
+    Row insert;
     // 已经存完了
-    if( !child_executor_->Next(insert, nullptr))
+    if( !child_executor_->Next(&insert, nullptr))
         return false;
-    // 先判断插入值是否已经存在
-    for( auto index : index_info_ ){
-        // 取出key
-        vector<Field> key_contain;
-        for( auto col : index->GetIndexKeySchema()->GetColumns() ){
-            uint32_t col_index;
-            table_info_->GetSchema()->GetColumnIndex(col->GetName(),col_index);
-            key_contain.push_back(*(insert->GetField(col_index)));
-        }
-        // 判断index是否存在
-        std::vector<RowId> result(0);
-        index->GetIndex()->ScanKey(Row(key_contain),result, nullptr);
-        if (!result.empty()){
-            return false;
-        }
-    }
-    // 要插入的值不存在
-    table_info_->GetTableHeap()->InsertTuple(*insert, nullptr);
-    // 更新index
-    for( auto index : index_info_ ){
+    // 先插入tuple拿到RowId，唯一性检查和索引插入在同一次查找中完成
+    if (!table_info_->GetTableHeap()->InsertTuple(insert, nullptr))
+        return false;
+    std::vector<Row> keys;
+    for (size_t i = 0; i < index_info_.size(); i++) {
         // 取出key
         vector<Field> key_contain;
-        for( auto col : index->GetIndexKeySchema()->GetColumns() ){
-            uint32_t col_index;
-            table_info_->GetSchema()->GetColumnIndex(col->GetName(),col_index);
-            key_contain.push_back(*(insert->GetField(col_index)));
-        }
-        // 更新index
-        index->GetIndex()->InsertEntry(Row(key_contain),insert->GetRowId(), nullptr);
+        for (auto col_index : index_key_ids_[i])
+            key_contain.push_back(*(insert.GetField(col_index)));
+        keys.emplace_back(key_contain);
+        if (index_info_[i]->GetIndex()->InsertEntryIfAbsent(keys[i], insert.GetRowId(), nullptr) != DB_ALREADY_EXIST)
+            continue;
+        // 唯一索引中已经存在，撤销前面的索引entry和tuple
+        for (size_t j = 0; j < i; j++)
+            index_info_[j]->GetIndex()->RemoveEntry(keys[j], insert.GetRowId(), nullptr);
+        table_info_->GetTableHeap()->ApplyDelete(insert.GetRowId(), nullptr);
+        return false;
     }
-
+    table_info_->GetStatistics()->OnInsert(insert);
     return true;
 }
\ No newline at end of file
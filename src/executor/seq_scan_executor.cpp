@@ -1,45 +1,278 @@
 #include "executor/executors/seq_scan_executor.h"
 
+#include <future>
+
+#include "common/thread_pool.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
+
 SeqScanExecutor::SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan)
         : AbstractExecutor(exec_ctx),
           plan_(plan){}
 
+SeqScanExecutor::~SeqScanExecutor() {
+    DrainMorsels();
+}
+
 void SeqScanExecutor::Init() {
     // 获取表名
     std::string table_name = plan_->GetTableName();
-    // 获取执行上下文中的事务和目录管理器
-    Transaction *txn = exec_ctx_->GetTransaction();
+    // 获取执行上下文中的目录管理器
     CatalogManager *catalog = exec_ctx_->GetCatalog();
     // 检查表是否存在
     TableInfo *table_info = nullptr;
     dberr_t ret = catalog->GetTable(table_name, table_info);
     table_info_=table_info;
-    // 获取表的迭代器
+    // 输出列在表中的位置，规划阶段没有给出时按列名解析一次
+    output_ids_ = plan_->output_ids_;
+    if (output_ids_.empty()) {
+        for (auto col : plan_->OutputSchema()->GetColumns()) {
+            ::uint32_t col_index;
+            table_info_->GetSchema()->GetColumnIndex(col->GetName(), col_index);
+            output_ids_.push_back(col_index);
+        }
+    }
     TableHeap* table_heap = table_info->GetTableHeap();
-    table_iter_ = table_heap->Begin(txn);
+    arena_ = exec_ctx_->GetArena();
     end_ = table_heap->End();
+    table_iter_ = end_;
+    zone_map_ = table_heap->GetZoneMap();
+    // 有字典编码列时直接在编码上过滤，只还原输出的行
+    predicate_ = plan_->filter_predicate_;
+    scan_codes_ = false;
+    if (table_heap->HasDictionary()) {
+        bool ok = true;
+        auto encoded = predicate_ == nullptr ? nullptr : EncodePredicate(predicate_, &ok);
+        if (ok) {
+            predicate_ = encoded;
+            scan_codes_ = true;
+        }
+    }
+    // 页数足够多时按morsel切分页链，交给线程池并行过滤
+    DrainMorsels();
+    table_heap->GetPageIds(page_ids_);
+    page_pos_ = 0;
+    morsel_count_ = (page_ids_.size() + SEQ_SCAN_MORSEL_PAGES - 1) / SEQ_SCAN_MORSEL_PAGES;
+    ThreadPool &pool = ThreadPool::Instance();
+    parallel_ = morsel_count_ >= SEQ_SCAN_PARALLEL_MIN_MORSELS && pool.GetThreadCount() > 1;
+    max_morsels_ = SEQ_SCAN_MORSELS_PER_THREAD * pool.GetThreadCount();
+    next_morsel_ = row_idx_ = 0;
+    if (parallel_) {
+        SubmitMorsels();
+    }
+}
+
+void SeqScanExecutor::SubmitMorsels() {
+    while (next_morsel_ < morsel_count_ && morsels_.size() < max_morsels_) {
+        size_t begin = next_morsel_++ * SEQ_SCAN_MORSEL_PAGES;
+        size_t end = std::min(begin + SEQ_SCAN_MORSEL_PAGES, page_ids_.size());
+        Morsel &morsel = morsels_.emplace_back();
+        morsel.done = ThreadPool::Instance().Submit(
+            [this, begin, end, rows = &morsel.rows] { ScanMorsel(begin, end, rows); });
+    }
+}
+
+void SeqScanExecutor::DrainMorsels() {
+    for (auto &morsel : morsels_) {
+        if (morsel.done.valid()) {
+            morsel.done.wait();
+        }
+    }
+    morsels_.clear();
+}
+
+void SeqScanExecutor::ScanMorsel(size_t begin, size_t end, std::vector<Row> *result) {
+    // worker线程各用自己的arena
+    Arena *arena = exec_ctx_->GetArena();
+    for (size_t pos = begin; pos < end; pos++) {
+        if (!PageMayMatch(page_ids_[pos])) {
+            continue;
+        }
+        auto iter = OpenPage(pos);
+        for (; iter != end_; ++iter) {
+            Row row;
+            if (ProduceRow(*iter, &row, arena)) {
+                result->push_back(std::move(row));
+            }
+        }
+    }
+}
+
+TableIterator SeqScanExecutor::OpenPage(size_t pos) {
+    // 只扫描这一页，最后一页之后追加的页也一起扫描
+    page_id_t stop_page_id = pos + 1 < page_ids_.size() ? page_ids_[pos + 1] : INVALID_PAGE_ID;
+    const std::vector<uint32_t> *column_ids = plan_->column_ids_.empty() ? nullptr : &plan_->column_ids_;
+    return table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction(), column_ids, page_ids_[pos], stop_page_id,
+                                              !scan_codes_);
+}
+
+bool SeqScanExecutor::PageMayMatch(page_id_t page_id) {
+    bool may_match = zone_map_->MayHaveRows(page_id) &&
+                     (plan_->filter_predicate_ == nullptr || MayMatch(plan_->filter_predicate_, page_id));
+    if (!may_match) {
+        exec_ctx_->AddPagesSkipped(1);
+    }
+    return may_match;
+}
+
+bool SeqScanExecutor::MayMatch(const AbstractExpressionRef &expr, page_id_t page_id) const {
+    switch (expr->GetType()) {
+        case ExpressionType::LogicExpression: {
+            auto logic = dynamic_cast<LogicExpression *>(expr.get());
+            if (logic->logic_type_ == LogicType::And) {
+                return MayMatch(expr->GetChildAt(0), page_id) && MayMatch(expr->GetChildAt(1), page_id);
+            }
+            return MayMatch(expr->GetChildAt(0), page_id) || MayMatch(expr->GetChildAt(1), page_id);
+        }
+        case ExpressionType::ComparisonExpression: {
+            // 只处理 列 op 常量 和 常量 op 列
+            auto comparison = dynamic_cast<ComparisonExpression *>(expr.get());
+            std::string op = comparison->GetComparisonType();
+            auto lhs = expr->GetChildAt(0);
+            auto rhs = expr->GetChildAt(1);
+            if (lhs->GetType() == ExpressionType::ConstantExpression &&
+                rhs->GetType() == ExpressionType::ColumnExpression) {
+                std::swap(lhs, rhs);
+                static const std::unordered_map<std::string, std::string> flip{
+                    {"<", ">"}, {">", "<"}, {"<=", ">="}, {">=", "<="}, {"=", "="}, {"<>", "<>"}};
+                auto iter = flip.find(op);
+                if (iter == flip.end()) {
+                    return true;
+                }
+                op = iter->second;
+            }
+            if (lhs->GetType() != ExpressionType::ColumnExpression ||
+                rhs->GetType() != ExpressionType::ConstantExpression) {
+                return true;
+            }
+            auto column = dynamic_cast<ColumnValueExpression *>(lhs.get());
+            auto constant = dynamic_cast<ConstantValueExpression *>(rhs.get());
+            return zone_map_->MayMatch(page_id, column->GetColIdx(), op, constant->val_);
+        }
+        default:
+            return true;
+    }
+}
+
+AbstractExpressionRef SeqScanExecutor::EncodePredicate(const AbstractExpressionRef &expr, bool *ok) const {
+    TableHeap *table_heap = table_info_->GetTableHeap();
+    switch (expr->GetType()) {
+        case ExpressionType::LogicExpression: {
+            auto logic = dynamic_cast<LogicExpression *>(expr.get());
+            auto lhs = EncodePredicate(expr->GetChildAt(0), ok);
+            auto rhs = EncodePredicate(expr->GetChildAt(1), ok);
+            if (lhs == expr->GetChildAt(0) && rhs == expr->GetChildAt(1)) {
+                return expr;
+            }
+            return std::make_shared<LogicExpression>(lhs, rhs, logic->logic_type_);
+        }
+        case ExpressionType::ComparisonExpression: {
+            auto comparison = dynamic_cast<ComparisonExpression *>(expr.get());
+            std::string op = comparison->GetComparisonType();
+            auto lhs = expr->GetChildAt(0);
+            auto rhs = expr->GetChildAt(1);
+            if (lhs->GetType() == ExpressionType::ConstantExpression &&
+                rhs->GetType() == ExpressionType::ColumnExpression) {
+                std::swap(lhs, rhs);
+            }
+            if (lhs->GetType() == ExpressionType::ColumnExpression) {
+                auto column = dynamic_cast<ColumnValueExpression *>(lhs.get());
+                Dictionary *dictionary = table_heap->GetDictionary(column->GetColIdx());
+                // is null / is not null 在编码上同样成立
+                if (dictionary != nullptr && (op == "is" || op == "not")) {
+                    return expr;
+                }
+                if (dictionary != nullptr && (op == "=" || op == "<>") &&
+                    rhs->GetType() == ExpressionType::ConstantExpression) {
+                    auto constant = dynamic_cast<ConstantValueExpression *>(rhs.get());
+                    if (constant->val_.GetTypeId() != TypeId::kTypeChar) {
+                        *ok = false;
+                        return expr;
+                    }
+                    // 字典中没有的值编码为NO_CODE，和任何记录都不相等
+                    Field code = constant->val_.IsNull() ? Field(TypeId::kTypeInt)
+                                                         : Field(TypeId::kTypeInt,
+                                                                 dictionary->Lookup(constant->val_.GetData(),
+                                                                                    constant->val_.GetLength()));
+                    return std::make_shared<ComparisonExpression>(lhs, std::make_shared<ConstantValueExpression>(code),
+                                                                  op);
+                }
+            }
+            EncodePredicate(lhs, ok);
+            EncodePredicate(rhs, ok);
+            return expr;
+        }
+        case ExpressionType::ColumnExpression: {
+            auto column = dynamic_cast<ColumnValueExpression *>(expr.get());
+            if (table_heap->GetDictionary(column->GetColIdx()) != nullptr) {
+                *ok = false;
+            }
+            return expr;
+        }
+        default:
+            return expr;
+    }
+}
+
+bool SeqScanExecutor::ProduceRow(const Row &src, Row *row, Arena *arena) const {
+    // 如果返回的是kTypeInt的1，即正确
+    if (predicate_ != nullptr && !Field(TypeId::kTypeInt, 1).CompareEquals(predicate_->Evaluate(&src)))
+        return false;
+    // 输出字段直接从源行拷贝到arena中，不经过临时的vector<Field>
+    Row output(arena);
+    auto &fields = output.GetFields();
+    fields.reserve(output_ids_.size());
+    TableHeap *table_heap = table_info_->GetTableHeap();
+    for (auto col_index : output_ids_) {
+        Dictionary *dictionary = scan_codes_ ? table_heap->GetDictionary(col_index) : nullptr;
+        if (dictionary != nullptr) {
+            fields.push_back(output.NewField(dictionary->DecodeField(*src.GetField(col_index))));
+        } else {
+            fields.push_back(output.NewField(*src.GetField(col_index)));
+        }
+    }
+    output.SetRowId(src.GetRowId());
+    *row = std::move(output);
+    return true;
 }
 
 bool SeqScanExecutor::Next(Row *row, RowId *rid) {
-    // 找符合条件的row
-    while( table_iter_ != end_ ){
-        // 如果返回的是kTypeInt的1，即正确
-        if (  plan_->filter_predicate_ == nullptr ||
-              Field(TypeId::kTypeInt,1).CompareEquals(plan_->filter_predicate_->Evaluate(&(*table_iter_))) ){
-            vector<Field> output;output.clear();
-            for( auto col : plan_->OutputSchema()->GetColumns() ){
-                ::uint32_t col_index;
-                table_info_->GetSchema()->GetColumnIndex(col->GetName(),col_index);
-                output.push_back(*(*table_iter_).GetField(col_index));
-            }
-            *row = Row(output);
-            auto t=*table_iter_;
-            row->SetRowId((*table_iter_).GetRowId());
+    if (parallel_) {
+        // 依次返回各个morsel的结果，取完最早的一个再提交下一个
+        while (!morsels_.empty()) {
+            Morsel &morsel = morsels_.front();
+            if (morsel.done.valid()) {
+                morsel.done.get();
+            }
+            if (row_idx_ < morsel.rows.size()) {
+                *row = std::move(morsel.rows[row_idx_++]);
+                *rid = row->GetRowId();
+                return true;
+            }
+            morsels_.pop_front();
+            row_idx_ = 0;
+            SubmitMorsels();
+        }
+        return false;
+    }
+    // 找符合条件的row，当前页扫完后跳过zone map排除的页
+    while (true) {
+        while (table_iter_ != end_) {
+            bool produced = ProduceRow(*table_iter_, row, arena_);
             ++table_iter_;
-            *rid = row->GetRowId();
-            return true;
+            if (produced) {
+                *rid = row->GetRowId();
+                return true;
+            }
+        }
+        while (page_pos_ < page_ids_.size() && !PageMayMatch(page_ids_[page_pos_])) {
+            page_pos_++;
+        }
+        if (page_pos_ == page_ids_.size()) {
+            return false;
         }
-        else ++table_iter_;
+        table_iter_ = OpenPage(page_pos_++);
     }
-    return false;
 }
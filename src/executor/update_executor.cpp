@@ -9,8 +9,23 @@ void UpdateExecutor::Init() {
     // 把table和indexes存储起来
     std::string table_name = plan_->GetTableName();
     CatalogManager *catalog = exec_ctx_->GetCatalog();
-    dberr_t ret = catalog->GetTable(table_name, table_info_);
+    catalog->GetTable(table_name, table_info_);
     catalog->GetTableIndexes(table_name,index_info_);
+    // 预先算好每个索引的key列，以及SET是否涉及这些列
+    index_key_ids_.clear();
+    index_affected_.clear();
+    for (auto index : index_info_) {
+        std::vector<uint32_t> key_ids;
+        bool affected = false;
+        for (auto col : index->GetIndexKeySchema()->GetColumns()) {
+            uint32_t col_index;
+            table_info_->GetSchema()->GetColumnIndex(col->GetName(), col_index);
+            key_ids.push_back(col_index);
+            affected = affected || plan_->GetUpdateAttr().count(col_index) > 0;
+        }
+        index_key_ids_.push_back(std::move(key_ids));
+        index_affected_.push_back(affected);
+    }
 }
 
 bool UpdateExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
@@ -19,27 +34,34 @@ bool UpdateExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
         return false;
     TableHeap* table_heap = table_info_->GetTableHeap();
     //获取新元组
-    Row* new_row = new Row(GenerateUpdatedTuple(*row));
-    new_row->SetRowId(row->GetRowId());
-    //修改表
-    table_heap->UpdateTuple(*new_row,*rid, nullptr);
-    //修改索引
-    for( auto index : index_info_ ){
-        // 取出key
+    Row new_row = GenerateUpdatedTuple(*row);
+    new_row.SetRowId(*rid);
+    //修改表，放不下时堆表会转发，rid不变
+    if (!table_heap->UpdateTuple(new_row, *rid, nullptr))
+        return true;
+    table_info_->GetStatistics()->OnUpdate(new_row);
+    //只修改key真正变化了的索引
+    for (size_t i = 0; i < index_info_.size(); i++) {
+        if (!index_affected_[i])
+            continue;
         vector<Field> remove_key;
         vector<Field> insert_key;
-        for( auto col : index->GetIndexKeySchema()->GetColumns() ){
-            uint32_t col_index;
-            table_info_->GetSchema()->GetColumnIndex(col->GetName(),col_index);
-            remove_key.push_back(*(row->GetField(col_index)));
-            insert_key.push_back(*(new_row->GetField(col_index)));
+        bool changed = false;
+        for (auto col_index : index_key_ids_[i]) {
+            Field *old_field = row->GetField(col_index);
+            Field *new_field = new_row.GetField(col_index);
+            remove_key.push_back(*old_field);
+            insert_key.push_back(*new_field);
+            if (old_field->IsNull() != new_field->IsNull() ||
+                (!old_field->IsNull() && old_field->CompareEquals(*new_field) != CmpBool::kTrue))
+                changed = true;
         }
-        // 删去之前的index
-        index->GetIndex()->RemoveEntry(Row(remove_key), RowId(), nullptr);
-        // 加上新的index
-        index->GetIndex()->InsertEntry(Row(insert_key), new_row->GetRowId(), nullptr);
+        if (!changed)
+            continue;
+        auto index = index_info_[i]->GetIndex();
+        index->RemoveEntry(Row(remove_key), *rid, nullptr);
+        index->InsertEntry(Row(insert_key), *rid, nullptr);
     }
-    row = nullptr;
     return true;
 }
 
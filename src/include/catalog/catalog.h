@@ -76,7 +76,11 @@ class CatalogManager {
 
   ~CatalogManager();
 
-  dberr_t CreateTable(const std::string &table_name, TableSchema *schema, Transaction *txn, TableInfo *&table_info);
+  /**
+   * @param dictionary_columns char columns stored dictionary encoded
+   */
+  dberr_t CreateTable(const std::string &table_name, TableSchema *schema, Transaction *txn, TableInfo *&table_info,
+                      TableLayout layout = TableLayout::kRow, const std::vector<uint32_t> &dictionary_columns = {});
 
   dberr_t GetTable(const std::string &table_name, TableInfo *&table_info);
 
@@ -84,7 +88,8 @@ class CatalogManager {
 
   dberr_t CreateIndex(const std::string &table_name, const std::string &index_name,
                       const std::vector<std::string> &index_keys, Transaction *txn, IndexInfo *&index_info,
-                      const string &index_type);
+                      const string &index_type, bool unique = true,
+                      const std::vector<std::string> &include_keys = {});
 
   dberr_t GetIndex(const std::string &table_name, const std::string &index_name, IndexInfo *&index_info) const;
 
@@ -94,11 +99,20 @@ class CatalogManager {
 
   dberr_t DropIndex(const std::string &table_name, const std::string &index_name);
 
+  /**
+   * Recompute the statistics of a table by a full scan and persist them.
+   * Char columns of row layout tables with few distinct values are switched to dictionary encoding.
+   */
+  dberr_t AnalyzeTable(const std::string &table_name);
+
  private:
   dberr_t DropTable(table_id_t table_id);
 
   dberr_t FlushCatalogMetaPage() const;
 
+  /** Write the metadata and the statistics of a table to its meta page */
+  dberr_t FlushTableMetaPage(table_id_t table_id);
+
   dberr_t LoadTable(const table_id_t table_id, const page_id_t page_id);
 
   dberr_t LoadIndex(const index_id_t index_id, const page_id_t page_id);
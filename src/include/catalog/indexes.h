@@ -7,6 +7,7 @@
 #include "common/macros.h"
 #include "common/rowid.h"
 #include "index/b_plus_tree_index.h"
+#include "index/extendible_hash_index.h"
 #include "index/generic_key.h"
 #include "record/schema.h"
 
@@ -15,7 +16,8 @@ class IndexMetadata {
 
  public:
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                               const std::vector<uint32_t> &key_map);
+                               const std::vector<uint32_t> &key_map, bool unique = true,
+                               uint32_t include_count = 0, const std::string &index_type = "bptree");
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -33,11 +35,21 @@ class IndexMetadata {
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  /** @return whether a key may appear only once, a non-unique index keeps one entry per (key, RowId) */
+  inline bool IsUnique() const { return unique_; }
+
+  /** @return the number of INCLUDE columns, the last entries of the key mapping stored as payload */
+  inline uint32_t GetIncludeCount() const { return include_count_; }
+
+  /** @return the index structure, "bptree" or "hash" */
+  inline const std::string &GetIndexType() const { return index_type_; }
+
  private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                         const std::vector<uint32_t> &key_map);
+                         const std::vector<uint32_t> &key_map, bool unique, uint32_t include_count,
+                         const std::string &index_type);
 
  private:
   static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
@@ -45,6 +57,9 @@ class IndexMetadata {
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_; /** The mapping of index key to tuple key */
+  bool unique_;
+  uint32_t include_count_;
+  std::string index_type_;
 };
 
 /**
@@ -73,12 +88,8 @@ class IndexInfo {
     }
     key_schema_ = Schema::ShallowCopySchema(table_info_->GetSchema(), column_index);
     // Step3: call CreateIndex to create the index
-    index_ = CreateIndex(buffer_pool_manager,"bptree");
-
-    // 这块暂时不应该存在。如果是重新读取Index的话，那就会导致在原有的Index上重新InsertEntry
-    // 或许有关这一块的处理得加载CatalogManager::CreateIndex那里
-    // 目前的状态就是：索引必须在table刚创建的时候创建，不然table中原有的数据不会纳入索引
-    // 把整个table InsertEntry
+    index_ = CreateIndex(buffer_pool_manager, meta_data->GetIndexType());
+    // 已有记录由CatalogManager::CreateIndex批量装入，重新加载的索引不再插入
   }
 
   inline Index *GetIndex() { return index_; }
@@ -87,6 +98,13 @@ class IndexInfo {
 
   IndexSchema *GetIndexKeySchema() { return key_schema_; }
 
+  bool IsUnique() const { return meta_data_->IsUnique(); }
+
+  /** @return the number of leading columns of the key schema that order the index, the rest are INCLUDE columns */
+  uint32_t GetKeyColumnCount() const { return key_schema_->GetColumnCount() - meta_data_->GetIncludeCount(); }
+
+  const std::string &GetIndexType() const { return meta_data_->GetIndexType(); }
+
  private:
   explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, key_schema_{nullptr} {}
 
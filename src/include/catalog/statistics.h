@@ -0,0 +1,128 @@
+#ifndef MINISQL_STATISTICS_H
+#define MINISQL_STATISTICS_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+class TableHeap;
+
+/**
+ * ColumnStatistics is the optimizer synopsis of one column:
+ *  - the fraction of nulls,
+ *  - a HyperLogLog sketch (STATS_HLL_REGISTERS one byte registers) estimating the number of distinct values,
+ *  - for int/float columns an equi-depth histogram, bounds_[0] is the minimum and bounds_[i] the upper bound of
+ *    bucket i-1, every bucket holds the same share of the non-null values.
+ * The sketch can absorb new values at any time, the histogram is only rebuilt by ANALYZE.
+ */
+class ColumnStatistics {
+ public:
+  explicit ColumnStatistics(TypeId type);
+
+  /** Add a value to the distinct value sketch */
+  void AddDistinct(const Field &field);
+
+  /** @return the estimated number of distinct non-null values */
+  double GetDistinctCount() const;
+
+  /**
+   * Rebuild the histogram from the (sampled) non-null values of the column
+   * @param values will be sorted
+   */
+  void BuildHistogram(std::vector<double> &values, uint32_t bucket_count);
+
+  void SetNullFraction(double null_frac) { null_frac_ = null_frac; }
+
+  double GetNullFraction() const { return null_frac_; }
+
+  uint32_t GetBucketCount() const { return bounds_.empty() ? 0 : bounds_.size() - 1; }
+
+  /** Merge adjacent buckets until at most bucket_count are left */
+  void ShrinkHistogram(uint32_t bucket_count);
+
+  /**
+   * @return the estimated fraction of rows satisfying `column op value`,
+   *         op is one of the operators of ComparisonExpression
+   */
+  double EstimateSelectivity(const std::string &op, const Field &value) const;
+
+  uint32_t SerializeTo(char *buf) const;
+
+  uint32_t GetSerializedSize() const;
+
+  static uint32_t DeserializeFrom(char *buf, ColumnStatistics *column_stats);
+
+  /** @return the value of an int/float field as a double, false for other types and nulls */
+  static bool ToDouble(const Field &field, double *value);
+
+ private:
+  /** @return the estimated fraction of non-null values <= value (< value if strict) */
+  double EstimateLessThan(double value, bool strict) const;
+
+  TypeId type_;
+  double null_frac_{0};
+  uint8_t registers_[STATS_HLL_REGISTERS]{};
+  std::vector<double> bounds_;
+};
+
+/**
+ * TableStatistics holds the statistics ANALYZE computed for one table plus counters kept current by DML:
+ * the row count is adjusted by every insert and delete, inserted and updated values are added to the
+ * distinct value sketches, and modified_rows_ counts the changes since the last ANALYZE.
+ * The histograms and the page count are only refreshed by ANALYZE.
+ */
+class TableStatistics {
+ public:
+  explicit TableStatistics(Schema *schema);
+
+  /** Replace the statistics by the result of a full scan */
+  void Analyze(TableHeap *table_heap);
+
+  void OnInsert(const Row &row);
+
+  void OnDelete();
+
+  void OnUpdate(const Row &new_row);
+
+  bool IsAnalyzed() const { return analyzed_; }
+
+  uint64_t GetRowCount() const { return row_count_; }
+
+  uint32_t GetPageCount() const { return page_count_; }
+
+  uint64_t GetModifiedRows() const { return modified_rows_; }
+
+  const ColumnStatistics &GetColumnStatistics(uint32_t column_id) const { return columns_[column_id]; }
+
+  uint32_t GetColumnCount() const { return columns_.size(); }
+
+  /** @return whether the statistics changed since they were last serialized */
+  bool IsDirty() const { return dirty_; }
+
+  /** Merge histogram buckets until the serialized statistics fit into max_size bytes */
+  void Fit(uint32_t max_size);
+
+  uint32_t SerializeTo(char *buf);
+
+  uint32_t GetSerializedSize() const;
+
+  /** @return the size read, 0 (and nothing changed) if buf holds no statistics of this schema */
+  uint32_t DeserializeFrom(char *buf);
+
+ private:
+  static constexpr uint32_t TABLE_STATISTICS_MAGIC_NUM = 270611;
+  mutable std::mutex latch_;
+  Schema *schema_;
+  bool analyzed_{false};
+  bool dirty_{false};
+  uint64_t row_count_{0};
+  uint32_t page_count_{0};
+  uint64_t modified_rows_{0};
+  std::vector<ColumnStatistics> columns_;
+};
+
+#endif  // MINISQL_STATISTICS_H
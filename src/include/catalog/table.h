@@ -1,8 +1,10 @@
 #ifndef MINISQL_TABLE_H
 #define MINISQL_TABLE_H
 
+#include <map>
 #include <memory>
 
+#include "catalog/statistics.h"
 #include "glog/logging.h"
 #include "record/schema.h"
 #include "storage/table_heap.h"
@@ -23,7 +25,7 @@ class TableMetadata {
    * will create new table schema and owned by mem heap
    */
   static TableMetadata *Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
-                               TableSchema *schema);
+                               TableSchema *schema, TableLayout layout = TableLayout::kRow);
 
   inline table_id_t GetTableId() const { return table_id_; }
 
@@ -33,10 +35,18 @@ class TableMetadata {
 
   inline Schema *GetSchema() const { return schema_; }
 
+  inline TableLayout GetLayout() const { return layout_; }
+
+  /** @return column id -> first page of the dictionary, for the dictionary encoded columns */
+  inline const std::map<uint32_t, page_id_t> &GetDictionaryPages() const { return dictionary_pages_; }
+
+  inline void SetDictionaryPage(uint32_t column_id, page_id_t page_id) { dictionary_pages_[column_id] = page_id; }
+
  private:
   TableMetadata() = delete;
 
-  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                TableLayout layout);
 
  private:
   static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
@@ -44,6 +54,8 @@ class TableMetadata {
   std::string table_name_;
   page_id_t root_page_id_;
   Schema *schema_;
+  TableLayout layout_;
+  std::map<uint32_t, page_id_t> dictionary_pages_;
 };
 
 /**
@@ -54,6 +66,7 @@ class TableInfo {
   static TableInfo *Create() { return new TableInfo(); }
 
   ~TableInfo() {
+    delete statistics_;
     delete table_meta_;
     delete table_heap_;
   }
@@ -61,6 +74,7 @@ class TableInfo {
   void Init(TableMetadata *table_meta, TableHeap *table_heap) {
     table_meta_ = table_meta;
     table_heap_ = table_heap;
+    statistics_ = new TableStatistics(table_meta->schema_);
   }
 
   inline TableHeap *GetTableHeap() const { return table_heap_; }
@@ -73,12 +87,20 @@ class TableInfo {
 
   inline page_id_t GetRootPageId() const { return table_meta_->root_page_id_; }
 
+  inline TableLayout GetLayout() const { return table_meta_->layout_; }
+
+  inline TableMetadata *GetTableMeta() const { return table_meta_; }
+
+  // 统计信息保存在table meta page中metadata之后
+  inline TableStatistics *GetStatistics() const { return statistics_; }
+
  private:
   explicit TableInfo(){};
 
  private:
   TableMetadata *table_meta_;
   TableHeap *table_heap_;
+  TableStatistics *statistics_{nullptr};
 };
 
 #endif  // MINISQL_TABLE_H
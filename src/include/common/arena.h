@@ -0,0 +1,71 @@
+#ifndef MINISQL_ARENA_H
+#define MINISQL_ARENA_H
+
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * Arena is a bump allocator: memory is carved from large blocks and is never freed piece by piece,
+ * all of it is released at once by Reset or the destructor. Destructors of objects placed in an arena
+ * are not run, so only objects that own no other memory (e.g. fields whose payload is in the arena)
+ * may live there. An arena is not thread safe, every thread allocates from its own arena.
+ */
+class Arena {
+ public:
+  explicit Arena(size_t block_size = ARENA_BLOCK_SIZE) : block_size_(block_size) {}
+
+  ~Arena();
+
+  DISALLOW_COPY_AND_MOVE(Arena);
+
+  void *Allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+    size_t padding = (align - reinterpret_cast<uintptr_t>(cur_) % align) % align;
+    if (cur_ == nullptr || padding + size > remaining_) {
+      NewBlock(size + align);
+      padding = (align - reinterpret_cast<uintptr_t>(cur_) % align) % align;
+    }
+    char *result = cur_ + padding;
+    cur_ += padding + size;
+    remaining_ -= padding + size;
+    bytes_used_ += size;
+    return result;
+  }
+
+  /** @return a copy of len bytes of data in the arena */
+  char *CopyBytes(const char *data, size_t len) {
+    auto result = static_cast<char *>(Allocate(len, 1));
+    memcpy(result, data, len);
+    return result;
+  }
+
+  /** Construct a T in the arena, its destructor will never be called */
+  template <typename T, typename... Args>
+  T *New(Args &&...args) {
+    return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  /** Release everything allocated so far, the first block is kept for reuse */
+  void Reset();
+
+  /** @return the bytes handed out since the last Reset */
+  size_t GetBytesUsed() const { return bytes_used_; }
+
+  size_t GetBlockCount() const { return blocks_.size(); }
+
+ private:
+  /** Start a new block of at least min_size bytes */
+  void NewBlock(size_t min_size);
+
+  size_t block_size_;
+  std::vector<std::pair<char *, size_t>> blocks_;  // 每块的起始地址和大小
+  char *cur_{nullptr};
+  size_t remaining_{0};
+  size_t bytes_used_{0};
+};
+
+#endif  // MINISQL_ARENA_H
@@ -17,7 +17,29 @@ static constexpr int PAGE_SIZE = 4096;                  // size of a data page i
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
-static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
+static constexpr uint32_t VARCHAR_MAX_LEN = 64 * PAGE_SIZE;  // max length of varchar
+
+static constexpr uint32_t TUPLE_INLINE_VALUE_MAX = 256;       // longer char values of row tables go to overflow pages
+static constexpr uint32_t FIELD_OVERFLOW_FLAG = 0x80000000;  // length bit of a char value stored in overflow pages
+
+static constexpr uint32_t SEQ_SCAN_MORSEL_PAGES = 8;          // pages handed to one parallel scan task
+static constexpr uint32_t SEQ_SCAN_PARALLEL_MIN_MORSELS = 2;  // smaller tables are scanned by the caller
+static constexpr uint32_t SEQ_SCAN_MORSELS_PER_THREAD = 2;    // scanned morsels a parallel scan buffers ahead
+
+static constexpr uint32_t STATS_HLL_REGISTERS = 64;         // registers of a distinct value sketch, power of 2
+static constexpr uint32_t STATS_HISTOGRAM_BUCKETS = 16;     // buckets of an equi-depth histogram
+static constexpr uint32_t STATS_SAMPLE_SIZE = 30000;        // values sampled per column to build a histogram
+static constexpr double STATS_INDEX_MAX_SELECTIVITY = 0.1;  // less selective predicates are answered by seq scan
+
+static constexpr uint32_t DICT_AUTO_MAX_DISTINCT = 1024;  // ANALYZE dictionary encodes char columns with fewer values
+static constexpr uint32_t DICT_AUTO_MIN_REPEAT = 4;       // whose values also repeat this often on average
+
+static constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;  // block size of the per-query row arena
+
+static constexpr size_t INDEX_SORT_BUFFER_SIZE = 16 * 1024 * 1024;  // index build entries sorted in memory per run
+static constexpr double INDEX_BULK_LOAD_FILL_FACTOR = 0.9;          // fill of the pages of a bulk loaded B+ tree
+static constexpr double INDEX_APPEND_SPLIT_RATIO = 0.9;  // entries kept left when the rightmost B+ tree page splits on an append
+static constexpr uint32_t HASH_DIRECTORY_MAX_DEPTH = 9;  // global depth limit of the one page hash index directory
 
 // static std::string DB_META_FILE = "minisql.meta.db";
 
@@ -0,0 +1,21 @@
+#ifndef MINISQL_HASH_UTIL_H
+#define MINISQL_HASH_UTIL_H
+
+#include <cstdint>
+
+/** FNV-1a加murmur的finalizer，保证低位和高位都足够随机 */
+inline uint64_t HashBytes(const char *data, uint32_t len) {
+  uint64_t h = 14695981039346656037ULL;
+  for (uint32_t i = 0; i < len; i++) {
+    h ^= static_cast<uint8_t>(data[i]);
+    h *= 1099511628211ULL;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+#endif  // MINISQL_HASH_UTIL_H
@@ -0,0 +1,45 @@
+#ifndef MINISQL_THREAD_POOL_H
+#define MINISQL_THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/macros.h"
+
+/**
+ * Fixed size pool of worker threads pulling tasks from one FIFO queue.
+ * Tasks of different queries share the pool, so a caller waits on the futures of its own tasks.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t num_threads);
+
+  ~ThreadPool();
+
+  DISALLOW_COPY(ThreadPool);
+
+  /** Queue a task, the future becomes ready when the task has run */
+  std::future<void> Submit(std::function<void()> task);
+
+  size_t GetThreadCount() const { return workers_.size(); }
+
+  /** @return the pool shared by all executors, one thread per hardware thread */
+  static ThreadPool &Instance();
+
+ private:
+  void WorkerLoop();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::packaged_task<void()>> tasks_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool shutdown_{false};
+};
+
+#endif  // MINISQL_THREAD_POOL_H
@@ -5,8 +5,15 @@
 #ifndef MINISQL_EXECUTE_CONTEXT_H
 #define MINISQL_EXECUTE_CONTEXT_H
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
+#include "common/arena.h"
 #include "common/macros.h"
 #include "transaction/transaction.h"
 
@@ -34,6 +41,31 @@ class ExecuteContext {
   /** @return the buffer pool manager */
   BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
+  /** Count heap pages a scan did not fetch because their zone map ruled them out */
+  void AddPagesSkipped(uint32_t pages) { pages_skipped_ += pages; }
+
+  /** @return the heap pages skipped by all scans of this query */
+  uint32_t GetPagesSkipped() const { return pages_skipped_; }
+
+  /** Allocate the rows of this query from arenas, they are all freed with the context */
+  void EnableArena() { arena_enabled_ = true; }
+
+  /**
+   * @return the arena of the calling thread (each worker of a parallel scan gets its own),
+   *         nullptr if rows are allocated on the heap
+   */
+  Arena *GetArena() {
+    if (!arena_enabled_) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> guard(arena_latch_);
+    auto &arena = arenas_[std::this_thread::get_id()];
+    if (arena == nullptr) {
+      arena = std::make_unique<Arena>();
+    }
+    return arena.get();
+  }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -41,6 +73,12 @@ class ExecuteContext {
   CatalogManager *catalog_;
   /** The buffer pool manager associated with this executor context */
   BufferPoolManager *bpm_;
+  /** 并行扫描的worker也会累加 */
+  std::atomic<uint32_t> pages_skipped_{0};
+  /** 结果行的arena，语句结束时整体释放 */
+  bool arena_enabled_{false};
+  std::mutex arena_latch_;
+  std::unordered_map<std::thread::id, std::unique_ptr<Arena>> arenas_;
 };
 
 #endif  // MINISQL_EXECUTE_CONTEXT_H
@@ -63,6 +63,8 @@ private:
 
     dberr_t ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context);
 
+    dberr_t ExecuteAnalyze(pSyntaxNode ast, ExecuteContext *context);
+
     dberr_t ExecuteTrxBegin(pSyntaxNode ast, ExecuteContext *context);
 
     dberr_t ExecuteTrxCommit(pSyntaxNode ast, ExecuteContext *context);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+
+#include "executor/executors/index_scan_executor.h"
+
+/**
+ * The IndexOnlyScanExecutor scans a covering index: the index key and INCLUDE columns hold every column the query
+ * outputs or filters on, so rows are decoded from the leaf entries and no table page is read. The range is chosen
+ * as in IndexScanExecutor. Char values of table rows fit their columns, so the keys hold them completely.
+ */
+class IndexOnlyScanExecutor : public IndexScanExecutor {
+ public:
+  IndexOnlyScanExecutor(ExecuteContext *exec_ctx, const IndexScanPlanNode *plan);
+
+  void Init() override;
+
+  bool Next(Row *row, RowId *rid) override;
+
+ private:
+  /** Table column id of each column of the index key schema */
+  std::vector<uint32_t> key_ids_;
+};
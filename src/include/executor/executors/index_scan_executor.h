@@ -5,40 +5,64 @@
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/index_scan_plan.h"
+#include "index/index_iterator.h"
 #include "planner/expressions/column_value_expression.h"
 #include "planner/expressions/comparison_expression.h"
 
 /**
- * The IndexScanExecutor executor can over a table.
+ * The IndexScanExecutor executes a range scan over one B+ tree index of the table, or a lookup in a hash index.
+ * Init matches the ANDed comparisons against the key columns of each index in order: a prefix of columns fixed by
+ * equality, then the tightest [low, high] range on the next column, e.g. `a = 3 and b > 100` on (a, b) scans the
+ * keys between (3, 100) exclusive and (3) inclusive. The index with the longest equality prefix (then the most
+ * range bounds) is scanned. Next streams row ids from the index iterator one at a time, fetches the row and applies
+ * the whole predicate, so no intermediate result is materialized. A hash index qualifies only when every key column
+ * is fixed by equality, and is then preferred over a B+ tree with the same equality prefix.
  */
 class IndexScanExecutor : public AbstractExecutor {
  public:
   /**
-   * Construct a new SeqScanExecutor instance.
+   * Construct a new IndexScanExecutor instance.
    * @param exec_ctx The executor context
-   * @param plan The sequential scan plan to be executed
+   * @param plan The index scan plan to be executed
    */
   IndexScanExecutor(ExecuteContext *exec_ctx, const IndexScanPlanNode *plan);
 
-  /** Initialize the sequential scan */
+  /** Initialize the index scan */
   void Init() override;
 
   /**
-   * Yield the next row from the sequential scan.
+   * Yield the next row from the index scan.
    * @param[out] row The next row produced by the scan
    * @param[out] rid The next row RID produced by the scan
    * @return `true` if a row was produced, `false` if there are no more rows
    */
   bool Next(Row *row, RowId *rid) override;
 
-  /** @return The output schema for the sequential scan */
+  /** @return The output schema for the index scan */
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
- private:
+ protected:
+  /**
+   * Apply the filter predicate and the projection to a row laid out like the table.
+   * @return false if the row is filtered out
+   */
+  bool ProduceRow(const Row &src, Row *row) const;
 
-  /** The sequential scan plan node to be executed */
+  /** The index scan plan node to be executed */
   const IndexScanPlanNode *plan_;
-    vector<RowId> result_rid; //新加
-    vector<Row> result_row; //新加
-    size_t cursor_{0}; //新加
-};
\ No newline at end of file
+  TableInfo *table_info_{nullptr};
+  /** The index chosen by Init */
+  IndexInfo *index_info_{nullptr};
+  /** 输出行所在的arena */
+  Arena *arena_{nullptr};
+  /** Table column id of each output column */
+  std::vector<uint32_t> output_ids_;
+  /** 范围的上下界，迭代器只在构造时读取 */
+  std::vector<Field> low_fields_;
+  std::vector<Field> high_fields_;
+  IndexIterator iter_;
+  IndexIterator end_;
+  /** 哈希索引一次查找得到的row id */
+  std::vector<RowId> rids_;
+  size_t rid_pos_{0};
+};
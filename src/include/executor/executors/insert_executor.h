@@ -47,6 +47,8 @@ class InsertExecutor : public AbstractExecutor {
   std::unique_ptr<AbstractExecutor> child_executor_;
   std::vector<IndexInfo *> index_info_; // 新加
   TableInfo *table_info_;   // 新加
+  /** 每个索引的key列在表中的下标，唯一索引在前 */
+  std::vector<std::vector<uint32_t>> index_key_ids_;
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
@@ -5,6 +5,8 @@
 #ifndef MINISQL_SEQ_SCAN_EXECUTOR_H
 #define MINISQL_SEQ_SCAN_EXECUTOR_H
 
+#include <deque>
+#include <future>
 #include <vector>
 
 #include "executor/execute_context.h"
@@ -13,6 +15,14 @@
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ * Pages whose zone map synopsis rules out the filter predicate are skipped before they are fetched.
+ * Tables of at least SEQ_SCAN_PARALLEL_MIN_MORSELS morsels are scanned in parallel: the page list is cut
+ * into morsels of SEQ_SCAN_MORSEL_PAGES pages, workers of the shared ThreadPool filter one morsel each,
+ * and Next returns the results morsel by morsel, i.e. in the same order as a serial scan. At most
+ * SEQ_SCAN_MORSELS_PER_THREAD morsels per worker are scanned ahead, the next one is submitted when Next has
+ * drained the oldest, so the buffered rows do not grow with the table and a consumer that stops early stops the scan.
+ * On tables with dictionary encoded columns rows are scanned as stored: equality predicates on such a column
+ * compare int codes (the constant is looked up once), and only the output columns of matching rows are decoded.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -23,6 +33,9 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan);
 
+  /** Wait for the morsels still being scanned, they write into this executor */
+  ~SeqScanExecutor() override;
+
   /** Initialize the sequential scan */
   void Init() override;
 
@@ -38,12 +51,65 @@ class SeqScanExecutor : public AbstractExecutor {
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
  private:
+  /**
+   * Apply the filter predicate and the projection to a table row.
+   * @param arena the output row is allocated here, nullptr allocates it on the heap
+   * @return false if the row is filtered out
+   */
+  bool ProduceRow(const Row &src, Row *row, Arena *arena) const;
+
+  /** Scan the pages page_ids_[begin, end) into result */
+  void ScanMorsel(size_t begin, size_t end, std::vector<Row> *result);
+
+  /** Submit morsels until the scan-ahead window is full or every morsel is submitted */
+  void SubmitMorsels();
+
+  /** Wait for all submitted morsels and drop their results */
+  void DrainMorsels();
+
+  /** @return an iterator over the single page page_ids_[pos] */
+  TableIterator OpenPage(size_t pos);
+
+  /** Consult the zone map, pages that are ruled out are counted as skipped */
+  bool PageMayMatch(page_id_t page_id);
+
+  /** @return false only if the zone map proves that no row of the page satisfies expr */
+  bool MayMatch(const AbstractExpressionRef &expr, page_id_t page_id) const;
+
+  /**
+   * Rewrite `column = 'value'` and `column <> 'value'` on dictionary encoded columns to compare codes.
+   * ok is cleared if a dictionary encoded column is used in any other way, the scan then decodes every row.
+   */
+  AbstractExpressionRef EncodePredicate(const AbstractExpressionRef &expr, bool *ok) const;
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableInfo *table_info_;
+  /** 串行扫描输出行所在的arena，nullptr表示分配在堆上 */
+  Arena *arena_{nullptr};
+  /** Table column id of each output column */
+  std::vector<uint32_t> output_ids_;
   //遍历后得到的结果
   TableIterator table_iter_;
   TableIterator end_;
+  ZoneMap *zone_map_{nullptr};
+  /** 实际求值的谓词，按编码扫描时常量已换成字典编码 */
+  AbstractExpressionRef predicate_;
+  bool scan_codes_{false};
+  /** 扫描开始时的页目录，串行扫描逐页推进 */
+  std::vector<page_id_t> page_ids_;
+  size_t page_pos_{0};
+  /** 并行扫描时已提交的morsel，按页链顺序排列，deque两端增删不移动已有元素 */
+  struct Morsel {
+    std::future<void> done;
+    std::vector<Row> rows;
+  };
+  bool parallel_{false};
+  std::deque<Morsel> morsels_;
+  size_t morsel_count_{0};
+  size_t next_morsel_{0};
+  size_t max_morsels_{0};
+  size_t row_idx_{0};
 };
 
 #endif  // MINISQL_SEQ_SCAN_EXECUTOR_H
@@ -58,6 +58,10 @@ class UpdateExecutor : public AbstractExecutor {
   /** The child executor to obtain value from */
   std::unique_ptr<AbstractExecutor> child_executor_;
   TableInfo* table_info_;//新增
+  /** 每个索引的key列在表中的下标 */
+  std::vector<std::vector<uint32_t>> index_key_ids_;
+  /** key列中有被SET修改的索引，其余索引的key不会变 */
+  std::vector<bool> index_affected_;
 };
 
 #endif  // MINISQL_UPDATE_EXECUTOR_H
@@ -16,14 +16,16 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_name The identifier of table to be scanned
+   * @param index_only every index covers the output and predicate columns, rows are built from the index keys
    */
   IndexScanPlanNode(const Schema *output, std::string table_name, std::vector<IndexInfo *> indexes, bool need_filter,
-                    AbstractExpressionRef filter_predicate = nullptr)
+                    AbstractExpressionRef filter_predicate = nullptr, bool index_only = false)
       : AbstractPlanNode(output, {}),
         table_name_(std::move(table_name)),
         indexes_(std::move(indexes)),
         need_filter_(need_filter),
-        filter_predicate_(std::move(filter_predicate)) {}
+        filter_predicate_(std::move(filter_predicate)),
+        index_only_(index_only) {}
 
   /** @return The type of the plan node */
   PlanType GetType() const override { return PlanType::IndexScan; }
@@ -44,4 +46,7 @@ class IndexScanPlanNode : public AbstractPlanNode {
 
   /** The predicate to filter in IndexScan.*/
   AbstractExpressionRef filter_predicate_;
+
+  /** Whether the scan reads no table pages (see IndexOnlyScanExecutor) */
+  bool index_only_ = false;
 };
\ No newline at end of file
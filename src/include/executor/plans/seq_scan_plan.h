@@ -15,11 +15,16 @@ class SeqScanPlanNode : public AbstractPlanNode {
    * Construct a new SeqScanPlanNode instance.
    * @param output The output schema of this sequential scan plan node
    * @param table_name The identifier of table to be scanned
+   * @param column_ids Ascending table column ids the scan has to decode (output + predicate), empty means all
+   * @param output_ids Table column id of each output column, empty means resolve by name at Init
    */
-  SeqScanPlanNode(const Schema *output, std::string table_name, AbstractExpressionRef filter_predicate = nullptr)
+  SeqScanPlanNode(const Schema *output, std::string table_name, AbstractExpressionRef filter_predicate = nullptr,
+                  std::vector<uint32_t> column_ids = {}, std::vector<uint32_t> output_ids = {})
       : AbstractPlanNode(output, {}),
         table_name_(std::move(table_name)),
-        filter_predicate_(std::move(filter_predicate)) {}
+        filter_predicate_(std::move(filter_predicate)),
+        column_ids_(std::move(column_ids)),
+        output_ids_(std::move(output_ids)) {}
 
   /** @return The type of the plan node */
   PlanType GetType() const override { return PlanType::SeqScan; }
@@ -34,6 +39,12 @@ class SeqScanPlanNode : public AbstractPlanNode {
 
   /** The predicate to filter in SeqScan.*/
   AbstractExpressionRef filter_predicate_;
+
+  /** Columns decoded from the table page, resolved at plan time. */
+  std::vector<uint32_t> column_ids_;
+
+  /** Output column i is taken from table column output_ids_[i]. */
+  std::vector<uint32_t> output_ids_;
 };
 
 #endif  // MINISQL_SEQ_SCAN_PLAN_H
@@ -1,11 +1,17 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <atomic>
+#include <mutex>
 #include <queue>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "index/index_iterator.h"
+#include "index/index_sorter.h"
 #include "page/b_plus_tree_internal_page.h"
 #include "page/b_plus_tree_leaf_page.h"
 #include "page/b_plus_tree_page.h"
@@ -16,41 +22,85 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, a non-unique index makes them unique by appending the RowId (see KeyManager)
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Concurrent access by latch crabbing: lookups read latch their way down and hold at most two pages;
+ *     inserts and removes first try optimistically (read latches down, only the leaf write latched) and
+ *     retry pessimistically (write latches, released above every page that cannot split or merge) when the
+ *     leaf would split or underflow. root_latch_ protects root_page_id_. Iterators latch one leaf per step (see IndexIterator).
+ * (6) In LookupMode::kOptimistic (optimistic lock coupling) lookups and the optimistic write descent take no
+ *     latch on the way down: they read the page versions (odd while write latched), read the page and check
+ *     the version again, restarting from the root on a conflict. Pages merged away are deleted only when no
+ *     optimistic traversal is in flight.
+ * (7) The root page id is read once from the index roots page and cached in root_page_id_, which root splits and
+ *     merges update under root_latch_. The internal pages of the top levels can be kept resident (see
+ *     SetResidentLevels), a lookup then goes through the buffer pool only for the pages below them.
  */
 class BPlusTree {
+  friend class IndexIterator;
   using InternalPage = BPlusTreeInternalPage;
   using LeafPage = BPlusTreeLeafPage;
 
  public:
+  enum class LookupMode { kCrabbing, kOptimistic };
+
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
                      int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
 
+  ~BPlusTree();
+
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
   // Insert a key-value pair into this B+ tree.
   bool Insert(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
 
+  // Insert a key-value pair unless the key is present, the check and the insert share one leaf visit.
+  // @return false if the key is already present
+  bool InsertIfAbsent(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+
   // Remove a key and its value from this B+ tree.
   void Remove(const GenericKey *key, Transaction *transaction = nullptr);
 
   // return the value associated with a given key
   bool GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction = nullptr);
 
+  void SetLookupMode(LookupMode mode) { lookup_mode_ = mode; }
+
+  /**
+   * Keep the internal pages of the top levels (the root is level 0) resident: the first lookup that reads such a
+   * page pins it for good and later lookups use it without going through the buffer pool or its replacer.
+   * A page stays resident until it is deleted, also when a root split moves it below the top levels.
+   * 0 (the default) turns this off. Changing it releases the resident pages, not to be done concurrently
+   * with other operations on the tree.
+   */
+  void SetResidentLevels(int levels);
+
+  BufferPoolManager *GetBufferPoolManager() const { return buffer_pool_manager_; }
+
+  // Build this empty tree bottom up from the sorted entries of a finished sorter, writing every page once.
+  // Pages are filled to fill_factor of their max size, the last pages of a level are never under the min size.
+  // @return false if the tree is not empty or a key repeats, no page is left behind then
+  bool BulkLoad(IndexSorter *sorter, double fill_factor = INDEX_BULK_LOAD_FILL_FACTOR);
+
   IndexIterator Begin();
 
+  // iterator from the first key not less than key
   IndexIterator Begin(const GenericKey *key);
 
+  // iterator over the keys between low and high, a nullptr bound is open
+  IndexIterator Begin(const GenericKey *low, bool low_inclusive, const GenericKey *high, bool high_inclusive);
+
   IndexIterator End();
 
   // expose for test purpose
-  Page *FindLeafPage(const GenericKey *key, page_id_t page_id = INVALID_PAGE_ID, bool leftMost = false);
+  // @return the leaf page that may contain key (the left most leaf if leftMost), pinned and read latched,
+  //         nullptr if the tree is empty
+  Page *FindLeafPage(const GenericKey *key, bool leftMost = false);
 
-  // used to check whether all pages are unpinned
+  // used to check whether all pages are unpinned, the resident pages are released first
   bool Check();
 
   // destroy the b plus tree
@@ -68,31 +118,137 @@ class BPlusTree {
   }
 
  private:
+  enum class Operation { kInsert, kRemove };
+
+  /**
+   * The pages a pessimistic insert or remove holds write latched, top-down, and whether it holds the root id
+   * latch. Pages emptied by the operation are deleted once all latches are released.
+   * pages is the stack of ancestors of the leaf that may change: the parent of each page precedes it.
+   */
+  struct WriteSet {
+    bool root_latched{false};
+    std::vector<Page *> pages;
+    std::vector<page_id_t> deleted_pages;
+  };
+
+  /** One level of a bulk load, its entries are spread evenly over a fixed number of pages */
+  struct LoadLevel {
+    int max_size;
+    int pages;
+    int count;
+    int page_index{0};  // index of the page being filled
+    Page *page{nullptr};
+    page_id_t page_id{INVALID_PAGE_ID};
+
+    int PageSize(int index) const { return count / pages + (index < count % pages ? 1 : 0); }
+  };
+
+  /** @return the pages a level of count entries needs to be filled to fill_factor and not underflow */
+  static int BulkLoadPages(int count, int max_size, double fill_factor);
+
+  /** Append a child to the internal level, the page is finished when full */
+  void BulkLoadAppend(std::vector<LoadLevel> *levels, size_t level, const GenericKey *key, page_id_t child,
+                           std::vector<page_id_t> *new_pages);
+
+  /** Set the fences and next page of the full leaf being filled, then finish it. high is nullptr for the last leaf */
+  void BulkLoadFinishLeaf(std::vector<LoadLevel> *levels, const GenericKey *high, page_id_t next_page_id,
+                          GenericKey *buffer, std::vector<page_id_t> *new_pages);
+
+  /**
+   * Append the full page of a level to its parent (none for the root), then unpin it.
+   * @param first_key the smallest key of the page, read from the page if it is internal
+   */
+  void BulkLoadFinishPage(std::vector<LoadLevel> *levels, size_t level, std::vector<page_id_t> *new_pages,
+                          const GenericKey *first_key = nullptr);
+
+  /** Optimistic descent, @return the leaf pinned and write latched, nullptr if the tree is empty */
+  Page *FindLeafPageOptimistic(const GenericKey *key);
+
+  bool GetValueOptimistic(const GenericKey *key, std::vector<RowId> &result);
+
+  /**
+   * One latch free descent of optimistic lock coupling, each page is validated against its parent (the root
+   * against root_version_) after it is pinned.
+   * @param latch_leaf   write latch the leaf before validating it, otherwise only its version is returned
+   * @return false if the traversal has to restart, leaf_page is set to nullptr for an empty tree
+   */
+  bool DescendOptimistic(const GenericKey *key, bool latch_leaf, Page **leaf_page, uint64_t *leaf_version);
+
+  void LockRoot();
+
+  void UnlockRoot();
+
+  /** Fetch a page at depth (the root is 0) for a lookup, the internal pages of the top levels are resident */
+  Page *FetchNode(page_id_t page_id, int depth);
+
+  /** Unpin a page fetched by FetchNode unless it is resident */
+  void UnpinNode(Page *page, int depth);
+
+  /** Unpin the page if it is resident, before it is deleted */
+  void DropResident(page_id_t page_id);
+
+  void ReleaseResident();
+
+  /** Delete merged away pages, deferred while optimistic traversals may still read them */
+  void FreePages(const std::vector<page_id_t> &page_ids);
+
+  void ReclaimPages();
+
+  /** Pessimistic descent with the root id latch held, @return the leaf, the last page of write_set */
+  Page *FindLeafPagePessimistic(const GenericKey *key, Operation op, WriteSet *write_set);
+
+  /** @return whether op on node cannot change its parent (no split or underflow) */
+  bool IsSafe(BPlusTreePage *node, Operation op) const;
+
+  /** Whether node is the root, the caller holds a latch on node so that the root can't move away from it */
+  bool IsRoot(const BPlusTreePage *node) const { return node->GetPageId() == root_page_id_; }
+
+  /** @return the min size of node, the root may hold a single entry (leaf) or two children (internal page) */
+  int MinSize(const BPlusTreePage *node) const;
+
+  /** @return the parent of node, the page before it in the write set */
+  InternalPage *ParentOf(const BPlusTreePage *node, WriteSet *write_set) const;
+
+  /** Release everything above the last page of the write set */
+  void ReleaseAncestors(WriteSet *write_set);
+
+  void Release(WriteSet *write_set);
+
   void StartNewTree(GenericKey *key, const RowId &value);
 
-  bool InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+  /** @param append whether new_node was split off the rightmost page by an append, see Split */
+  void InsertIntoParent(BPlusTreePage *old_node, const GenericKey *key, BPlusTreePage *new_node, WriteSet *write_set,
+                        bool append = false);
 
-  void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
-                        Transaction *transaction = nullptr);
+  /**
+   * Split an overflowing page in half. If append, the entry just inserted is the last one of the rightmost page
+   * of its level: as keys keep ascending the left page would never be filled again, so it keeps
+   * INDEX_APPEND_SPLIT_RATIO of the entries instead.
+   */
+  LeafPage *Split(LeafPage *node, bool append = false);
 
-  LeafPage *Split(LeafPage *node, Transaction *transaction);
+  InternalPage *Split(InternalPage *node, bool append = false);
 
-  InternalPage *Split(InternalPage *node, Transaction *transaction);
+  /** @return the entries moved to the new page when the rightmost page of size entries splits on an append */
+  static int AppendSplitCount(int size, int min_count);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *&node, Transaction *transaction = nullptr);
+  void CoalesceOrRedistribute(N *node, WriteSet *write_set);
+
+  void Coalesce(LeafPage *left, LeafPage *right, InternalPage *parent, int right_index, WriteSet *write_set);
+
+  void Coalesce(InternalPage *left, InternalPage *right, InternalPage *parent, int right_index,
+                WriteSet *write_set);
 
-  bool Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                Transaction *transaction = nullptr);
+  bool CanCoalesce(LeafPage *left, LeafPage *right) const;
 
-  bool Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                Transaction *transaction = nullptr);
+  bool CanCoalesce(InternalPage *left, InternalPage *right) const;
 
-  void Redistribute(LeafPage *neighbor_node, LeafPage *node, int index);
+  void Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index);
 
-  void Redistribute(InternalPage *neighbor_node, InternalPage *node, int index);
+  void Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index);
 
-  bool AdjustRoot(BPlusTreePage *node);
+  void AdjustRoot(BPlusTreePage *node, WriteSet *write_set);
 
   void UpdateRootPageId(int insert_record = 0);
 
@@ -103,7 +259,17 @@ class BPlusTree {
 
   // member variable
   index_id_t index_id_;
-  page_id_t root_page_id_{INVALID_PAGE_ID};
+  std::atomic<page_id_t> root_page_id_{INVALID_PAGE_ID};
+  ReaderWriterLatch root_latch_;            // 保护root_page_id_
+  std::atomic<uint64_t> root_version_{0};  // 持有root_latch_写锁时为奇数
+  LookupMode lookup_mode_{LookupMode::kOptimistic};
+  std::atomic<int> optimistic_count_{0};  // 进行中的乐观遍历
+  std::mutex reclaim_latch_;
+  std::vector<page_id_t> reclaim_pages_;
+  std::atomic<size_t> reclaim_count_{0};
+  int resident_levels_{0};
+  std::shared_mutex resident_latch_;                       // 保护resident_pages_
+  std::unordered_map<page_id_t, Page *> resident_pages_;  // 常驻的页各持有一次pin
   BufferPoolManager *buffer_pool_manager_;
   KeyManager processor_;
   int leaf_max_size_;
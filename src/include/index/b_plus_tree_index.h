@@ -5,16 +5,27 @@
 #include "index/generic_key.h"
 #include "index/index.h"
 
+/**
+ * B+ tree index. The tree only holds unique keys, so a non-unique index appends the RowId to the key
+ * (see KeyManager) and answers a lookup with a range scan over all RowIds of the key.
+ */
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  /** @param include_count the last include_count columns of key_schema are stored in the leaves but not compared */
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true, uint32_t include_count = 0);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
+  dberr_t InsertEntryIfAbsent(const Row &key, RowId row_id, Transaction *txn) override;
+
   dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
 
+  /** Scan the heap into an external sort and build the tree bottom up, a unique index fails on duplicate keys */
+  dberr_t BulkLoad(TableHeap *table_heap, const std::vector<uint32_t> &key_map, Transaction *txn) override;
+
   dberr_t Destroy() override;
 
   IndexIterator GetBeginIterator();
@@ -23,7 +34,27 @@ class BPlusTreeIndex : public Index {
 
   IndexIterator GetEndIterator();
 
+  /**
+   * @return an iterator over the entries whose key columns lie between low and high, streaming them from the leaves
+   * @param low the lower bound key row, nullptr for no lower bound
+   * @param high the upper bound key row, nullptr for no upper bound
+   * A bound may hold only the leading key columns, it then compares with the same number of leading columns of a key,
+   * e.g. on (a, b) the bounds (3) and (3) inclusive return every entry with a = 3.
+   */
+  IndexIterator GetRangeIterator(const Row *low, bool low_inclusive, const Row *high, bool high_inclusive);
+
+  /**
+   * Decode the key columns and INCLUDE columns of an entry into row, in key schema order.
+   * @return false if a char value is longer than its column, the key then holds only its prefix. TableHeap rejects
+   * such values, so only entries inserted directly into the index can be incomplete.
+   */
+  bool DecodeKey(const GenericKey *key, Row *row) const { return processor_.DeserializeToKey(key, *row, key_schema_); }
+
+  /** Keep the top levels of a hot index resident, see BPlusTree::SetResidentLevels */
+  void SetResidentLevels(int levels) { container_.SetResidentLevels(levels); }
+
  protected:
+  bool unique_;
   // comparator for key
   KeyManager processor_;
   // container
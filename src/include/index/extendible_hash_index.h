@@ -0,0 +1,40 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_INDEX_H
+#define MINISQL_EXTENDIBLE_HASH_INDEX_H
+
+#include "index/extendible_hash_table.h"
+#include "index/generic_key.h"
+#include "index/index.h"
+
+/**
+ * Extendible hash index, created with `USING hash`. It answers only equality lookups on all key columns, reading
+ * the directory and one bucket page instead of descending a tree. Like BPlusTreeIndex a non-unique index appends
+ * the RowId to the key.
+ */
+class ExtendibleHashIndex : public Index {
+ public:
+  ExtendibleHashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                      BufferPoolManager *buffer_pool_manager, bool unique = true, uint32_t include_count = 0);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t InsertEntryIfAbsent(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  /** Only "=" is supported, other operators return DB_FAILED */
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
+
+  /** Insert the entry of every row, a unique index fails on duplicate keys */
+  dberr_t BulkLoad(TableHeap *table_heap, const std::vector<uint32_t> &key_map, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+  bool Check() { return container_.Check(); }
+
+ protected:
+  bool unique_;
+  KeyManager processor_;
+  ExtendibleHashTable container_;
+};
+
+#endif  // MINISQL_EXTENDIBLE_HASH_INDEX_H
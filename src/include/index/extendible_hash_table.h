@@ -0,0 +1,90 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_TABLE_H
+#define MINISQL_EXTENDIBLE_HASH_TABLE_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rwlatch.h"
+#include "index/generic_key.h"
+#include "page/hash_table_bucket_page.h"
+#include "page/hash_table_directory_page.h"
+#include "transaction/transaction.h"
+
+/**
+ * Disk based extendible hash table mapping keys to RowIds, the container of ExtendibleHashIndex.
+ * The directory page (its id is kept in the index roots page) maps the low global depth bits of a key hash to
+ * a bucket page. A full bucket is split on the next bit of its local depth, doubling the directory when the
+ * local depth reaches the global depth; at HASH_DIRECTORY_MAX_DEPTH the bucket grows a chain of overflow pages
+ * instead. A bucket emptied by a removal is merged back into its split image and the directory shrinks when
+ * no bucket needs its highest bit. A lookup reads the directory and one bucket page.
+ * Like BPlusTree only unique keys are stored, keys of a non-unique index carry the RowId suffix and are hashed
+ * without it.
+ * Concurrency: lookups, inserts into a bucket with room and removals take table_latch_ shared and latch the
+ * bucket page (which covers its overflow chain); splits, merges and overflow pages take table_latch_ exclusive.
+ */
+class ExtendibleHashTable {
+ public:
+  explicit ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &KM);
+
+  /** Insert a key-value pair, @return false if the key is present */
+  bool Insert(const GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+
+  /** Remove the entry of key if it maps to value, @return false if there is no such entry */
+  bool Remove(const GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+
+  /** Append the values of all entries whose key columns equal those of key */
+  bool GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction = nullptr);
+
+  bool IsEmpty() const { return directory_page_id_ == INVALID_PAGE_ID; }
+
+  /** Delete all pages of the table */
+  void Destroy();
+
+  uint32_t GetGlobalDepth();
+
+  /** Verify the directory and that every entry lies in the bucket its hash selects */
+  bool Check();
+
+ private:
+  enum class InsertResult { kInserted, kDuplicate, kFull };
+
+  HashTableDirectoryPage *FetchDirectory();
+
+  HashTableBucketPage *AsBucket(Page *page) { return reinterpret_cast<HashTableBucketPage *>(page->GetData()); }
+
+  uint32_t KeyToIndex(const GenericKey *key, HashTableDirectoryPage *directory) const {
+    return static_cast<uint32_t>(processor_.HashColumns(key)) & directory->GetGlobalDepthMask();
+  }
+
+  /** @return the page ids of a bucket chain, the pinned primary page first */
+  std::vector<page_id_t> ChainPageIds(Page *primary);
+
+  /**
+   * Insert into the chain of the pinned and latched primary page.
+   * @param overflow whether a new overflow page may be appended when every page of the chain is full
+   */
+  InsertResult InsertIntoChain(Page *primary, const GenericKey *key, const RowId &value, bool overflow);
+
+  /** Append to the first page of the chain with room, or to a new overflow page */
+  bool AppendToChain(Page *primary, const GenericKey *key, const RowId &value, bool overflow);
+
+  /** Insert with table_latch_ held exclusively, splitting the bucket until the key fits */
+  bool SplitInsert(const GenericKey *key, const RowId &value);
+
+  /** Split the bucket of slot bucket_idx on the next bit of its local depth */
+  void SplitBucket(HashTableDirectoryPage *directory, uint32_t bucket_idx);
+
+  /** Merge the bucket of key into its split image if it is empty, then shrink the directory */
+  void Merge(const GenericKey *key);
+
+  void DeleteChain(page_id_t page_id);
+
+  index_id_t index_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyManager processor_;
+  uint32_t key_size_;
+  page_id_t directory_page_id_;
+  ReaderWriterLatch table_latch_;
+};
+
+#endif  // MINISQL_EXTENDIBLE_HASH_TABLE_H
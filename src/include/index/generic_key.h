@@ -1,8 +1,10 @@
 #ifndef MINISQL_GENERIC_KEY_H
 #define MINISQL_GENERIC_KEY_H
 
+#include <algorithm>
 #include <cstring>
 
+#include "common/hash_util.h"
 #include "record/field.h"
 #include "record/row.h"
 
@@ -11,6 +13,21 @@ class GenericKey {
   char data[0];
 };
 
+/**
+ * KeyManager encodes index keys so that comparing two keys is a single memcmp. Every column is written as
+ *  | NotNull (1) | Value |
+ * where nulls (marker 0, value bytes all 0) sort before every value and the value is:
+ *  - int: big-endian with the sign bit flipped,
+ *  - float: big-endian bits, the sign bit flipped for positive values and all bits flipped for negative ones,
+ *    -0.0 is written as 0.0 since the two compare equal,
+ *  - char(n): the bytes zero padded to n, followed by the big-endian length so that a prefix sorts first.
+ * The encoded size depends only on the key schema, unused bytes of the key are zero.
+ * Keys of a non-unique index are made unique by a RowId suffix after the columns:
+ *  | PageId (4, big-endian, sign bit flipped) | SlotNum (4, big-endian) |
+ * so the entries of one column value are adjacent and ordered by RowId.
+ * The last include_count columns of the schema are payload (CREATE INDEX ... INCLUDE): they are encoded the same way
+ * after the suffix but never compared, so they neither order the keys nor make them unique.
+ */
 class KeyManager {
  public: /**/
   [[nodiscard]] inline GenericKey *InitKey() const {
@@ -18,57 +35,219 @@ class KeyManager {
   }
 
   inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
     ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    ASSERT(GetEncodedSize(schema) + (row_id_suffix_ ? SUFFIX_SIZE : 0) <= (uint32_t)key_size_,
+           "Index key size exceed max key size.");
+    // initialize to 0
     memset(key_buf->data, 0, key_size_);
-    key.SerializeTo(key_buf->data, schema);
+    EncodeColumns(key_buf, key, schema, 0, key_count_, 0);
+    EncodeColumns(key_buf, key, schema, key_count_, schema->GetColumnCount(), encoded_size_);
   }
 
-  inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
-    ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
+  /**
+   * Encode a lookup key from the key columns of key, INCLUDE columns are left out (and may be left out of key), so
+   * the key compares equal to every stored key with these columns.
+   */
+  inline void SerializeKeyColumns(GenericKey *key_buf, const Row &key, Schema *schema) const {
+    ASSERT(key.GetFieldCount() >= key_count_, "field nums not match.");
+    memset(key_buf->data, 0, key_size_);
+    EncodeColumns(key_buf, key, schema, 0, key_count_, 0);
   }
 
-  // compare
-  [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
-    //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
-    uint32_t column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    DeserializeToKey(lhs, lhs_key, key_schema_);
-    DeserializeToKey(rhs, rhs_key, key_schema_);
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
-        return -1;
-      }
+  /**
+   * Encode a bound from the leading key columns: the fields of prefix are encoded as the first columns and the
+   * remaining columns and RowId suffix are filled with the lowest (highest if upper) bytes, so the key sorts before
+   * (after) every key that starts with these columns.
+   */
+  inline void SerializeBound(GenericKey *key_buf, const Row &prefix, Schema *schema, bool upper) const {
+    ASSERT(prefix.GetFieldCount() <= key_count_, "field nums not match.");
+    memset(key_buf->data, 0, key_size_);
+    uint32_t size = EncodeColumns(key_buf, prefix, schema, 0, prefix.GetFieldCount(), 0);
+    memset(key_buf->data + size, upper ? 0xff : 0, encoded_size_ - size);
+  }
 
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
-        return 1;
+  /**
+   * Decode all columns of a key, including the payload columns.
+   * @return false if a char value was longer than its column and only its prefix could be decoded
+   */
+  inline bool DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
+    auto &fields = key.GetFields();
+    auto buf = reinterpret_cast<const uint8_t *>(key_buf->data);
+    bool complete = true;
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+      if (i == key_count_) {
+        buf = reinterpret_cast<const uint8_t *>(key_buf->data) + encoded_size_;
+      }
+      const Column *column = schema->GetColumn(i);
+      fields.push_back(*buf == 0 ? new Field(column->GetType())
+                                 : DecodeField(column->GetType(), column->GetLength(), buf + 1));
+      if (*buf != 0 && column->GetType() == TypeId::kTypeChar &&
+          ReadBigEndian(buf + 1 + column->GetLength()) > column->GetLength()) {
+        complete = false;
       }
+      buf += GetEncodedSize(column);
     }
-    // equals
-    return 0;
+    return complete;
+  }
+
+  // compare
+  [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
+    return memcmp(lhs->data, rhs->data, encoded_size_);
   }
 
+  /**
+   * Compare a key stored without its first prefix_size bytes with key, whose first prefix_size bytes are known to be
+   * the same (prefix compressed leaves).
+   */
+  [[nodiscard]] inline int CompareSuffix(const char *suffix, const GenericKey *key, uint32_t prefix_size) const {
+    ASSERT(prefix_size < encoded_size_, "Prefix covers the whole key.");
+    return memcmp(suffix, key->data + prefix_size, encoded_size_ - prefix_size);
+  }
+
+  /** Compare only the columns, ignoring the RowId suffix of a non-unique key */
+  [[nodiscard]] inline int CompareColumns(const GenericKey *lhs, const GenericKey *rhs) const {
+    return memcmp(lhs->data, rhs->data, encoded_size_ - (row_id_suffix_ ? SUFFIX_SIZE : 0));
+  }
+
+  /** Hash the columns of a key, equal columns hash equally whatever the RowId suffix and payload */
+  [[nodiscard]] inline uint64_t HashColumns(const GenericKey *key) const {
+    return HashBytes(key->data, encoded_size_ - (row_id_suffix_ ? SUFFIX_SIZE : 0));
+  }
+
+  /** Write the RowId suffix of a non-unique key */
+  inline void SetRowId(GenericKey *key_buf, const RowId &row_id) const {
+    ASSERT(row_id_suffix_, "Key has no RowId suffix.");
+    auto buf = reinterpret_cast<uint8_t *>(key_buf->data) + encoded_size_ - SUFFIX_SIZE;
+    WriteBigEndian(static_cast<uint32_t>(row_id.GetPageId()) ^ 0x80000000u, buf);
+    WriteBigEndian(row_id.GetSlotNum(), buf + sizeof(uint32_t));
+  }
+
+  inline bool HasRowIdSuffix() const { return row_id_suffix_; }
+
+  /** @return the number of leading columns that order the keys, the rest are payload */
+  inline uint32_t GetKeyColumnCount() const { return key_count_; }
+
   inline int GetKeySize() const { return key_size_; }
 
+  /** @return the encoded size of the keys of a schema */
+  static uint32_t GetEncodedSize(const Schema *schema) {
+    uint32_t size = 0;
+    for (auto column : schema->GetColumns()) {
+      size += GetEncodedSize(column);
+    }
+    return size;
+  }
+
   KeyManager(const KeyManager &other) {
     this->key_schema_ = other.key_schema_;
     this->key_size_ = other.key_size_;
+    this->encoded_size_ = other.encoded_size_;
+    this->row_id_suffix_ = other.row_id_suffix_;
+    this->key_count_ = other.key_count_;
+  }
+
+  // constructor, row_id_suffix for the keys of a non-unique index, include_count trailing payload columns
+  KeyManager(Schema *key_schema, size_t key_size, bool row_id_suffix = false, uint32_t include_count = 0)
+      : key_size_(key_size),
+        key_schema_(key_schema),
+        key_count_(key_schema->GetColumnCount() - include_count),
+        row_id_suffix_(row_id_suffix) {
+    encoded_size_ = row_id_suffix ? SUFFIX_SIZE : 0;
+    for (uint32_t i = 0; i < key_count_; i++) {
+      encoded_size_ += GetEncodedSize(key_schema->GetColumn(i));
+    }
   }
 
-  // constructor
-  KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
+  static constexpr uint32_t SUFFIX_SIZE = 8;
 
  private:
+  static uint32_t GetEncodedSize(const Column *column) {
+    return 1 + (column->GetType() == TypeId::kTypeChar ? column->GetLength() + sizeof(uint32_t) : sizeof(uint32_t));
+  }
+
+  /** Encode the columns [begin, end) starting at byte offset, @return the offset after them */
+  static uint32_t EncodeColumns(GenericKey *key_buf, const Row &key, Schema *schema, uint32_t begin, uint32_t end,
+                                uint32_t offset) {
+    auto buf = reinterpret_cast<uint8_t *>(key_buf->data);
+    uint32_t size = offset;
+    for (uint32_t i = begin; i < end; i++) {
+      const Column *column = schema->GetColumn(i);
+      const Field *field = key.GetField(i);
+      buf[size] = field->IsNull() ? 0 : 1;
+      if (!field->IsNull()) {
+        EncodeField(*field, column->GetLength(), buf + size + 1);
+      }
+      size += GetEncodedSize(column);
+    }
+    return size;
+  }
+
+  static void WriteBigEndian(uint32_t value, uint8_t *buf) {
+    buf[0] = value >> 24;
+    buf[1] = value >> 16;
+    buf[2] = value >> 8;
+    buf[3] = value;
+  }
+
+  static uint32_t ReadBigEndian(const uint8_t *buf) {
+    return (uint32_t(buf[0]) << 24) | (uint32_t(buf[1]) << 16) | (uint32_t(buf[2]) << 8) | uint32_t(buf[3]);
+  }
+
+  static void EncodeField(const Field &field, uint32_t column_length, uint8_t *buf) {
+    switch (field.GetTypeId()) {
+      case TypeId::kTypeInt: {
+        int32_t value;
+        field.SerializeTo(reinterpret_cast<char *>(&value));
+        WriteBigEndian(static_cast<uint32_t>(value) ^ 0x80000000u, buf);
+        break;
+      }
+      case TypeId::kTypeFloat: {
+        uint32_t bits;
+        field.SerializeTo(reinterpret_cast<char *>(&bits));
+        if (bits == 0x80000000u) {
+          bits = 0;  // -0.0
+        }
+        WriteBigEndian((bits & 0x80000000u) ? ~bits : bits | 0x80000000u, buf);
+        break;
+      }
+      case TypeId::kTypeChar: {
+        // 表中的值不超过列宽(TableHeap拒绝更长的值)，只有扫描边界会超长，它只保留前column_length字节
+        uint32_t len = field.GetLength();
+        memcpy(buf, field.GetData(), std::min(len, column_length));
+        WriteBigEndian(len, buf + column_length);
+        break;
+      }
+      default:
+        ASSERT(false, "Unsupported key type.");
+    }
+  }
+
+  static Field *DecodeField(TypeId type, uint32_t column_length, const uint8_t *buf) {
+    switch (type) {
+      case TypeId::kTypeInt:
+        return new Field(type, static_cast<int32_t>(ReadBigEndian(buf) ^ 0x80000000u));
+      case TypeId::kTypeFloat: {
+        uint32_t bits = ReadBigEndian(buf);
+        bits = (bits & 0x80000000u) ? bits & ~0x80000000u : ~bits;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return new Field(type, value);
+      }
+      case TypeId::kTypeChar: {
+        uint32_t len = std::min(ReadBigEndian(buf + column_length), column_length);
+        return new Field(type, reinterpret_cast<char *>(const_cast<uint8_t *>(buf)), len, true);
+      }
+      default:
+        ASSERT(false, "Unsupported key type.");
+        return nullptr;
+    }
+  }
+
   int key_size_;
   Schema *key_schema_;
+  uint32_t key_count_;     // 参与比较的列数，之后的列是payload
+  uint32_t encoded_size_;  // 同一schema的键编码长度固定，只比较这部分，包括RowId后缀
+  bool row_id_suffix_{false};
 };
 
 #endif  // MINISQL_GENERIC_KEY_H
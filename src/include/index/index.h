@@ -7,6 +7,8 @@
 #include "record/row.h"
 #include "transaction/transaction.h"
 
+class TableHeap;
+
 class Index {
  public:
   explicit Index(index_id_t index_id, IndexSchema *key_schema) : index_id_(index_id), key_schema_(key_schema) {}
@@ -15,11 +17,24 @@ class Index {
 
   virtual dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) = 0;
 
+  /**
+   * Insert an entry unless a unique index already holds the key, the duplicate check and the insert share one
+   * lookup. An entry of a non-unique index is always absent.
+   * @return DB_ALREADY_EXIST if the key is present, nothing is inserted then
+   */
+  virtual dberr_t InsertEntryIfAbsent(const Row &key, RowId row_id, Transaction *txn) = 0;
+
   virtual dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) = 0;
 
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
                           string compare_operator = "=") = 0;
 
+  /**
+   * Add the entries of all rows of a table to the empty index, used when an index is created on a populated table.
+   * @param key_map the row column of every key column
+   */
+  virtual dberr_t BulkLoad(TableHeap *table_heap, const std::vector<uint32_t> &key_map, Transaction *txn) = 0;
+
   virtual dberr_t Destroy() = 0;
 
  protected:
@@ -3,18 +3,43 @@
 
 #include "page/b_plus_tree_leaf_page.h"
 
+class BPlusTree;
+
+/**
+ * IndexIterator streams the entries of a B+ tree in key order between an optional low and high bound,
+ * each inclusive or exclusive; the default constructed iterator is the end.
+ * Between two steps the current leaf stays pinned but not latched, the current entry is copied out. A step read
+ * latches the leaf and continues at the next slot if the leaf version is unchanged, otherwise (the leaf was split,
+ * merged or modified) it looks up the first key after the current one again. The right sibling is latched only
+ * after the leaf is released and checked against the leaf version in the same way, so a scan never holds two
+ * latches and cannot deadlock with a merge. Like an optimistic lookup a live iterator defers the deletion of
+ * merged pages, which keeps the pages it may still fetch valid.
+ */
 class IndexIterator {
   using LeafPage = BPlusTreeLeafPage;
 
  public:
-  // you may define your own constructor based on your member variables
-  explicit IndexIterator();
+  explicit IndexIterator() = default;
+
+  /**
+   * Position the iterator on the first entry within the bounds.
+   * @param low lower bound, nullptr starts from the first entry
+   * @param high upper bound, nullptr runs to the last entry
+   */
+  explicit IndexIterator(BPlusTree *tree, const GenericKey *low, bool low_inclusive, const GenericKey *high,
+                         bool high_inclusive);
 
-  explicit IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index = 0);
+  IndexIterator(const IndexIterator &other) = delete;
+
+  IndexIterator(IndexIterator &&other) noexcept;
 
   ~IndexIterator();
 
-  /** Return the key/value pair this iterator is currently pointing at. */
+  IndexIterator &operator=(const IndexIterator &other) = delete;
+
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+
+  /** Return the key/value pair this iterator is currently pointing at, the key is owned by the iterator. */
   std::pair<GenericKey *, RowId> operator*();
 
   /** Move to the next key/value pair.*/
@@ -27,11 +52,25 @@ class IndexIterator {
   bool operator!=(const IndexIterator &itr) const;
 
  private:
-  page_id_t current_page_id{INVALID_PAGE_ID};
-  LeafPage *page{nullptr};
-  int item_index{0};
-  BufferPoolManager *buffer_pool_manager{nullptr};
-  // add your own private member variables here
+  /** Descend to the resume position: the first key after key_ (or at it if key_inclusive_), leaf read latched */
+  void Locate();
+
+  /** Starting at slot index_ of the read latched page_, move to the next entry within the bounds and copy it */
+  void Settle();
+
+  /** Unpin the leaf and turn this into the end iterator */
+  void Release();
+
+  BPlusTree *tree_{nullptr};
+  Page *page_{nullptr};  // 当前叶子，保持pin但不加锁
+  uint64_t version_{0};  // 读取当前entry时叶子的版本
+  int index_{0};
+  GenericKey *key_{nullptr};  // 当前entry的key，未返回entry前是low
+  bool has_key_{false};
+  bool key_inclusive_{false};  // Locate是否包括key_本身
+  RowId value_;
+  GenericKey *high_{nullptr};
+  bool high_inclusive_{false};
 };
 
 #endif  // MINISQL_INDEX_ITERATOR_H
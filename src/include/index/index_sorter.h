@@ -0,0 +1,88 @@
+#ifndef MINISQL_INDEX_SORTER_H
+#define MINISQL_INDEX_SORTER_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+/**
+ * IndexSorter sorts the (key, row id) entries of an index build by key, then row id.
+ * Entries are buffered in memory up to a budget, each full buffer is sorted and spilled as a run to a chain of
+ * pages of the buffer pool:
+ *  ------------------------------------------------------------------
+ *  | NextPageId (4) | EntryCount (4) | Key_0 | RowId_0 | Key_1 | ... |
+ *  ------------------------------------------------------------------
+ * Finish sorts the last buffer, Next then merges the runs and the last buffer in one pass.
+ * Run pages are deleted as soon as the merge has read them.
+ */
+class IndexSorter {
+ public:
+  explicit IndexSorter(BufferPoolManager *buffer_pool_manager, const KeyManager &key_manager,
+                       size_t memory_size = INDEX_SORT_BUFFER_SIZE);
+
+  ~IndexSorter();
+
+  void Add(const GenericKey *key, const RowId &value);
+
+  /** Sort the buffered entries, no entry may be added afterwards */
+  void Finish();
+
+  /** @return the number of entries added */
+  size_t GetSize() const { return size_; }
+
+  /** @return the number of runs spilled to pages */
+  size_t GetRunCount() const { return runs_.size(); }
+
+  /**
+   * Copy the next entry in sorted order to key and value.
+   * @return false when all entries have been returned
+   */
+  bool Next(GenericKey *key, RowId *value);
+
+ private:
+  /** Read position in a run, the page of a spilled run stays pinned while it is read */
+  struct Cursor {
+    page_id_t page_id{INVALID_PAGE_ID};  // INVALID_PAGE_ID for the in-memory buffer
+    Page *page{nullptr};
+    const char *data{nullptr};
+    uint32_t pos{0};
+    uint32_t count{0};
+  };
+
+  /** Sort buffer_ into sorted_ */
+  void SortBuffer();
+
+  void SpillRun();
+
+  /** Move the cursor to its next entry, @return false if the run is exhausted */
+  bool Advance(Cursor *cursor);
+
+  const char *EntryAt(const Cursor &cursor) const { return cursor.data + cursor.pos * entry_size_; }
+
+  /** @return whether entry a sorts before entry b */
+  bool Less(const char *a, const char *b) const;
+
+  /** Heap order of the merge, the cursor with the smallest entry on top */
+  bool Greater(uint32_t a, uint32_t b) const { return Less(EntryAt(cursors_[b]), EntryAt(cursors_[a])); }
+
+  static constexpr uint32_t OFFSET_NEXT_PAGE_ID = 0;
+  static constexpr uint32_t OFFSET_ENTRY_COUNT = 4;
+  static constexpr uint32_t SIZE_HEADER = 8;
+
+  BufferPoolManager *buffer_pool_manager_;
+  const KeyManager &key_manager_;
+  uint32_t key_size_;
+  uint32_t entry_size_;     // key_size_ + sizeof(RowId)
+  size_t buffer_capacity_;  // entries sorted in memory at once
+  std::vector<char> buffer_;
+  std::vector<char> sorted_;
+  std::vector<page_id_t> runs_;  // first pages of the spilled runs
+  std::vector<Cursor> cursors_;
+  std::vector<uint32_t> heap_;  // cursors that still have entries
+  size_t size_{0};
+  bool finished_{false};
+};
+
+#endif  // MINISQL_INDEX_SORTER_H
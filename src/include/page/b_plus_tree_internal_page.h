@@ -8,7 +8,7 @@
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define INTERNAL_PAGE_HEADER_SIZE 28
+#define INTERNAL_PAGE_HEADER_SIZE 24
 #define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(std::pair<GenericKey *, page_id_t>)) - 1)
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
@@ -26,12 +26,11 @@
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int key_size = UNDEFINED_SIZE,
-            int max_size = UNDEFINED_SIZE);
+  void Init(page_id_t page_id, int key_size = UNDEFINED_SIZE, int max_size = UNDEFINED_SIZE);
 
   GenericKey *KeyAt(int index);
 
-  void SetKeyAt(int index, GenericKey *key);
+  void SetKeyAt(int index, const GenericKey *key);
 
   int ValueIndex(const page_id_t &value) const;
 
@@ -45,31 +44,32 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   page_id_t Lookup(const GenericKey *key, const KeyManager &KP);
 
-  void PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
+  void PopulateNewRoot(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value);
 
-  int InsertNodeAfter(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value);
+  int InsertNodeAfter(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value);
 
   void Remove(int index);
 
   page_id_t RemoveAndReturnOnlyChild();
 
-  // Split and Merge utility methods
-  void MoveAllTo(BPlusTreeInternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager);
+  // Split and Merge utility methods, the moved children are not fetched
+  void MoveAllTo(BPlusTreeInternalPage *recipient, GenericKey *middle_key);
 
-  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  void MoveHalfTo(BPlusTreeInternalPage *recipient);
 
-  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
-                        BufferPoolManager *buffer_pool_manager);
+  /** Move the last count children to recipient, the right sibling */
+  void MoveTailTo(BPlusTreeInternalPage *recipient, int count);
 
-  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key,
-                         BufferPoolManager *buffer_pool_manager);
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key);
+
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, GenericKey *middle_key);
 
  private:
-  void CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager);
+  void CopyNFrom(void *src, int size);
 
-  void CopyLastFrom(GenericKey *key, page_id_t value, BufferPoolManager *buffer_pool_manager);
+  void CopyLastFrom(GenericKey *key, page_id_t value);
 
-  void CopyFirstFrom(page_id_t value, BufferPoolManager *buffer_pool_manager);
+  void CopyFirstFrom(GenericKey *key, page_id_t value);
 
   char data_[PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
 };
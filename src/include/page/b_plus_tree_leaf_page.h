@@ -6,20 +6,28 @@
  *
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
-
+ * page. Keys are unique, a non-unique index appends the RowId to its keys.
+ *
+ * Every leaf covers the key range [LowFence, HighFence) given by the separators of its parent, so all keys that
+ * can ever be in the page start with the common prefix of the two fences. The prefix is kept once, in the low
+ * fence, and only the remaining bytes of every key are stored. Keys and values are kept in separate arrays, so a
+ * binary search only touches the key suffixes. A fence is infinite at the ends of the tree, the prefix is then
+ * empty. The prefix changes only when the fences do (split, merge and redistribution); the number of entries that
+ * fit, and so the max size, follows from its length.
+ *
  * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ *  ----------------------------------------------------------------------------------------------
+ * | HEADER | LowFence | HighFence | SUFFIX(1) | ... | SUFFIX(n) | free | RID(1) | ... | RID(n) | free |
+ *  ----------------------------------------------------------------------------------------------
+ * The RowId array starts after Capacity suffixes.
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 36 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | PageType (4) | KeySize (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  -----------------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | PrefixSize (2) | FenceFlags (2) | SizeLimit (4) |
+ *  -----------------------------------------------------------------------------
  */
 #include <utility>
 #include <vector>
@@ -27,47 +35,74 @@
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define LEAF_PAGE_HEADER_SIZE 32
-#define LEAF_PAGE_SIZE (((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType)) - 1)
+#define LEAF_PAGE_HEADER_SIZE 36
 
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int key_size = UNDEFINED_SIZE,
-            int max_size = UNDEFINED_SIZE);
+  /**
+   * Both fences are infinite after Init.
+   * @param max_size an upper bound of the max size, UNDEFINED_SIZE to hold as many entries as fit
+   */
+  void Init(page_id_t page_id, int key_size = UNDEFINED_SIZE, int max_size = UNDEFINED_SIZE);
+
+  /** @return the max size of a leaf whose keys share prefix_size bytes, one entry fewer than fit */
+  static int MaxSizeFor(int key_size, int prefix_size);
+
+  /**
+   * @return the min size of a non-root leaf, half of the max size without a prefix. It does not depend on the
+   * fences, so two siblings that do not fit into one page always hold enough entries to refill either of them.
+   */
+  int GetMinSize() const;
 
   // helper methods
   page_id_t GetNextPageId() const;
 
   void SetNextPageId(page_id_t next_page_id);
 
-  GenericKey *KeyAt(int index);
+  int GetPrefixSize() const { return prefix_size_; }
 
-  void SetKeyAt(int index, GenericKey *key);
+  /** @return the inclusive lower bound of the keys of the page, nullptr if infinite */
+  const GenericKey *GetLowFence() const;
 
-  RowId ValueAt(int index) const;
+  /** @return the exclusive upper bound of the keys of the page, nullptr if infinite */
+  const GenericKey *GetHighFence() const;
 
-  void SetValueAt(int index, RowId value);
+  /** Change the key range of the page and compress the entries with the new prefix, they must fit */
+  void SetFences(const GenericKey *low, const GenericKey *high);
+
+  /** @return the max size the page would have with the given fences */
+  int MaxSizeWithFences(const GenericKey *low, const GenericKey *high) const;
 
-  int KeyIndex(const GenericKey *key, const KeyManager &comparator);
+  /** Copy the full key of entry index to key */
+  void CopyKeyAt(int index, GenericKey *key) const;
 
-  void *PairPtrAt(int index);
+  /** Compare the key of entry index with key, which may lie outside the range of the page */
+  int CompareKeyAt(int index, const GenericKey *key, const KeyManager &KM) const;
 
-  void PairCopy(void *dest, void *src, int pair_num = 1);
+  /** Set the key of entry index, the key must start with the prefix of the page */
+  void SetKeyAt(int index, const GenericKey *key);
 
-  std::pair<GenericKey *, RowId> GetItem(int index);
+  RowId ValueAt(int index) const;
+
+  void SetValueAt(int index, RowId value);
+
+  int KeyIndex(const GenericKey *key, const KeyManager &comparator) const;
 
   // insert and delete methods
-  int Insert(GenericKey *key, const RowId &value, const KeyManager &comparator);
+  int Insert(const GenericKey *key, const RowId &value, const KeyManager &comparator);
 
-  bool Lookup(const GenericKey *key, RowId &value, const KeyManager &comparator);
+  bool Lookup(const GenericKey *key, RowId &value, const KeyManager &comparator) const;
 
   int RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &comparator);
 
-  // Split and Merge utility methods
+  // Split and Merge utility methods, the fences of both pages are updated
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
 
+  /** Move the last count entries to recipient, the right sibling */
+  void MoveTailTo(BPlusTreeLeafPage *recipient, int count);
+
   void MoveAllTo(BPlusTreeLeafPage *recipient);
 
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
@@ -75,16 +110,38 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
-  void CopyNFrom(void *src, int size);
+  static constexpr uint16_t LOW_INFINITE = 1;
+  static constexpr uint16_t HIGH_INFINITE = 2;
 
-  void CopyLastFrom(GenericKey *key, const RowId value);
+  int SuffixSize() const { return GetKeySize() - prefix_size_; }
 
-  void CopyFirstFrom(GenericKey *key, const RowId value);
+  /** @return the number of entries that fit with the current prefix */
+  int Capacity() const;
 
-  page_id_t next_page_id_{INVALID_PAGE_ID};
+  char *SuffixAt(int index) { return data_ + 2 * GetKeySize() + index * SuffixSize(); }
+
+  const char *SuffixAt(int index) const { return data_ + 2 * GetKeySize() + index * SuffixSize(); }
+
+  char *ValuePtrAt(int index) { return data_ + 2 * GetKeySize() + Capacity() * SuffixSize() + index * sizeof(RowId); }
 
+  const char *ValuePtrAt(int index) const {
+    return data_ + 2 * GetKeySize() + Capacity() * SuffixSize() + index * sizeof(RowId);
+  }
+
+  /** Append the full (key, RowId) pairs of entries [begin, end) to entries */
+  void ExportEntries(int begin, int end, std::vector<char> *entries) const;
+
+  /** Replace the fences and all entries of the page by count full (key, RowId) pairs */
+  void Rebuild(const char *entries, int count, const GenericKey *low, const GenericKey *high);
+
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  uint16_t prefix_size_;
+  uint16_t fence_flags_;
+  int size_limit_;
   char data_[PAGE_SIZE - LEAF_PAGE_HEADER_SIZE];
 };
 
+static_assert(sizeof(BPlusTreeLeafPage) == PAGE_SIZE, "Leaf page header size mismatch.");
+
 using LeafPage = BPlusTreeLeafPage;
 #endif  // MINISQL_B_PLUS_TREE_LEAF_PAGE_H
@@ -18,19 +18,19 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 28 bytes in total):
+ * Header format (size in byte, 24 bytes in total):
  * ----------------------------------------------------------------------------
  * | PageType (4) | KeySize (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | PageId(4) |
  * ----------------------------------------------------------------------------
+ * Pages don't know their parent, BPlusTree keeps the path of an operation instead. Whether a page is the root
+ * (and so its min size) is decided by the tree as well.
  */
 class BPlusTreePage {
  public:
   bool IsLeafPage() const;
 
-  bool IsRootPage() const;
-
   void SetPageType(IndexPageType page_type);
 
   int GetKeySize() const;
@@ -47,12 +47,9 @@ class BPlusTreePage {
 
   void SetMaxSize(int max_size);
 
+  /** @return the min size of a non-root page */
   int GetMinSize() const;
 
-  page_id_t GetParentPageId() const;
-
-  void SetParentPageId(page_id_t parent_page_id);
-
   page_id_t GetPageId() const;
 
   void SetPageId(page_id_t page_id);
@@ -66,7 +63,6 @@ class BPlusTreePage {
   [[maybe_unused]] lsn_t lsn_;
   [[maybe_unused]] int size_;
   [[maybe_unused]] int max_size_;
-  [[maybe_unused]] page_id_t parent_page_id_;
   [[maybe_unused]] page_id_t page_id_;
 };
 
@@ -0,0 +1,57 @@
+#ifndef MINISQL_HASH_TABLE_BUCKET_PAGE_H
+#define MINISQL_HASH_TABLE_BUCKET_PAGE_H
+
+#include "common/config.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+/**
+ * Bucket page of an extendible hash index, entries are unordered. A bucket whose keys can no longer be told
+ * apart by the directory (all of them share the hash bits of the maximum depth) continues in a chain of
+ * overflow pages of the same format.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------------------------
+ * | Size (4) | NextPageId (4) | Key_0 | RowId_0 | Key_1 | RowId_1 | ... |
+ *  ---------------------------------------------------------------------
+ */
+class HashTableBucketPage {
+ public:
+  void Init() {
+    size_ = 0;
+    next_page_id_ = INVALID_PAGE_ID;
+  }
+
+  /** @return the number of entries of key_size bytes keys that fit in a page */
+  static uint32_t Capacity(uint32_t key_size) { return (PAGE_SIZE - HEADER_SIZE) / (key_size + sizeof(RowId)); }
+
+  uint32_t GetSize() const { return size_; }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  GenericKey *KeyAt(uint32_t index, uint32_t key_size) {
+    return reinterpret_cast<GenericKey *>(data_ + index * (key_size + sizeof(RowId)));
+  }
+
+  RowId ValueAt(uint32_t index, uint32_t key_size) const;
+
+  /** Append an entry, the page must not be full */
+  void Append(const GenericKey *key, const RowId &value, uint32_t key_size);
+
+  /** Overwrite entry index with the last entry and drop the last one */
+  void RemoveAt(uint32_t index, uint32_t key_size);
+
+  /** Move the last entry to the end of recipient */
+  void MoveLastTo(HashTableBucketPage *recipient, uint32_t key_size);
+
+ private:
+  static constexpr uint32_t HEADER_SIZE = 8;
+
+  uint32_t size_;
+  page_id_t next_page_id_;
+  char data_[0];
+};
+
+#endif  // MINISQL_HASH_TABLE_BUCKET_PAGE_H
@@ -0,0 +1,70 @@
+#ifndef MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+#define MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+#define DIRECTORY_ARRAY_SIZE (1 << HASH_DIRECTORY_MAX_DEPTH)
+
+/**
+ * Directory page of an extendible hash index. Slot i holds the bucket of the keys whose hash ends with the
+ * global depth low bits of i, and the local depth of that bucket: a bucket of local depth d is shared by the
+ * 2^(global depth - d) slots that agree on the low d bits.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | GlobalDepth (4) | LocalDepths (DIRECTORY_ARRAY_SIZE) | BucketPageIds |
+ *  ---------------------------------------------------------------------------------------------
+ */
+class HashTableDirectoryPage {
+ public:
+  /** Initialize a directory of global depth 0 whose only slot points at bucket_page_id */
+  void Init(page_id_t page_id, page_id_t bucket_page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  uint32_t GetGlobalDepth() const { return global_depth_; }
+
+  /** @return the mask selecting the global depth low bits of a hash */
+  uint32_t GetGlobalDepthMask() const { return (1U << global_depth_) - 1; }
+
+  /** @return the number of slots, 2^global depth */
+  uint32_t Size() const { return 1U << global_depth_; }
+
+  /** Double the directory, the new upper half mirrors the lower half */
+  void IncrGlobalDepth();
+
+  /** Halve the directory, only valid if CanShrink */
+  void DecrGlobalDepth() { global_depth_--; }
+
+  /** @return whether every bucket has a local depth below the global depth */
+  bool CanShrink() const;
+
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const { return bucket_page_ids_[bucket_idx]; }
+
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) { bucket_page_ids_[bucket_idx] = bucket_page_id; }
+
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const { return local_depths_[bucket_idx]; }
+
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth) { local_depths_[bucket_idx] = local_depth; }
+
+  /** @return the slot that differs from bucket_idx only in the highest bit of its local depth */
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const {
+    return bucket_idx ^ (1U << (local_depths_[bucket_idx] - 1));
+  }
+
+  /** Verify that every bucket is shared by exactly the slots its local depth implies */
+  bool VerifyIntegrity() const;
+
+ private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+};
+
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "Hash directory exceeds a page.");
+
+#endif  // MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
@@ -0,0 +1,39 @@
+#ifndef MINISQL_OVERFLOW_PAGE_H
+#define MINISQL_OVERFLOW_PAGE_H
+
+#include <cstring>
+
+#include "common/macros.h"
+#include "page/page.h"
+
+/**
+ * One page of the chain holding a char value too long to be stored in its tuple (see TableHeap::EncodeRow):
+ *  ----------------------------------------------
+ *  | NextPageId (4) | DataSize (4) | Data ...   |
+ *  ----------------------------------------------
+ * The tuple keeps a reference | TotalLength (4) | FirstPageId (4) | to the chain.
+ */
+class OverflowPage : public Page {
+ public:
+  void Init() {
+    SetNextPageId(INVALID_PAGE_ID);
+    SetDataSize(0);
+  }
+
+  page_id_t GetNextPageId() { return MACH_READ_FROM(page_id_t, GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  void SetNextPageId(page_id_t next_page_id) { MACH_WRITE_TO(page_id_t, GetData() + OFFSET_NEXT_PAGE_ID, next_page_id); }
+
+  uint32_t GetDataSize() { return MACH_READ_UINT32(GetData() + OFFSET_DATA_SIZE); }
+
+  void SetDataSize(uint32_t size) { MACH_WRITE_UINT32(GetData() + OFFSET_DATA_SIZE, size); }
+
+  char *GetPayload() { return GetData() + SIZE_HEADER; }
+
+  static constexpr uint32_t OFFSET_NEXT_PAGE_ID = 0;
+  static constexpr uint32_t OFFSET_DATA_SIZE = 4;
+  static constexpr uint32_t SIZE_HEADER = 8;
+  static constexpr uint32_t CAPACITY = PAGE_SIZE - SIZE_HEADER;
+};
+
+#endif  // MINISQL_OVERFLOW_PAGE_H
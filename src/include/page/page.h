@@ -1,6 +1,7 @@
 #ifndef MINISQL_PAGE_H
 #define MINISQL_PAGE_H
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 #include <shared_mutex>
@@ -38,11 +39,23 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch, the version becomes odd until the latch is released. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1);
+    rwlatch_.WUnlock();
+  }
+
+  /**
+   * @return the version of the page, odd while a writer holds the latch. Optimistic readers read the page
+   * without latching it and are valid only if the version is even and unchanged afterwards.
+   */
+  inline uint64_t GetVersion() const { return version_.load(); }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -78,6 +91,8 @@ class Page {
   bool is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Incremented when the write latch is acquired and released. */
+  std::atomic<uint64_t> version_{0};
 };
 
 #endif  // MINISQL_PAGE_H
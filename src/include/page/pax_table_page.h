@@ -0,0 +1,122 @@
+#ifndef MINISQL_PAX_TABLE_PAGE_H
+#define MINISQL_PAX_TABLE_PAGE_H
+/**
+ * PAX (Partition Attributes Across) page format, every column lives in its own minipage:
+ *  ---------------------------------------------------------------------------------
+ *  | HEADER | SLOT STATES | MINIPAGE col 0 | MINIPAGE col 1 | ... | MINIPAGE col N-1 |
+ *  ---------------------------------------------------------------------------------
+ *
+ *  Header format (size in bytes), the first 16 bytes are the same as TablePage:
+ *  -------------------------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| TupleCount (4) | Capacity (4) |
+ *  -------------------------------------------------------------------------------------------
+ *  | ColumnCount (4) | Minipage_0 offset (4) | ... | Minipage_N-1 offset (4) |
+ *  -------------------------------------------------------------------------------------------
+ *
+ *  Slot states: one byte per slot (empty / live / marked deleted).
+ *  Minipage format (8 bytes aligned): | null flags (Capacity) | values (Capacity * width) |
+ *  Values are fixed width: 4 bytes for int and float, 4 bytes length + declared length for char,
+ *  so the values of one column are contiguous and can be evaluated in a tight loop.
+ **/
+
+#include <cstring>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "page/page.h"
+#include "record/row.h"
+#include "transaction/lock_manager.h"
+#include "transaction/log_manager.h"
+#include "transaction/transaction.h"
+
+class PaxTablePage : public Page {
+ public:
+  void Init(page_id_t page_id, page_id_t prev_id, Schema *schema, LogManager *log_mgr, Transaction *txn);
+
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  page_id_t GetPrevPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PREV_PAGE_ID); }
+
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  void SetPrevPageId(page_id_t prev_page_id) {
+    memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
+  }
+
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  bool InsertTuple(Row &row, Schema *schema, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  bool MarkDelete(const RowId &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  bool UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Transaction *txn, LockManager *lock_manager,
+                   LogManager *log_manager);
+
+  void ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
+
+  void RollbackDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
+
+  bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager);
+
+  // 只读取column_ids对应的minipage
+  bool GetTuple(Row *row, Schema *schema, const std::vector<uint32_t> &column_ids, Transaction *txn,
+                LockManager *lock_manager);
+
+  bool GetFirstTupleRid(RowId *first_rid);
+
+  bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
+
+  // 定长格式总能原地更新，不会产生转发slot
+  bool GetForward(const RowId &, RowId *) { return false; }
+
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
+  uint32_t GetCapacity() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_CAPACITY); }
+
+  /** @return the start of the value array of a column, value i is at i * GetValueWidth(column) */
+  char *GetColumnValues(uint32_t column_id) { return GetData() + GetMinipageOffset(column_id) + AlignUp(GetCapacity()); }
+
+  /** @return the null flag array of a column, one byte per slot */
+  char *GetColumnNulls(uint32_t column_id) { return GetData() + GetMinipageOffset(column_id); }
+
+  /** @return the fixed width of one value of the column inside its minipage */
+  static uint32_t GetValueWidth(const Column *column);
+
+  /** @return whether a row fits the fixed width minipages of this layout */
+  static bool RowFits(const Row &row, Schema *schema);
+
+ private:
+  enum SlotState : char { SLOT_EMPTY = 0, SLOT_LIVE = 1, SLOT_DELETED = 2 };
+
+  static uint32_t AlignUp(uint32_t n) { return (n + 7) & ~7U; }
+
+  void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
+
+  uint32_t GetMinipageOffset(uint32_t column_id) {
+    return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_MINIPAGE + column_id * sizeof(uint32_t));
+  }
+
+  char *GetSlotStates() { return GetData() + AlignUp(SIZE_PAX_PAGE_HEADER + GetColumnCount() * sizeof(uint32_t)); }
+
+  uint32_t GetColumnCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COLUMN_COUNT); }
+
+  void WriteField(uint32_t slot_num, uint32_t column_id, const Column *column, const Field *field);
+
+  uint32_t ReadField(uint32_t slot_num, uint32_t column_id, const Column *column, Field **field,
+                     Arena *arena = nullptr);
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+  static constexpr size_t SIZE_PAX_PAGE_HEADER = 28;
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
+  static constexpr size_t OFFSET_TUPLE_COUNT = 16;
+  static constexpr size_t OFFSET_CAPACITY = 20;
+  static constexpr size_t OFFSET_COLUMN_COUNT = 24;
+  static constexpr size_t OFFSET_MINIPAGE = 28;
+};
+
+#endif  // MINISQL_PAX_TABLE_PAGE_H
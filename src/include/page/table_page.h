@@ -15,9 +15,13 @@
  *  ----------------------------------------------------------------
  *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
  *  ----------------------------------------------------------------
+ *
+ *  The top bits of a tuple size are flags: deleted, forwarded (the slot only holds the RowId of
+ *  the relocated tuple) and moved (the slot holds a tuple relocated from its home slot, scans skip it).
  **/
 
 #include <cstring>
+#include <functional>
 
 #include "common/macros.h"
 #include "common/rowid.h"
@@ -58,19 +62,55 @@ class TablePage : public Page {
 
   bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager);
 
+  // 只解码column_ids中的列
+  bool GetTuple(Row *row, Schema *schema, const std::vector<uint32_t> &column_ids, Transaction *txn,
+                LockManager *lock_manager);
+
+  /**
+   * 解码slot中的记录，不论是否已标记删除（用于回收它引用的溢出页）
+   * @return false if the slot is empty or a forward
+   */
+  bool GetTupleBody(Row *row, Schema *schema);
+
+  /** @return the number of slots, including empty and forwarding ones */
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
   bool GetFirstTupleRid(RowId *first_rid);
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
+  /**
+   * 插入一条从别的页迁移过来的记录，扫描时跳过它，只能通过原slot的转发访问
+   */
+  bool InsertMovedTuple(Row &row, Schema *schema, Transaction *txn, LockManager *lock_manager,
+                        LogManager *log_manager);
+
+  /**
+   * 把rid所在slot的内容替换为指向target的转发，slot号保持不变
+   */
+  void SetForward(const RowId &rid, const RowId &target);
+
+  /**
+   * @return whether the slot of rid is a forwarding slot (deleted mark ignored), target is filled when it is
+   */
+  bool GetForward(const RowId &rid, RowId *target);
+
+  /**
+   * 按new_schema重写本页所有记录（包括标记删除的和迁移来的），convert把按old_schema解码出的记录转换成新格式，
+   * 转换后的记录不能比原来更长
+   */
+  void ReencodeTuples(Schema *old_schema, Schema *new_schema, const std::function<void(Row *)> &convert);
+
  private:
+  /** Resize the tuple of a slot in place and keep its flags, @return the new start of the tuple */
+  char *ResizeTuple(uint32_t slot_num, uint32_t new_size);
+
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
   void SetFreeSpacePointer(uint32_t free_space_pointer) {
     memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
   }
 
-  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
-
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
   uint32_t GetFreeSpaceRemaining() {
@@ -99,9 +139,19 @@ class TablePage : public Page {
 
   static uint32_t UnsetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size & (~DELETE_MASK)); }
 
+  static bool IsForwarded(uint32_t tuple_size) { return static_cast<bool>(tuple_size & FORWARD_MASK); }
+
+  static bool IsMoved(uint32_t tuple_size) { return static_cast<bool>(tuple_size & MOVED_MASK); }
+
+  // 去掉标志位后的实际长度
+  static uint32_t GetLength(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size & LENGTH_MASK); }
+
  private:
   static_assert(sizeof(page_id_t) == 4);
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
+  static constexpr uint64_t FORWARD_MASK = (1U << (8 * sizeof(uint32_t) - 2));
+  static constexpr uint64_t MOVED_MASK = (1U << (8 * sizeof(uint32_t) - 3));
+  static constexpr uint64_t LENGTH_MASK = MOVED_MASK - 1;
   static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
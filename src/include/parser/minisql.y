@@ -1,5 +1,6 @@
 %{
   #include <stdio.h>
+  #include <strings.h>
   #include "parser/parser.h"
 
   extern char *yytext;
@@ -22,12 +23,12 @@
 %type <syntax_node> sql_create_database sql_drop_database sql_show_databases sql_use_database
 %type <syntax_node> sql_show_tables sql_create_table sql_drop_table
 %type <syntax_node> column_definition_list column_definition column_type column_list
-%type <syntax_node> sql_create_index sql_drop_index sql_show_indexes
+%type <syntax_node> sql_create_index index_include sql_drop_index sql_show_indexes
 %type <syntax_node> sql_trx_begin sql_trx_commit sql_trx_rollback
 %type <syntax_node> sql_select select_columns column_values column_value operator
 %type <syntax_node> connector where_conditions where_condition
 %type <syntax_node> sql_insert sql_delete sql_update update_values update_value
-%type <syntax_node> sql_quit sql_exec_file
+%type <syntax_node> sql_quit sql_exec_file sql_analyze
 
 %%
 
@@ -58,6 +59,7 @@ sql:
   | sql_trx_rollback { $$ = $1; }
   | sql_quit { $$ = $1; }
   | sql_exec_file { $$ = $1; }
+  | sql_analyze { $$ = $1; }
   ;
 
 sql_create_database:
@@ -101,6 +103,16 @@ sql_create_table:
     SyntaxNodeAddChildren($$, $3);
     SyntaxNodeAddChildren($$, list_node);
   }
+  | CREATE TABLE IDENTIFIER '(' column_definition_list ')' USING IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeCreateTable, NULL);
+    pSyntaxNode list_node = CreateSyntaxNode(kNodeColumnDefinitionList, NULL);
+    SyntaxNodeAddChildren(list_node, $5);
+    SyntaxNodeAddChildren($$, $3);
+    SyntaxNodeAddChildren($$, list_node);
+    pSyntaxNode layout_node = CreateSyntaxNode(kNodeTableLayout, "table layout");
+    SyntaxNodeAddChildren(layout_node, $8);
+    SyntaxNodeAddChildren($$, layout_node);
+  }
   ;
 
 column_list:
@@ -133,6 +145,16 @@ column_definition:
     SyntaxNodeAddChildren($$, $1);
     SyntaxNodeAddChildren($$, $2);
   }
+  | IDENTIFIER column_type IDENTIFIER {
+    /* 列选项dictionary不是关键字，按标识符匹配 */
+    if (strcasecmp($3->val_, "dictionary") != 0) {
+      yyerror("syntax error");
+      YYERROR;
+    }
+    $$ = CreateSyntaxNode(kNodeColumnDefinition, "dictionary");
+    SyntaxNodeAddChildren($$, $1);
+    SyntaxNodeAddChildren($$, $2);
+  }
   | IDENTIFIER column_type {
     $$ = CreateSyntaxNode(kNodeColumnDefinition, NULL);
     SyntaxNodeAddChildren($$, $1);
@@ -161,27 +183,64 @@ sql_drop_table:
   ;
 
 sql_create_index:
-  CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' {
+  CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' index_include {
     $$ = CreateSyntaxNode(kNodeCreateIndex, NULL);
     SyntaxNodeAddChildren($$, $3);
     SyntaxNodeAddChildren($$, $5);
     pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
     SyntaxNodeAddChildren(index_keys_node, $7);
     SyntaxNodeAddChildren($$, index_keys_node);
+    SyntaxNodeAddChildren($$, $9);
   }
-  | CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' USING IDENTIFIER {
+  | CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' index_include USING IDENTIFIER {
       $$ = CreateSyntaxNode(kNodeCreateIndex, NULL);
       SyntaxNodeAddChildren($$, $3);
       SyntaxNodeAddChildren($$, $5);
       pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
       SyntaxNodeAddChildren(index_keys_node, $7);
       SyntaxNodeAddChildren($$, index_keys_node);
+      SyntaxNodeAddChildren($$, $9);
       pSyntaxNode index_type_node = CreateSyntaxNode(kNodeIndexType, "index type");
-      SyntaxNodeAddChildren(index_type_node, $10);
+      SyntaxNodeAddChildren(index_type_node, $11);
+      SyntaxNodeAddChildren($$, index_type_node);
+  }
+  | CREATE UNIQUE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' index_include {
+    $$ = CreateSyntaxNode(kNodeCreateIndex, "unique");
+    SyntaxNodeAddChildren($$, $4);
+    SyntaxNodeAddChildren($$, $6);
+    pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
+    SyntaxNodeAddChildren(index_keys_node, $8);
+    SyntaxNodeAddChildren($$, index_keys_node);
+    SyntaxNodeAddChildren($$, $10);
+  }
+  | CREATE UNIQUE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' index_include USING IDENTIFIER {
+      $$ = CreateSyntaxNode(kNodeCreateIndex, "unique");
+      SyntaxNodeAddChildren($$, $4);
+      SyntaxNodeAddChildren($$, $6);
+      pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
+      SyntaxNodeAddChildren(index_keys_node, $8);
+      SyntaxNodeAddChildren($$, index_keys_node);
+      SyntaxNodeAddChildren($$, $10);
+      pSyntaxNode index_type_node = CreateSyntaxNode(kNodeIndexType, "index type");
+      SyntaxNodeAddChildren(index_type_node, $12);
       SyntaxNodeAddChildren($$, index_type_node);
   }
   ;
 
+index_include:
+  IDENTIFIER '(' column_list ')' {
+    if (strcasecmp($1->val_, "include") != 0) {
+      yyerror("syntax error");
+      YYERROR;
+    }
+    $$ = CreateSyntaxNode(kNodeColumnList, "include columns");
+    SyntaxNodeAddChildren($$, $3);
+  }
+  | {
+    $$ = NULL;
+  }
+  ;
+
 sql_drop_index:
   DROP INDEX IDENTIFIER {
     $$ = CreateSyntaxNode(kNodeDropIndex, NULL);
@@ -393,6 +452,18 @@ sql_exec_file:
   }
   ;
 
+/* analyze不是关键字，按标识符匹配 */
+sql_analyze:
+  IDENTIFIER IDENTIFIER {
+    if (strcasecmp($1->val_, "analyze") != 0) {
+      yyerror("syntax error");
+      YYERROR;
+    }
+    $$ = CreateSyntaxNode(kNodeAnalyze, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  ;
+
 %%
 int yyerror(char* error) {
 	MinisqlParserSetError(error);
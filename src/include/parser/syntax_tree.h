@@ -43,7 +43,9 @@ typedef enum {
   kNodeIndexType,            /** type of index */
   kNodeTrxBegin,             /** begin transaction command */
   kNodeTrxCommit,            /** commit transaction command */
-  kNodeTrxRollback           /** rollback transaction command */
+  kNodeTrxRollback,          /** rollback transaction command */
+  kNodeTableLayout,          /** storage layout of table: row, pax */
+  kNodeAnalyze               /** analyze table command */
 } SyntaxNodeType;
 
 /**
@@ -5,23 +5,58 @@
 #ifndef MINISQL_COMPARISON_EXPRESSION_H
 #define MINISQL_COMPARISON_EXPRESSION_H
 
+#include <unordered_map>
 #include <utility>
 
 #include "abstract_expression.h"
+#include "column_value_expression.h"
+#include "constant_value_expression.h"
 #include "record/schema.h"
+#include "record/type_kernels.h"
 
 /**
  * ComparisonExpression represents two expressions being compared.
+ * The operator and the compared type are resolved when the expression is built: the comparison runs through
+ * a kernel specialized for that type and operator, and `column op constant` reads the column of the row in place.
  */
 class ComparisonExpression : public AbstractExpression {
  public:
   /** Creates a new comparison expression representing (left comp_type right). */
   ComparisonExpression(AbstractExpressionRef left, AbstractExpressionRef right, string comp_type)
       : AbstractExpression({std::move(left), std::move(right)}, TypeId::kTypeInt, ExpressionType::ComparisonExpression),
-        comp_type_{std::move(comp_type)} {}
+        comp_type_{std::move(comp_type)} {
+    auto lhs = GetChildAt(0);
+    auto rhs = GetChildAt(1);
+    if (lhs->GetType() == ExpressionType::ColumnExpression) {
+      column_ = dynamic_cast<ColumnValueExpression *>(lhs.get());
+      if (rhs->GetType() == ExpressionType::ConstantExpression) {
+        constant_ = &dynamic_cast<ConstantValueExpression *>(rhs.get())->val_;
+      }
+    }
+    // 有常量时按常量的类型比较，否则两侧类型一致才能确定
+    if (rhs->GetType() == ExpressionType::ConstantExpression || lhs->GetReturnType() == rhs->GetReturnType()) {
+      kernel_type_ = rhs->GetReturnType();
+    }
+    if (comp_type_ == "is" || comp_type_ == "not") {
+      is_null_test_ = true;
+      expect_null_ = comp_type_ == "is";
+    } else if (ParseOp(comp_type_, &op_)) {
+      compare_ = GetCompareKernel(kernel_type_, op_);
+    }
+  }
 
   /** e.g. evaluate the result of id = 1 */
   Field Evaluate(const Row *row) const override {
+    if (column_ != nullptr && is_null_test_) {
+      bool is_null = row->GetField(column_->GetColIdx())->IsNull();
+      return Field(kTypeInt, GetCmpBool(is_null == expect_null_));
+    }
+    if (constant_ != nullptr && compare_ != nullptr) {
+      const Field *lhs = row->GetField(column_->GetColIdx());
+      if (lhs->GetTypeId() == kernel_type_) {
+        return Field(kTypeInt, compare_(*lhs, *constant_));
+      }
+    }
     Field lhs = GetChildAt(0)->Evaluate(row);
     Field rhs = GetChildAt(1)->Evaluate(row);
     return Field(kTypeInt, PerformComparison(lhs, rhs));
@@ -36,7 +71,24 @@ class ComparisonExpression : public AbstractExpression {
   std::string GetComparisonType() { return comp_type_; }
 
  private:
+  static bool ParseOp(const std::string &comp_type, CompareOp *op) {
+    static const std::unordered_map<std::string, CompareOp> ops{
+        {"=", CompareOp::kEquals},        {"<>", CompareOp::kNotEquals},         {"<", CompareOp::kLessThan},
+        {"<=", CompareOp::kLessThanEquals}, {">", CompareOp::kGreaterThan}, {">=", CompareOp::kGreaterThanEquals}};
+    auto iter = ops.find(comp_type);
+    if (iter == ops.end()) {
+      return false;
+    }
+    *op = iter->second;
+    return true;
+  }
+
   CmpBool PerformComparison(const Field &lhs, const Field &rhs) const {
+    if (is_null_test_)
+      return GetCmpBool(lhs.IsNull() == expect_null_);
+    if (compare_ != nullptr && lhs.GetTypeId() == kernel_type_ && rhs.GetTypeId() == kernel_type_)
+      return compare_(lhs, rhs);
+    // 类型在规划时无法确定，逐个值分派
     if (comp_type_ == "=")
       return lhs.CompareEquals(rhs);
     else if (comp_type_ == "<>")
@@ -49,15 +101,19 @@ class ComparisonExpression : public AbstractExpression {
       return lhs.CompareGreaterThan(rhs);
     else if (comp_type_ == ">=")
       return lhs.CompareGreaterThanEquals(rhs);
-    else if (comp_type_ == "is")
-      return GetCmpBool(lhs.IsNull());
-    else if (comp_type_ == "not")
-      return GetCmpBool(!lhs.IsNull());
     else
       throw std::logic_error("Unsupported comparison type");
   }
 
   std::string comp_type_;
+  bool is_null_test_{false};  // is null / is not null
+  bool expect_null_{false};
+  CompareOp op_{CompareOp::kEquals};
+  TypeId kernel_type_{kTypeInvalid};
+  FieldCompareFn compare_{nullptr};
+  /** 左侧是列时直接读取行中的字段，右侧是常量时不必求值 */
+  ColumnValueExpression *column_{nullptr};
+  const Field *constant_{nullptr};
 };
 
 #endif  // MINISQL_COMPARISON_EXPRESSION_H
@@ -6,6 +6,7 @@
 #define MINISQL_LOGIC_EXPRESSION_H
 
 #include "abstract_expression.h"
+#include "record/type_kernels.h"
 
 /** ArithmeticType represents the type of logic operation that we want to perform. */
 enum class LogicType { And, Or };
@@ -27,6 +28,11 @@ class LogicExpression : public AbstractExpression {
   /** e.g. evaluate the result of id = 1 and name = "str"*/
   Field Evaluate(const Row *row) const override {
     Field lhs = GetChildAt(0)->Evaluate(row);
+    // 左侧已能决定结果时不再求右侧
+    auto l = GetFieldAsCmpBool(lhs);
+    if ((logic_type_ == LogicType::And && l == CmpBool::kFalse) || (logic_type_ == LogicType::Or && l == CmpBool::kTrue)) {
+      return Field(kTypeInt, l);
+    }
     Field rhs = GetChildAt(1)->Evaluate(row);
     return Field(kTypeInt, PerformComputation(lhs, rhs));
   }
@@ -53,6 +59,9 @@ class LogicExpression : public AbstractExpression {
     if (val.IsNull()) {
       return CmpBool::kNull;
     }
+    if (val.GetTypeId() == kTypeInt) {
+      return GetCmpBool(TypeKernel<kTypeInt>::Equals(val, Field(kTypeInt, 1)));
+    }
     if (val.CompareEquals(Field(kTypeInt, 1))) {
       return CmpBool::kTrue;
     }
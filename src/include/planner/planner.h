@@ -45,6 +45,15 @@ class Planner {
 
   Schema *MakeOutputSchema(const std::vector<std::pair<std::string, AbstractExpressionRef>> &exprs);
 
+  /** Append the table column ids referenced by expr to column_ids */
+  void CollectColumnIds(const AbstractExpressionRef &expr, std::vector<uint32_t> &column_ids);
+
+  /** Collect the `column = constant` comparisons of the ANDed terms of expr */
+  void CollectEqualities(const AbstractExpressionRef &expr, std::vector<std::pair<uint32_t, const Field *>> &equalities);
+
+  /** @return the estimated fraction of the rows of the table satisfying expr, 1 for a null expr */
+  double EstimateSelectivity(const AbstractExpressionRef &expr, const TableStatistics *stats);
+
   /** Catalog will be used during the planning process. SHOULD ONLY BE USED IN
    * CODE PATH OF `PlanQuery`.
    */
@@ -101,8 +101,8 @@ class AbstractStatement {
                                       vector<uint32_t> *column_in_condition = nullptr, bool *has_or = nullptr) {
     switch (ast->type_) {
       case kNodeConnector: {
-        auto left = MakePredicate(ast->child_, table_name);
-        auto right = MakePredicate(ast->child_->next_, table_name);
+        auto left = MakePredicate(ast->child_, table_name, column_in_condition, has_or);
+        auto right = MakePredicate(ast->child_->next_, table_name, column_in_condition, has_or);
         if (has_or && !strcmp(ast->val_, "or")) {
           *has_or = true;
         }
@@ -4,6 +4,7 @@
 #include <cstring>
 #include <string>
 
+#include "common/arena.h"
 #include "common/config.h"
 #include "common/macros.h"
 #include "record/type_id.h"
@@ -18,6 +19,9 @@ class Field {
 
   friend class TypeFloat;
 
+  template <TypeId T>
+  friend struct TypeKernel;
+
  public:
   explicit Field(const TypeId type) : type_id_(type), len_(FIELD_NULL_LEN), is_null_(true) {}
 
@@ -61,12 +65,21 @@ class Field {
     }
   }
 
-  // copy constructor
+  // char, the value is copied into the arena
+  explicit Field(TypeId type, Arena *arena, const char *data, uint32_t len)
+      : type_id_(type), len_(len), in_arena_(true) {
+    ASSERT(type == TypeId::kTypeChar, "Invalid type.");
+    ASSERT(len < VARCHAR_MAX_LEN, "Field length exceeds max varchar length");
+    value_.chars_ = arena->CopyBytes(data, len);
+  }
+
+  // copy constructor, a value in an arena is copied to the heap so the copy may outlive the arena
   explicit Field(const Field &other) {
     type_id_ = other.type_id_;
     len_ = other.len_;
     is_null_ = other.is_null_;
-    manage_data_ = other.manage_data_;
+    overflow_ = other.overflow_;
+    manage_data_ = other.manage_data_ || other.in_arena_;
     if (type_id_ == TypeId::kTypeChar && !is_null_ && manage_data_) {
       value_.chars_ = new char[len_];
       memcpy(value_.chars_, other.value_.chars_, len_);
@@ -75,6 +88,19 @@ class Field {
     }
   }
 
+  // copy into an arena, values not owned by other (e.g. dictionary strings) are still shared
+  explicit Field(const Field &other, Arena *arena) {
+    type_id_ = other.type_id_;
+    len_ = other.len_;
+    is_null_ = other.is_null_;
+    overflow_ = other.overflow_;
+    value_ = other.value_;
+    if (type_id_ == TypeId::kTypeChar && !is_null_ && (other.manage_data_ || other.in_arena_)) {
+      value_.chars_ = arena->CopyBytes(other.value_.chars_, len_);
+      in_arena_ = true;
+    }
+  }
+
   // copy
   Field &operator=(Field &other) {
     Swap(*this, other);
@@ -87,12 +113,24 @@ class Field {
 
   inline TypeId GetTypeId() const { return type_id_; }
 
+  /**
+   * @return whether the data of this char field is only a reference to a value in overflow pages
+   *         (see TableHeap::ResolveOverflow) instead of the value itself
+   */
+  inline bool IsOverflow() const { return overflow_; }
+
+  inline void SetOverflow(bool overflow) { overflow_ = overflow; }
+
   inline const char *GetData() const { return Type::GetInstance(type_id_)->GetData(*this); }
 
   inline uint32_t SerializeTo(char *buf) const { return Type::GetInstance(type_id_)->SerializeTo(*this, buf); }
 
-  inline static uint32_t DeserializeFrom(char *buf, const TypeId type_id, Field **field, bool is_null) {
-    return Type::GetInstance(type_id)->DeserializeFrom(buf, field, is_null);
+  /**
+   * @param arena if not nullptr the field and its value are allocated in the arena
+   */
+  inline static uint32_t DeserializeFrom(char *buf, const TypeId type_id, Field **field, bool is_null,
+                                         Arena *arena = nullptr) {
+    return Type::GetInstance(type_id)->DeserializeFrom(buf, field, is_null, arena);
   }
 
   inline uint32_t GetSerializedSize() const { return Type::GetInstance(type_id_)->GetSerializedSize(*this, is_null_); }
@@ -127,6 +165,8 @@ class Field {
     std::swap(first.len_, second.len_);
     std::swap(first.is_null_, second.is_null_);
     std::swap(first.manage_data_, second.manage_data_);
+    std::swap(first.in_arena_, second.in_arena_);
+    std::swap(first.overflow_, second.overflow_);
   }
 
   std::string toString() {
@@ -154,6 +194,8 @@ class Field {
   uint32_t len_;
   bool is_null_{false};
   bool manage_data_{false};
+  bool in_arena_{false};  // 值在arena中，不随字段释放
+  bool overflow_{false};  // 值存在溢出页中，data是对溢出页链的引用
 };
 
 #endif  // MINISQL_FIELD_H
@@ -19,7 +19,9 @@
  * | Field Nums | Null bitmap |
  * -------------------------------------------
  *
- *
+ * The fields of a row live on the heap, or in the arena given at construction: such a row frees nothing,
+ * its fields go away with the arena. Copies are deep and always owned by the destination row,
+ * moves hand the fields (and the arena) over.
  */
 class Row {
  public:
@@ -27,17 +29,35 @@ class Row {
    * Row used for insert
    * Field integrity should check by upper level
    */
-  Row(std::vector<Field> &fields) {
+  Row(std::vector<Field> &fields, Arena *arena = nullptr) : arena_(arena) {
     // deep copy
+    fields_.reserve(fields.size());
     for (auto &field : fields) {
-      fields_.push_back(new Field(field));
+      fields_.push_back(NewField(field));
+    }
+  }
+
+  /**
+   * Empty row whose fields will be allocated in arena
+   */
+  explicit Row(Arena *arena) : arena_(arena) {}
+
+  /**
+   * Deep copy of other into arena
+   */
+  Row(const Row &other, Arena *arena) : rid_(other.rid_), arena_(arena) {
+    fields_.reserve(other.fields_.size());
+    for (auto &field : other.fields_) {
+      fields_.push_back(field == nullptr ? nullptr : NewField(*field));
     }
   }
 
   void destroy() {
     if (!fields_.empty()) {
-      for (auto field : fields_) {
-        delete field;
+      if (arena_ == nullptr) {
+        for (auto field : fields_) {
+          delete field;
+        }
       }
       fields_.clear();
     }
@@ -62,18 +82,40 @@ class Row {
     destroy();
     rid_ = other.rid_;
     for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
+      fields_.push_back(field == nullptr ? nullptr : new Field(*field));
     }
   }
 
   /**
-   * Assign operator, deep copy
+   * Assign operator, deep copy into the storage of this row
    */
   Row &operator=(const Row &other) {
+    if (this == &other) {
+      return *this;
+    }
     destroy();
     rid_ = other.rid_;
     for (auto &field : other.fields_) {
-      fields_.push_back(new Field(*field));
+      fields_.push_back(field == nullptr ? nullptr : NewField(*field));
+    }
+    return *this;
+  }
+
+  /**
+   * Move constructor and assign operator, fields are taken over without copy
+   */
+  Row(Row &&other) noexcept : rid_(other.rid_), arena_(other.arena_) {
+    fields_.swap(other.fields_);
+    other.arena_ = nullptr;
+  }
+
+  Row &operator=(Row &&other) noexcept {
+    if (this != &other) {
+      destroy();
+      rid_ = other.rid_;
+      arena_ = other.arena_;
+      fields_.swap(other.fields_);
+      other.arena_ = nullptr;
     }
     return *this;
   }
@@ -102,6 +144,13 @@ class Row {
 
   uint32_t DeserializeFrom(char *buf, Schema *schema);
 
+  /**
+   * Projected deserialize: only the columns in column_ids (ascending) are decoded,
+   * the other positions are left as nullptr and are skipped over without allocation.
+   * @return bytes consumed up to the end of the last decoded column
+   */
+  uint32_t DeserializeFrom(char *buf, Schema *schema, const std::vector<uint32_t> &column_ids);
+
   /**
    * For empty row, return 0
    * For non-empty row with null fields, eg: |null|null|null|, return header size only
@@ -124,8 +173,20 @@ class Row {
 
   inline size_t GetFieldCount() const { return fields_.size(); }
 
+  /** @return the arena holding the fields, nullptr if they are on the heap */
+  inline Arena *GetArena() const { return arena_; }
+
+  /** @return a copy of field allocated where the fields of this row live */
+  inline Field *NewField(const Field &field) const {
+    return arena_ == nullptr ? new Field(field) : arena_->New<Field>(field, arena_);
+  }
+
  private:
+  /** Decode the value of column column_id into fields_[column_id] with the kernels of the column type */
+  uint32_t DeserializeField(char *buf, Schema *schema, uint32_t column_id, bool is_null);
+
   RowId rid_{};
+  Arena *arena_{nullptr};
   std::vector<Field *> fields_; /** Make sure that all field ptr are destructed*/
 };
 
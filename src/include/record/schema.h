@@ -6,6 +6,7 @@
 #include "common/macros.h"
 #include "glog/logging.h"
 #include "record/column.h"
+#include "record/type_kernels.h"
 
 #ifndef MINISQL_SCHEMA_H
 #define MINISQL_SCHEMA_H
@@ -13,7 +14,13 @@
 class Schema {
  public:
   explicit Schema(const std::vector<Column *> columns, bool is_manage_ = true)
-      : columns_(std::move(columns)), is_manage_(is_manage_) {}
+      : columns_(std::move(columns)), is_manage_(is_manage_) {
+    // 每列的类型在建schema时解析一次
+    kernels_.reserve(columns_.size());
+    for (auto column : columns_) {
+      kernels_.push_back(column->GetType() == kTypeInvalid ? nullptr : &FieldKernels::Get(column->GetType()));
+    }
+  }
 
   ~Schema() {
     if (is_manage_) {
@@ -39,6 +46,9 @@ class Schema {
 
   inline uint32_t GetColumnCount() const { return static_cast<uint32_t>(columns_.size()); }
 
+  /** @return the comparison and codec kernels of the type of a column */
+  inline const FieldKernels &GetKernels(const uint32_t column_index) const { return *kernels_[column_index]; }
+
   /**
    * Shallow copy schema, only used in index
    *
@@ -83,6 +93,7 @@ class Schema {
  private:
   static constexpr uint32_t SCHEMA_MAGIC_NUM = 200715;
   std::vector<Column *> columns_;
+  std::vector<const FieldKernels *> kernels_;
   bool is_manage_ = false; /** if false, don't need to delete pointer to column */
 };
 
@@ -0,0 +1,213 @@
+#ifndef MINISQL_TYPE_KERNELS_H
+#define MINISQL_TYPE_KERNELS_H
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/arena.h"
+#include "common/macros.h"
+#include "record/field.h"
+
+/**
+ * TypeKernel<T> is the comparison and the codec of one field type, specialized at compile time.
+ * Type looks up a singleton by the type id of every value and calls it through a virtual function;
+ * hot paths instead resolve the type of a column once, to a FieldKernels table or a FieldCompareFn,
+ * and call the kernels without further type dispatch.
+ * The kernels expect non-null values, callers handle nulls. Stored values use the layout of Type::SerializeTo.
+ */
+template <TypeId T>
+struct TypeKernel;
+
+template <>
+struct TypeKernel<kTypeInt> {
+  static bool Equals(const Field &lhs, const Field &rhs) { return lhs.value_.integer_ == rhs.value_.integer_; }
+
+  static int Compare(const Field &lhs, const Field &rhs) {
+    return (lhs.value_.integer_ > rhs.value_.integer_) - (lhs.value_.integer_ < rhs.value_.integer_);
+  }
+
+  static uint32_t SerializeTo(const Field &field, char *buf) {
+    MACH_WRITE_TO(int32_t, buf, field.value_.integer_);
+    return sizeof(int32_t);
+  }
+
+  static uint32_t GetSerializedSize(const Field &) { return sizeof(int32_t); }
+
+  static uint32_t GetStoredSize(const char *) { return sizeof(int32_t); }
+
+  static uint32_t DeserializeFrom(const char *buf, Field **field, Arena *arena) {
+    int32_t val = MACH_READ_FROM(int32_t, buf);
+    *field = arena == nullptr ? new Field(kTypeInt, val) : arena->New<Field>(kTypeInt, val);
+    return sizeof(int32_t);
+  }
+
+  static int CompareStored(const char *lhs, const char *rhs) {
+    int32_t l = MACH_READ_FROM(int32_t, lhs);
+    int32_t r = MACH_READ_FROM(int32_t, rhs);
+    return (l > r) - (l < r);
+  }
+};
+
+template <>
+struct TypeKernel<kTypeFloat> {
+  static bool Equals(const Field &lhs, const Field &rhs) { return lhs.value_.float_ == rhs.value_.float_; }
+
+  static int Compare(const Field &lhs, const Field &rhs) {
+    return (lhs.value_.float_ > rhs.value_.float_) - (lhs.value_.float_ < rhs.value_.float_);
+  }
+
+  static uint32_t SerializeTo(const Field &field, char *buf) {
+    MACH_WRITE_TO(float, buf, field.value_.float_);
+    return sizeof(float);
+  }
+
+  static uint32_t GetSerializedSize(const Field &) { return sizeof(float); }
+
+  static uint32_t GetStoredSize(const char *) { return sizeof(float); }
+
+  static uint32_t DeserializeFrom(const char *buf, Field **field, Arena *arena) {
+    float val = MACH_READ_FROM(float, buf);
+    *field = arena == nullptr ? new Field(kTypeFloat, val) : arena->New<Field>(kTypeFloat, val);
+    return sizeof(float);
+  }
+
+  static int CompareStored(const char *lhs, const char *rhs) {
+    float l = MACH_READ_FROM(float, lhs);
+    float r = MACH_READ_FROM(float, rhs);
+    return (l > r) - (l < r);
+  }
+};
+
+template <>
+struct TypeKernel<kTypeChar> {
+  static int CompareBytes(const char *lhs, uint32_t lhs_len, const char *rhs, uint32_t rhs_len) {
+    int ret = memcmp(lhs, rhs, std::min(lhs_len, rhs_len));
+    if (ret != 0) {
+      return ret < 0 ? -1 : 1;
+    }
+    return (lhs_len > rhs_len) - (lhs_len < rhs_len);
+  }
+
+  static bool Equals(const Field &lhs, const Field &rhs) {
+    return lhs.len_ == rhs.len_ && memcmp(lhs.value_.chars_, rhs.value_.chars_, lhs.len_) == 0;
+  }
+
+  static int Compare(const Field &lhs, const Field &rhs) {
+    return CompareBytes(lhs.value_.chars_, lhs.len_, rhs.value_.chars_, rhs.len_);
+  }
+
+  // 溢出引用在长度的最高位标记
+  static uint32_t SerializeTo(const Field &field, char *buf) {
+    MACH_WRITE_UINT32(buf, field.overflow_ ? field.len_ | FIELD_OVERFLOW_FLAG : field.len_);
+    memcpy(buf + sizeof(uint32_t), field.value_.chars_, field.len_);
+    return sizeof(uint32_t) + field.len_;
+  }
+
+  static uint32_t GetSerializedSize(const Field &field) { return sizeof(uint32_t) + field.len_; }
+
+  static uint32_t GetStoredSize(const char *buf) {
+    return sizeof(uint32_t) + (MACH_READ_UINT32(buf) & ~FIELD_OVERFLOW_FLAG);
+  }
+
+  static uint32_t DeserializeFrom(const char *buf, Field **field, Arena *arena) {
+    uint32_t len = MACH_READ_UINT32(buf);
+    bool overflow = (len & FIELD_OVERFLOW_FLAG) != 0;
+    len &= ~FIELD_OVERFLOW_FLAG;
+    const char *data = buf + sizeof(uint32_t);
+    if (arena == nullptr) {
+      *field = new Field(kTypeChar, const_cast<char *>(data), len, true);
+    } else {
+      *field = arena->New<Field>(kTypeChar, arena, data, len);
+    }
+    (*field)->overflow_ = overflow;
+    return sizeof(uint32_t) + len;
+  }
+
+  static int CompareStored(const char *lhs, const char *rhs) {
+    return CompareBytes(lhs + sizeof(uint32_t), MACH_READ_UINT32(lhs), rhs + sizeof(uint32_t), MACH_READ_UINT32(rhs));
+  }
+};
+
+/**
+ * The kernels of one type as function pointers, resolved once per column (see Schema::GetKernels)
+ */
+struct FieldKernels {
+  int (*compare)(const Field &lhs, const Field &rhs);
+  uint32_t (*serialize_to)(const Field &field, char *buf);
+  uint32_t (*get_serialized_size)(const Field &field);
+  uint32_t (*get_stored_size)(const char *buf);
+  uint32_t (*deserialize_from)(const char *buf, Field **field, Arena *arena);
+  int (*compare_stored)(const char *lhs, const char *rhs);
+
+  template <TypeId T>
+  static constexpr FieldKernels Of() {
+    return {&TypeKernel<T>::Compare,         &TypeKernel<T>::SerializeTo,     &TypeKernel<T>::GetSerializedSize,
+            &TypeKernel<T>::GetStoredSize,   &TypeKernel<T>::DeserializeFrom, &TypeKernel<T>::CompareStored};
+  }
+
+  static const FieldKernels &Get(TypeId type) {
+    static constexpr FieldKernels kernels[] = {Of<kTypeInt>(), Of<kTypeInt>(), Of<kTypeFloat>(), Of<kTypeChar>()};
+    ASSERT(type > kTypeInvalid && type <= KMaxTypeId, "Invalid type.");
+    return kernels[type];
+  }
+};
+
+/** Comparison operators of ComparisonExpression */
+enum class CompareOp { kEquals, kNotEquals, kLessThan, kLessThanEquals, kGreaterThan, kGreaterThanEquals };
+
+/** `lhs op rhs` for fields of type T, kNull if either is null, i.e. Field::CompareXxx without the dispatch */
+template <TypeId T, CompareOp Op>
+CmpBool CompareFields(const Field &lhs, const Field &rhs) {
+  if (lhs.IsNull() || rhs.IsNull()) {
+    return CmpBool::kNull;
+  }
+  if constexpr (Op == CompareOp::kEquals) {
+    return GetCmpBool(TypeKernel<T>::Equals(lhs, rhs));
+  } else if constexpr (Op == CompareOp::kNotEquals) {
+    return GetCmpBool(!TypeKernel<T>::Equals(lhs, rhs));
+  } else if constexpr (Op == CompareOp::kLessThan) {
+    return GetCmpBool(TypeKernel<T>::Compare(lhs, rhs) < 0);
+  } else if constexpr (Op == CompareOp::kLessThanEquals) {
+    return GetCmpBool(TypeKernel<T>::Compare(lhs, rhs) <= 0);
+  } else if constexpr (Op == CompareOp::kGreaterThan) {
+    return GetCmpBool(TypeKernel<T>::Compare(lhs, rhs) > 0);
+  } else {
+    return GetCmpBool(TypeKernel<T>::Compare(lhs, rhs) >= 0);
+  }
+}
+
+using FieldCompareFn = CmpBool (*)(const Field &lhs, const Field &rhs);
+
+template <TypeId T>
+FieldCompareFn GetCompareKernel(CompareOp op) {
+  switch (op) {
+    case CompareOp::kEquals:
+      return &CompareFields<T, CompareOp::kEquals>;
+    case CompareOp::kNotEquals:
+      return &CompareFields<T, CompareOp::kNotEquals>;
+    case CompareOp::kLessThan:
+      return &CompareFields<T, CompareOp::kLessThan>;
+    case CompareOp::kLessThanEquals:
+      return &CompareFields<T, CompareOp::kLessThanEquals>;
+    case CompareOp::kGreaterThan:
+      return &CompareFields<T, CompareOp::kGreaterThan>;
+    default:
+      return &CompareFields<T, CompareOp::kGreaterThanEquals>;
+  }
+}
+
+/** @return the kernel of `lhs op rhs` on fields of the given type, nullptr for an invalid type */
+inline FieldCompareFn GetCompareKernel(TypeId type, CompareOp op) {
+  switch (type) {
+    case kTypeInt:
+      return GetCompareKernel<kTypeInt>(op);
+    case kTypeFloat:
+      return GetCompareKernel<kTypeFloat>(op);
+    case kTypeChar:
+      return GetCompareKernel<kTypeChar>(op);
+    default:
+      return nullptr;
+  }
+}
+
+#endif  // MINISQL_TYPE_KERNELS_H
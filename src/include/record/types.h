@@ -8,6 +8,7 @@
 #include "common/config.h"
 #include "record/type_id.h"
 
+class Arena;
 class Field;
 
 enum CmpBool { kFalse = 0, kTrue, kNull };
@@ -44,7 +45,7 @@ class Type {
   virtual uint32_t SerializeTo(const Field &field, char *buf) const;
 
   // Deserialize a field of the given type from the given storage space.
-  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null) const;
+  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null, Arena *arena = nullptr) const;
 
   // Get serialize size of a field
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const;
@@ -78,7 +79,7 @@ class TypeInt : public Type {
 
   virtual uint32_t SerializeTo(const Field &field, char *buf) const override;
 
-  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null) const override;
+  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null, Arena *arena = nullptr) const override;
 
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const override;
 
@@ -101,7 +102,7 @@ class TypeChar : public Type {
 
   virtual uint32_t SerializeTo(const Field &field, char *buf) const override;
 
-  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null) const override;
+  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null, Arena *arena = nullptr) const override;
 
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const override;
 
@@ -128,7 +129,7 @@ class TypeFloat : public Type {
 
   virtual uint32_t SerializeTo(const Field &field, char *buf) const override;
 
-  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null) const override;
+  virtual uint32_t DeserializeFrom(char *storage, Field **field, bool is_null, Arena *arena = nullptr) const override;
 
   virtual uint32_t GetSerializedSize(const Field &field, bool is_null) const override;
 
@@ -0,0 +1,78 @@
+#ifndef MINISQL_DICTIONARY_H
+#define MINISQL_DICTIONARY_H
+
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "record/field.h"
+
+/**
+ * Dictionary maps the distinct values of one dictionary encoded char column to dense int codes.
+ * The heap stores the code instead of the string, the dictionary keeps the strings in a chain of pages:
+ *  ---------------------------------------------------------------------------------------
+ *  | NextPageId (4) | EntryCount (4) | Length_0 (4) | Bytes_0 | Length_1 (4) | Bytes_1 | ... |
+ *  ---------------------------------------------------------------------------------------
+ * Entry i of the chain is the value of code i. New values are appended to the last page, codes never change.
+ * Decoded strings are never moved, so fields may point into the dictionary instead of copying the value.
+ */
+class Dictionary {
+ public:
+  /** code of a value that is not in the dictionary, equal to no code of the column */
+  static constexpr int32_t NO_CODE = -1;
+
+  /** longest value an entry can hold, the header, the length and the bytes of one value fill a page */
+  static constexpr uint32_t MAX_VALUE_LENGTH = PAGE_SIZE - 3 * sizeof(uint32_t);
+
+  /** Create an empty dictionary on a new page */
+  static Dictionary *Create(BufferPoolManager *buffer_pool_manager);
+
+  /** Read the dictionary whose chain starts at first_page_id */
+  static Dictionary *Load(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id);
+
+  /** @return the code of the value, a new value gets the next code and is written to the page chain */
+  int32_t Encode(const char *data, uint32_t len);
+
+  /** @return the code of the value, NO_CODE if it is not in the dictionary */
+  int32_t Lookup(const char *data, uint32_t len) const;
+
+  /** @return the value of a code, the reference stays valid as long as the dictionary */
+  const std::string &Decode(int32_t code) const;
+
+  /** @return a char field of the value of an int code field, pointing into the dictionary; null stays null */
+  Field DecodeField(const Field &code) const;
+
+  /** @return an int field holding the code of a char field, the value is added if it is new; null stays null */
+  Field EncodeField(const Field &value);
+
+  uint32_t GetSize() const;
+
+  page_id_t GetFirstPageId() const { return first_page_id_; }
+
+  /** Delete the page chain */
+  void Destroy();
+
+ private:
+  explicit Dictionary(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id)
+      : buffer_pool_manager_(buffer_pool_manager), first_page_id_(first_page_id), last_page_id_(first_page_id) {}
+
+  /** Append one value to the last page, a new page is linked when it is full */
+  void Append(const std::string &value);
+
+  static constexpr uint32_t OFFSET_NEXT_PAGE_ID = 0;
+  static constexpr uint32_t OFFSET_ENTRY_COUNT = 4;
+  static constexpr uint32_t SIZE_HEADER = 8;
+
+  BufferPoolManager *buffer_pool_manager_;
+  page_id_t first_page_id_;
+  page_id_t last_page_id_;
+  uint32_t last_page_used_{SIZE_HEADER};
+  mutable std::shared_mutex latch_;
+  std::deque<std::string> values_;  // deque保证已有字符串不会被移动
+  std::unordered_map<std::string, int32_t> codes_;
+};
+
+#endif  // MINISQL_DICTIONARY_H
@@ -3,29 +3,54 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "page/header_page.h"
+#include "page/overflow_page.h"
+#include "page/pax_table_page.h"
 #include "page/table_page.h"
+#include "storage/dictionary.h"
 #include "storage/table_iterator.h"
+#include "storage/zone_map.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 
+/**
+ * Storage layout of the pages of a table heap, chosen at CREATE TABLE time.
+ * kRow: slotted TablePage, kPax: PaxTablePage with one minipage per column.
+ */
+enum class TableLayout : uint32_t { kRow = 0, kPax = 1 };
+
 class TableHeap {
   friend class TableIterator;
 
  public:
+  /**
+   * @param dictionaries one entry per column, the dictionary of a dictionary encoded char column or nullptr,
+   *                     empty if no column is encoded; the heap takes the ownership of the dictionaries
+   */
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
-                           LogManager *log_manager, LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
+                           LogManager *log_manager, LockManager *lock_manager,
+                           TableLayout layout = TableLayout::kRow, const std::vector<Dictionary *> &dictionaries = {}) {
+    return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager, layout, dictionaries);
   }
 
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+                           LogManager *log_manager, LockManager *lock_manager,
+                           TableLayout layout = TableLayout::kRow, const std::vector<Dictionary *> &dictionaries = {}) {
+    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager, layout,
+                         dictionaries);
   }
 
-  ~TableHeap() {}
+  ~TableHeap() {
+    if (storage_schema_ != schema_) {
+      delete storage_schema_;
+    }
+    for (auto dictionary : dictionaries_) {
+      delete dictionary;
+    }
+  }
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * A char value longer than its column is rejected as well, index keys keep at most the column length.
    * @param[in/out] row Tuple Row to insert, the rid of the inserted tuple is wrapped in object row
    * @param[in] txn The transaction performing the insert
    * @return true iff the insert is successful
@@ -41,11 +66,13 @@ class TableHeap {
   bool MarkDelete(const RowId &rid, Transaction *txn);
 
   /**
-   * if the new tuple is too large to fit in the old page, return false (will delete and insert)
+   * Update the tuple in place. If the new tuple no longer fits in its page it is moved to another page
+   * and the old slot keeps a forward to it, so rid stays valid and indexes need no change.
    * @param[in] row Tuple of new row
    * @param[in] rid Rid of the old tuple
    * @param[in] txn Transaction performing the update
-   * @return true is update is successful.
+   * @return true is update is successful (i.e. the tuple exists and is not larger than a page, and its char
+   * values are not longer than their columns).
    */
   bool UpdateTuple(const Row &row, const RowId &rid, Transaction *txn);
 
@@ -71,6 +98,15 @@ class TableHeap {
    */
   bool GetTuple(Row *row, Transaction *txn);
 
+  /**
+   * Read a tuple from the table, decoding only the given columns.
+   * @param[in/out] row Output variable, columns not in column_ids are left as nullptr
+   * @param[in] column_ids ascending column ids of the table schema to decode
+   * @param[in] txn transaction performing the read
+   * @return true if the read was successful (i.e. the tuple exists)
+   */
+  bool GetTuple(Row *row, const std::vector<uint32_t> &column_ids, Transaction *txn);
+
   void FreeTableHeap() {
     auto next_page_id = first_page_id_;
     while (next_page_id != INVALID_PAGE_ID) {
@@ -93,6 +129,30 @@ class TableHeap {
    */
   TableIterator Begin(Transaction *txn);
 
+  /**
+   * @return the begin iterator of this table which only decodes the columns in column_ids,
+   *         column_ids must outlive the iterator
+   */
+  TableIterator Begin(Transaction *txn, const std::vector<uint32_t> *column_ids);
+
+  /**
+   * @return an iterator over the pages from first_page_id up to (excluding) stop_page_id of the page list,
+   *         INVALID_PAGE_ID scans to the last page; used to hand page ranges to parallel scan workers
+   * @param decode false leaves the int codes of dictionary encoded columns in the rows (see DecodeRow)
+   */
+  TableIterator Begin(Transaction *txn, const std::vector<uint32_t> *column_ids, page_id_t first_page_id,
+                      page_id_t stop_page_id, bool decode = true);
+
+  /**
+   * Collect the ids of all pages in list order from the zone map, no page is fetched.
+   */
+  void GetPageIds(std::vector<page_id_t> &page_ids);
+
+  /**
+   * @return the per page synopses of this table, built by one scan on first use for a table loaded from disk
+   */
+  ZoneMap *GetZoneMap();
+
   /**
    * @return the end iterator of this table
    */
@@ -103,36 +163,136 @@ class TableHeap {
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  inline TableLayout GetLayout() const { return layout_; }
+
+  /** @return the dictionary of a dictionary encoded column, nullptr for other columns */
+  inline Dictionary *GetDictionary(uint32_t column_id) const {
+    return column_id < dictionaries_.size() ? dictionaries_[column_id] : nullptr;
+  }
+
+  inline bool HasDictionary() const { return storage_schema_ != schema_; }
+
+  /**
+   * Switch a char column of a row layout table to dictionary encoding, the tuples of all pages are rewritten
+   * in place (codes are never longer than the strings). Must not run concurrently with other accesses.
+   * @return false if the column cannot be encoded, the dictionary is then not owned by the heap
+   */
+  bool EnableDictionary(uint32_t column_id, Dictionary *dictionary);
+
+  /** Replace the int codes of the decoded dictionary encoded columns of a row by their values */
+  void DecodeRow(Row *row) const;
+
 private:
   /**
    * create table heap and initialize first page
    */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
-                     LogManager *log_manager, LockManager *lock_manager) :
+                     LogManager *log_manager, LockManager *lock_manager, TableLayout layout,
+                     const std::vector<Dictionary *> &dictionaries) :
           buffer_pool_manager_(buffer_pool_manager),
           schema_(schema),
           log_manager_(log_manager),
-          lock_manager_(lock_manager) {
-//    ASSERT(false, "Not implemented yet.");
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->NewPage(first_page_id_)); //新增加
-    page->Init(first_page_id_,INVALID_PAGE_ID,log_manager,txn); //新增加
-    buffer_pool_manager->UnpinPage(first_page_id_, true);  //新增加
+          lock_manager_(lock_manager),
+          layout_(layout),
+          zone_map_(schema) {
+    InitDictionaries(dictionaries);
+    InitFirstPage(txn);
   };
 
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+                     LogManager *log_manager, LockManager *lock_manager, TableLayout layout,
+                     const std::vector<Dictionary *> &dictionaries)
       : buffer_pool_manager_(buffer_pool_manager),
         first_page_id_(first_page_id),
         schema_(schema),
         log_manager_(log_manager),
-        lock_manager_(lock_manager) {}
+        lock_manager_(lock_manager),
+        layout_(layout),
+        zone_map_(schema) {
+    InitDictionaries(dictionaries);
+  }
+
+  void InitFirstPage(Transaction *txn);
+
+  void InitDictionaries(const std::vector<Dictionary *> &dictionaries);
+
+  /** @return the schema of the stored tuples: dictionary encoded columns become int columns */
+  static Schema *MakeStorageSchema(Schema *schema, const std::vector<Dictionary *> &dictionaries);
+
+  /**
+   * Convert a row to the stored format: dictionary encoded columns become codes and char values longer than
+   * TUPLE_INLINE_VALUE_MAX of a row layout table are moved to overflow pages, leaving a reference in the tuple.
+   * @param overflow_pages receives the first pages of the written chains, to be freed if the row is not stored
+   * @return whether the row needs a conversion, encoded is only filled if it does
+   */
+  bool EncodeRow(const Row &row, Row *encoded, std::vector<page_id_t> *overflow_pages);
+
+  /** @return false if a char value of row is longer than its column */
+  bool ValuesFit(const Row &row) const;
+
+  /** Write a value to a new chain of overflow pages, @return the first page, INVALID_PAGE_ID if out of pages */
+  page_id_t WriteOverflow(const char *data, uint32_t len);
+
+  /** @return the value an overflow reference field points to */
+  std::string ReadOverflow(const Field &reference) const;
+
+  void FreeOverflow(page_id_t first_page_id);
+
+  /** Free the chains referenced by a tuple as stored */
+  void FreeOverflow(const Row &stored);
+
+  /**
+   * Replace the overflow references of a read tuple by their values, so only the columns actually read are
+   * fetched. Called with the page latched, the chains cannot be freed meanwhile.
+   */
+  void ResolveOverflow(Row *row) const;
+
+  /** Read a tuple as stored, without decoding dictionary codes */
+  bool GetStoredTuple(Row *row, const std::vector<uint32_t> *column_ids, Transaction *txn);
+
+  void BuildZoneMap();
+
+  // 以下模板按页格式(TablePage/PaxTablePage)实例化，定义在table_heap.cpp中
+  // home_page_id有效时插入的是从该页转发出去的记录，不会放回原页
+  template <typename PageType>
+  bool InsertTupleImpl(Row &row, Transaction *txn, page_id_t home_page_id = INVALID_PAGE_ID);
+
+  /**
+   * Latch the page a forwarded slot points to, the home page of rid is latched by the caller.
+   * Two pages are always latched in ascending page id order, so a target on a lower page is latched after the
+   * home latch is released and before it is taken again; the forward is read again after that.
+   * @return the pinned and latched target page, nullptr if rid is not forwarded
+   */
+  template <typename PageType>
+  PageType *LatchForward(PageType *page, const RowId &rid, RowId *target, bool exclusive);
+
+  template <typename PageType>
+  bool MarkDeleteImpl(const RowId &rid, Transaction *txn);
+
+  template <typename PageType>
+  bool UpdateTupleImpl(const Row &row, const RowId &rid, Transaction *txn);
+
+  // 返回被删除的记录此前是否未被标记删除（即回滚插入）
+  template <typename PageType>
+  bool ApplyDeleteImpl(const RowId &rid, Transaction *txn);
+
+  template <typename PageType>
+  void RollbackDeleteImpl(const RowId &rid, Transaction *txn);
+
+  template <typename PageType>
+  bool GetTupleImpl(Row *row, const std::vector<uint32_t> *column_ids, Transaction *txn);
 
  private:
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
   Schema *schema_;
+  Schema *storage_schema_{nullptr};         // 页中记录的格式，没有字典编码列时就是schema_
+  std::vector<Dictionary *> dictionaries_;  // 每列的字典，未编码的列为nullptr
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  TableLayout layout_{TableLayout::kRow};
+  ZoneMap zone_map_;
+  std::mutex zone_map_latch_;  // 保护zone map的延迟构建
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
@@ -1,43 +1,79 @@
 #ifndef MINISQL_TABLE_ITERATOR_H
 #define MINISQL_TABLE_ITERATOR_H
 
+#include <memory>
+
+#include "common/arena.h"
 #include "common/rowid.h"
 #include "record/row.h"
 #include "transaction/transaction.h"
 
+class Page;
 class TableHeap;
 
+/**
+ * TableIterator keeps the page it is walking pinned, so stepping through the slots of one page
+ * costs no buffer pool lookup and moving to the next page costs exactly one FetchPage.
+ * The page read latch is only taken while a slot is located and decoded, so a delete/update
+ * driven by this scan can still latch the same page between two steps.
+ * The row buffer is owned by the iterator and reused for every tuple, its fields are decoded into an arena
+ * of the iterator that is reset on every step, so a scan allocates nothing per tuple.
+ */
 class TableIterator {
  public:
-  // you may define your own constructor based on your member variables
-  //  explicit TableIterator();
-  explicit TableIterator(){};
-  explicit TableIterator(TableHeap * t,RowId rid);  //修改了构造函数
+  explicit TableIterator() = default;
+
+  /**
+   * Position the iterator on the first live tuple at or after rid.
+   * @param column_ids columns to decode (see TableHeap::GetTuple), nullptr decodes all, must outlive the iterator
+   * @param stop_page_id the iterator ends when it reaches this page, INVALID_PAGE_ID runs to the last page
+   * @param decode false returns dictionary encoded columns as their int codes
+   */
+  explicit TableIterator(TableHeap *table_heap, RowId rid, const std::vector<uint32_t> *column_ids = nullptr,
+                         page_id_t stop_page_id = INVALID_PAGE_ID, bool decode = true);
 
-  explicit TableIterator(const TableIterator &other);
+  TableIterator(const TableIterator &other);
+
+  TableIterator(TableIterator &&other) noexcept;
 
   virtual ~TableIterator();
 
-  //  inline bool operator==(const TableIterator &itr) const;
   bool operator==(const TableIterator &itr) const;
 
-  //  inline bool operator!=(const TableIterator &itr) const;
   bool operator!=(const TableIterator &itr) const;
 
   const Row &operator*();
 
   Row *operator->();
 
-  TableIterator &operator=(const TableIterator &itr) noexcept;
+  TableIterator &operator=(const TableIterator &itr);
+
+  TableIterator &operator=(TableIterator &&itr) noexcept;
 
   TableIterator &operator++();
 
   TableIterator operator++(int);
 
  private:
-  // add your own private member variables here
-  TableHeap* table_heap_;// 新加
-  Row* row_;// 新加
+  /** Find the first live tuple at or after slot_num, starting on page_ and following the page list */
+  void Seek(uint32_t slot_num);
+
+  template <typename PageType>
+  void SeekImpl(uint32_t slot_num);
+
+  /** Unpin the current page and turn this into the end iterator */
+  void Release();
+
+  /** Drop the fields of the current tuple */
+  void ClearRow();
+
+  TableHeap *table_heap_{nullptr};
+  Page *page_{nullptr};       // 当前遍历的页，保持pin
+  std::unique_ptr<Arena> arena_;  // 当前行的字段，拷贝得到的迭代器没有arena
+  Row row_{INVALID_ROWID};        // 复用的行缓冲
+  const std::vector<uint32_t> *column_ids_{nullptr};  // 投影列，nullptr表示解码全部列
+  page_id_t stop_page_id_{INVALID_PAGE_ID};           // 到达此页即结束，用于按页范围扫描
+  bool decode_{true};                                 // 是否把字典编码还原成字符串
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
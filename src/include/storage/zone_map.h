@@ -0,0 +1,82 @@
+#ifndef MINISQL_ZONE_MAP_H
+#define MINISQL_ZONE_MAP_H
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * ZoneMap keeps a small synopsis for every page of a table heap, next to the pages in memory:
+ * the number of rows, and per int/float column the min, the max and the number of nulls.
+ * It also serves as the page directory of the heap (page ids in list order).
+ *
+ * Synopses are conservative: inserts and updates widen min/max, deletes only lower the row count,
+ * so min/max (and the null count) may cover values no longer on the page, never the other way round.
+ * A row moved away by a forwarded update is accounted to its home page, where scans find it.
+ */
+class ZoneMap {
+ public:
+  explicit ZoneMap(Schema *schema) : schema_(schema) {}
+
+  /** Register a new page at the end of the page list */
+  void AppendPage(page_id_t page_id);
+
+  /** A row was inserted into the page */
+  void Insert(page_id_t page_id, const Row &row);
+
+  /** A row of the page got new values, the old ones stay inside min/max */
+  void Update(page_id_t page_id, const Row &row);
+
+  /** A live row of the page was deleted */
+  void Delete(page_id_t page_id);
+
+  /**
+   * @return false only if no row of the page can satisfy `column op value`,
+   *         op is one of the operators of ComparisonExpression
+   */
+  bool MayMatch(page_id_t page_id, uint32_t column_id, const std::string &op, const Field &value);
+
+  /** @return false only if the page holds no row */
+  bool MayHaveRows(page_id_t page_id);
+
+  /**
+   * @return the number of nulls of a column on the page, an upper bound once rows have been deleted or updated,
+   *         0 for a page unknown to the zone map
+   */
+  uint32_t GetNullCount(page_id_t page_id, uint32_t column_id);
+
+  void GetPageIds(std::vector<page_id_t> &page_ids);
+
+  bool IsBuilt() const { return built_; }
+
+  void SetBuilt() { built_ = true; }
+
+ private:
+  struct PageZone {
+    uint32_t row_count_{0};
+    std::vector<Field> min_;  // 非数值列和没有非空值时为null
+    std::vector<Field> max_;
+    std::vector<uint32_t> null_count_;
+  };
+
+  PageZone *FindZone(page_id_t page_id);
+
+  void ResetZone(PageZone *zone);
+
+  void Widen(PageZone *zone, const Row &row);
+
+  static bool IsNumeric(TypeId type) { return type == TypeId::kTypeInt || type == TypeId::kTypeFloat; }
+
+  Schema *schema_;
+  bool built_{false};
+  std::mutex latch_;
+  std::vector<page_id_t> page_ids_;
+  std::unordered_map<page_id_t, PageZone> zones_;
+};
+
+#endif  // MINISQL_ZONE_MAP_H
@@ -1,6 +1,7 @@
 #include "index/b_plus_tree.h"
 
 #include <string>
+#include <thread>
 
 #include "glog/logging.h"
 #include "index/basic_comparator.h"
@@ -15,17 +16,28 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
       processor_(KM),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size) {
-  if(leaf_max_size_==UNDEFINED_SIZE){
-    leaf_max_size_=(int)((PAGE_SIZE-LEAF_PAGE_HEADER_SIZE)/(KM.GetKeySize()+sizeof(RowId))-1);
-  }
+  // 叶子的max size由其前缀长度决定，未指定时不另加限制
   if(internal_max_size_==UNDEFINED_SIZE){
     internal_max_size_=(int)((PAGE_SIZE-INTERNAL_PAGE_HEADER_SIZE)/(KM.GetKeySize()+sizeof(page_id_t))-1);
   }
   auto root_page_raw=buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  root_page_raw->RLatch();
   IndexRootsPage *root_page=reinterpret_cast<IndexRootsPage *>(root_page_raw->GetData());
-  root_page->GetRootId(index_id_,&root_page_id_);
+  page_id_t root_page_id=INVALID_PAGE_ID;
+  root_page->GetRootId(index_id_,&root_page_id);
+  root_page_id_=root_page_id;
+  root_page_raw->RUnlatch();
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID,false);
 }
+
+BPlusTree::~BPlusTree() {
+  ReleaseResident();
+}
+
+void BPlusTree::SetResidentLevels(int levels) {
+  ReleaseResident();
+  resident_levels_ = levels;
+}
 /* Destroy */
 void BPlusTree::Destroy(page_id_t current_page_id) {
   if(current_page_id!=INVALID_PAGE_ID){
@@ -37,16 +49,22 @@ void BPlusTree::Destroy(page_id_t current_page_id) {
       }
     }
     buffer_pool_manager_->UnpinPage(current_page_id,false);
+    DropResident(current_page_id);
     buffer_pool_manager_->DeletePage(current_page_id);
   }
   else{
+    LockRoot();
     auto page=buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+    page->WLatch();
     IndexRootsPage *root_page=reinterpret_cast<IndexRootsPage *>(page->GetData());
     root_page->Delete(index_id_);
+    page->WUnlatch();
     buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID,true);
     if(root_page_id_!=INVALID_PAGE_ID){
       Destroy(root_page_id_);
     }
+    root_page_id_=INVALID_PAGE_ID;
+    UnlockRoot();
   }
 }
 /*
@@ -54,10 +72,7 @@ void BPlusTree::Destroy(page_id_t current_page_id) {
  */
 /* IsEmpty */
 bool BPlusTree::IsEmpty() const {
-  if(root_page_id_ == INVALID_PAGE_ID)
-    return true;
-  else
-    return false;
+  return root_page_id_ == INVALID_PAGE_ID;
 }
 
 /*****************************************************************************
@@ -70,44 +85,118 @@ bool BPlusTree::IsEmpty() const {
  */
 /* GetValue */
 bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction) {
-    if(IsEmpty())
-        return false;
-    LeafPage *leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key,root_page_id_)->GetData());
-    if (leaf == nullptr)
-    { // not found
-        return false;
-    }
-    RowId value;
-    bool found = leaf->Lookup(key, value, processor_);
-    // append to result vector
-    if (found)
-        result.push_back(value);
-    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-    return found;
+  if (lookup_mode_ == LookupMode::kOptimistic) {
+    return GetValueOptimistic(key, result);
+  }
+  Page *page = FindLeafPage(key);
+  if (page == nullptr) {  // empty tree
+    return false;
+  }
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  RowId value;
+  bool found = leaf->Lookup(key, value, processor_);
+  // append to result vector
+  if (found)
+    result.push_back(value);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+  return found;
+}
+
+/*
+ * Point query without latches, the leaf is read and then validated against its version
+ */
+bool BPlusTree::GetValueOptimistic(const GenericKey *key, std::vector<RowId> &result) {
+  optimistic_count_++;
+  bool found = false;
+  while (true) {
+    Page *page;
+    uint64_t version;
+    if (DescendOptimistic(key, false, &page, &version)) {
+      if (page == nullptr) {  // empty tree
+        break;
+      }
+      RowId value;
+      found = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, value, processor_);
+      bool valid = page->GetVersion() == version;
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      if (valid) {
+        if (found)
+          result.push_back(value);
+        break;
+      }
+    }
+    // 冲突，让出CPU给持有写锁的线程后从根重试
+    std::this_thread::yield();
+  }
+  if (--optimistic_count_ == 0 && reclaim_count_ > 0) {
+    ReclaimPages();
+  }
+  return found;
 }
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 /*
  * Insert constant key & value pair into b+ tree
- * if current tree is empty, start new tree, update root page id and insert
- * entry, otherwise insert into leaf page.
+ * The leaf is first write latched optimistically, if it is not full the entry goes there directly.
+ * Otherwise the insert retries with write latches from the highest page that may split, starting a new
+ * tree if the tree is empty.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
 /* Insert */
 bool BPlusTree::Insert(GenericKey *key, const RowId &value, Transaction *transaction) {
-  if (IsEmpty()) {
+  return InsertIfAbsent(key, value, transaction);
+}
+
+/* InsertIfAbsent */
+bool BPlusTree::InsertIfAbsent(GenericKey *key, const RowId &value, Transaction *transaction) {
+  RowId existing;
+  Page *page = FindLeafPageOptimistic(key);
+  if (page != nullptr) {
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    bool found = leaf->Lookup(key, existing, processor_);
+    bool safe = !found && IsSafe(leaf, Operation::kInsert);
+    if (safe) {
+      leaf->Insert(key, value, processor_);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), safe);
+    if (found || safe) {
+      return !found;
+    }
+  }
+  // 叶子可能分裂，悲观重试
+  WriteSet write_set;
+  page = FindLeafPagePessimistic(key, Operation::kInsert, &write_set);
+  if (page == nullptr) {
     StartNewTree(key, value);
+    Release(&write_set);
     return true;
   }
-  return InsertIntoLeaf(key,value,transaction);
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (leaf->Lookup(key, existing, processor_)) {
+    Release(&write_set);
+    return false;
+  }
+  if (leaf->Insert(key, value, processor_) > leaf->GetMaxSize()) {
+    // 追加到最右叶子末尾，说明key递增插入
+    bool append = leaf->GetNextPageId() == INVALID_PAGE_ID &&
+                  leaf->CompareKeyAt(leaf->GetSize() - 1, key, processor_) == 0;
+    LeafPage *new_leaf = Split(leaf, append);
+    InsertIntoParent(leaf, new_leaf->GetLowFence(), new_leaf, &write_set, append);
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+  }
+  Release(&write_set);
+  return true;
 }
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then update b+
  * tree's root page id and insert entry directly into leaf page.
+ * The caller holds root_latch_ in write mode.
  */
 /* StartNewTree */
 void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
@@ -117,81 +206,230 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
         throw std::bad_alloc();
     }
     LeafPage *newLeaf = reinterpret_cast<LeafPage *>(newPage->GetData());
-    newLeaf->Init(newPageId, INVALID_PAGE_ID, processor_.GetKeySize(),leaf_max_size_);
+    newLeaf->Init(newPageId, processor_.GetKeySize(),leaf_max_size_);
     newLeaf->Insert(key,value,processor_);
     newLeaf->SetNextPageId(INVALID_PAGE_ID);
     buffer_pool_manager_->UnpinPage(newPageId, true);
     root_page_id_ = newPageId;  // Update the root page id
     UpdateRootPageId(true);
 }
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
 /*
- * Insert constant key & value pair into leaf page
- * User needs to first find the right leaf page as insertion target, then look
- * through leaf page to see whether insert key exist or not. If exist, return
- * immediately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * Build the tree bottom up from entries in increasing key order. The page sizes of every level are planned
+ * from the entry count before the first page is written, so each page is filled once, linked to its parent
+ * (which is filled as its children complete) and unpinned; the next leaf is allocated before a leaf is
+ * finished so that its next page id is known.
  */
-/* InsertIntoLeaf */
-bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction) {
-    LeafPage *leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key,root_page_id_,false)->GetData());
-    assert(leaf != nullptr); // for debug
-
-    // check duplicate
-    RowId value_discard;
-    bool found = leaf->Lookup(key, value_discard, processor_);
-    if (found) {
-        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-        return false;
-    }
-    if (leaf->Insert(key,value,processor_)<=leaf->GetMaxSize()){
-        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true); // dirty now
-    }else{
-        // split leaf page
-        LeafPage *new_leaf = Split(leaf,transaction);
-        InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf,transaction);
-        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
-        buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
-    }
+/* BulkLoad */
+bool BPlusTree::BulkLoad(IndexSorter *sorter, double fill_factor) {
+  if (!IsEmpty()) {
+    return false;
+  }
+  if (sorter->GetSize() == 0) {
     return true;
+  }
+  // 自底向上规划每层的页数，直到某层只有一页
+  std::vector<LoadLevel> levels;
+  int count = static_cast<int>(sorter->GetSize());
+  while (true) {
+    // 叶子按不压缩时的容量规划，写完后按fence压缩，留出的空间给之后的插入
+    int max_size = internal_max_size_;
+    if (levels.empty()) {
+      max_size = LeafPage::MaxSizeFor(processor_.GetKeySize(), 0);
+      if (leaf_max_size_ != UNDEFINED_SIZE) {
+        max_size = std::min(max_size, leaf_max_size_);
+      }
+    }
+    levels.push_back({max_size, BulkLoadPages(count, max_size, fill_factor), count});
+    if (levels.back().pages == 1) {
+      break;
+    }
+    count = levels.back().pages;
+  }
+  std::vector<page_id_t> new_pages;
+  GenericKey *key = processor_.InitKey();
+  GenericKey *prev_key = processor_.InitKey();
+  GenericKey *first_key = processor_.InitKey();
+  RowId value;
+  int size = 0;
+  bool sorted = true;
+  LoadLevel &leaves = levels[0];
+  for (bool first = true; sorter->Next(key, &value); first = false) {
+    if (!first && processor_.CompareKeys(prev_key, key) >= 0) {
+      sorted = false;
+      break;
+    }
+    memcpy(prev_key, key, processor_.GetKeySize());
+    if (leaves.page != nullptr && size == leaves.PageSize(leaves.page_index)) {
+      // 叶子已满，下一个key是它的上界，先分配下一个叶子以写入next page id
+      page_id_t next_page_id = INVALID_PAGE_ID;
+      Page *next_page = buffer_pool_manager_->NewPage(next_page_id);
+      if (next_page == nullptr) {
+        throw std::bad_alloc();
+      }
+      new_pages.push_back(next_page_id);
+      reinterpret_cast<LeafPage *>(next_page->GetData())
+          ->Init(next_page_id, processor_.GetKeySize(), leaf_max_size_);
+      BulkLoadFinishLeaf(&levels, key, next_page_id, first_key, &new_pages);
+      leaves.page = next_page;
+      leaves.page_id = next_page_id;
+      size = 0;
+    }
+    if (leaves.page == nullptr) {
+      leaves.page = buffer_pool_manager_->NewPage(leaves.page_id);
+      if (leaves.page == nullptr) {
+        throw std::bad_alloc();
+      }
+      new_pages.push_back(leaves.page_id);
+      reinterpret_cast<LeafPage *>(leaves.page->GetData())
+          ->Init(leaves.page_id, processor_.GetKeySize(), leaf_max_size_);
+    }
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(leaves.page->GetData());
+    leaf->SetKeyAt(size, key);
+    leaf->SetValueAt(size, value);
+    leaf->SetSize(++size);
+  }
+  if (sorted && leaves.page != nullptr) {
+    BulkLoadFinishLeaf(&levels, nullptr, INVALID_PAGE_ID, first_key, &new_pages);
+  }
+  free(first_key);
+  free(key);
+  free(prev_key);
+  if (!sorted || leaves.page_index != leaves.pages) {
+    // 键重复或无序，丢弃已写的页
+    for (auto &level : levels) {
+      if (level.page != nullptr) {
+        buffer_pool_manager_->UnpinPage(level.page_id, false);
+      }
+    }
+    for (page_id_t page_id : new_pages) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    return false;
+  }
+  LockRoot();
+  root_page_id_ = levels.back().page_id;
+  UnlockRoot();
+  UpdateRootPageId(true);
+  return true;
+}
+
+/* BulkLoadPages */
+int BPlusTree::BulkLoadPages(int count, int max_size, double fill_factor) {
+  int min_size = (max_size + 1) / 2;
+  int capacity = std::max(min_size, std::min(max_size, static_cast<int>(max_size * fill_factor)));
+  int pages = (count + capacity - 1) / capacity;
+  // 平均分配后不足min size时减少页数，此时每页仍不超过max size
+  if (pages > 1 && count / pages < min_size) {
+    pages = std::max(1, count / min_size);
+  }
+  return pages;
+}
+
+/* BulkLoadAppend */
+void BPlusTree::BulkLoadAppend(std::vector<LoadLevel> *levels, size_t level, const GenericKey *key, page_id_t child,
+                                    std::vector<page_id_t> *new_pages) {
+  LoadLevel &load = (*levels)[level];
+  if (load.page == nullptr) {
+    load.page = buffer_pool_manager_->NewPage(load.page_id);
+    if (load.page == nullptr) {
+      throw std::bad_alloc();
+    }
+    new_pages->push_back(load.page_id);
+    reinterpret_cast<InternalPage *>(load.page->GetData())
+        ->Init(load.page_id, processor_.GetKeySize(), internal_max_size_);
+  }
+  InternalPage *node = reinterpret_cast<InternalPage *>(load.page->GetData());
+  int size = node->GetSize();
+  // 第0个key不参与查找，保存子树的最小key供上层使用
+  node->SetKeyAt(size, key);
+  node->SetValueAt(size, child);
+  node->SetSize(size + 1);
+  if (size + 1 == load.PageSize(load.page_index)) {
+    BulkLoadFinishPage(levels, level, new_pages);
+  }
+}
+
+/* BulkLoadFinishLeaf */
+void BPlusTree::BulkLoadFinishLeaf(std::vector<LoadLevel> *levels, const GenericKey *high, page_id_t next_page_id,
+                                   GenericKey *buffer, std::vector<page_id_t> *new_pages) {
+  LoadLevel &leaves = (*levels)[0];
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(leaves.page->GetData());
+  // 第一个叶子的下界是无穷小，其余叶子的下界是父节点中的分隔key，即第一个key
+  leaf->CopyKeyAt(0, buffer);
+  leaf->SetFences(leaves.page_index == 0 ? nullptr : buffer, high);
+  leaf->SetNextPageId(next_page_id);
+  BulkLoadFinishPage(levels, 0, new_pages, buffer);
+}
+
+/* BulkLoadFinishPage */
+void BPlusTree::BulkLoadFinishPage(std::vector<LoadLevel> *levels, size_t level, std::vector<page_id_t> *new_pages,
+                                   const GenericKey *first_key) {
+  LoadLevel &load = (*levels)[level];
+  auto node = reinterpret_cast<BPlusTreePage *>(load.page->GetData());
+  ASSERT(node->GetSize() <= node->GetMaxSize(), "Bulk loaded page overflows.");
+  if (level + 1 < levels->size()) {
+    if (first_key == nullptr) {
+      first_key = reinterpret_cast<InternalPage *>(node)->KeyAt(0);
+    }
+    BulkLoadAppend(levels, level + 1, first_key, load.page_id, new_pages);
+  }
+  buffer_pool_manager_->UnpinPage(load.page_id, true);
+  // 根所在层只有一页，保留其page id
+  load.page = nullptr;
+  load.page_index++;
 }
 
 /*
- * Split input page and return newly created page.
- * Using template N to represent either internal page or leaf page.
+ * Split input page and return newly created page, which stays pinned.
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
- * of key & value pairs from input page to newly created page
+ * of key & value pairs from input page to newly created page.
+ * The new page is only reachable through the write latched input page and its parent.
  */
+/* AppendSplitCount */
+int BPlusTree::AppendSplitCount(int size, int min_count) {
+  int count = size - static_cast<int>(size * INDEX_APPEND_SPLIT_RATIO);
+  return std::min(size - 1, std::max(min_count, count));
+}
+
 /* Split */
-BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Transaction *transaction) {
+BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, bool append) {
   page_id_t newPageId;
   auto page=buffer_pool_manager_->NewPage(newPageId);
-  InternalPage *new_page=reinterpret_cast<InternalPage *>(page->GetData());
   if(page==nullptr){
-    LOG(ERROR)<<"out of memory";
+    throw std::bad_alloc();
+  }
+  InternalPage *new_page=reinterpret_cast<InternalPage *>(page->GetData());
+  new_page->Init(newPageId,node->GetKeySize(),node->GetMaxSize());
+  if (append) {
+    // 右边的新页至少两个孩子，保证每个孩子都有兄弟可以合并
+    node->MoveTailTo(new_page, AppendSplitCount(node->GetSize(), 2));
+  } else {
+    node->MoveHalfTo(new_page);
   }
-  new_page->Init(newPageId,node->GetParentPageId(),node->GetKeySize(),node->GetMaxSize());
-  node->MoveHalfTo(new_page,buffer_pool_manager_);
-  buffer_pool_manager_->UnpinPage(newPageId,true);
-  InsertIntoParent(node,node->KeyAt(node->GetSize()/2),new_page,transaction);
   return new_page;
 }
 
 /* Split */
-BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction) {
+BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, bool append) {
   page_id_t newPageId;
   auto page=buffer_pool_manager_->NewPage(newPageId);
-  LeafPage *new_page=reinterpret_cast<LeafPage *>(page->GetData());
   if(page == nullptr){
-    LOG(ERROR)<<"out of memory";
+    throw std::bad_alloc();
+  }
+  LeafPage *new_page=reinterpret_cast<LeafPage *>(page->GetData());
+  new_page->Init(newPageId,node->GetKeySize(),leaf_max_size_);
+  if (append) {
+    node->MoveTailTo(new_page, AppendSplitCount(node->GetSize(), 1));
+  } else {
+    node->MoveHalfTo(new_page);
   }
-  new_page->Init(newPageId,node->GetParentPageId(),node->GetKeySize(),node->GetMaxSize());
   new_page->SetNextPageId(node->GetNextPageId());
   node->SetNextPageId(newPageId);
-  node->MoveHalfTo(new_page);
-  buffer_pool_manager_->UnpinPage(newPageId,true);
-  InsertIntoParent(node,node->KeyAt(node->GetSize()/2),new_page,transaction);
   return new_page;
 }
 /*
@@ -199,55 +437,34 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction) {
  * @param   old_node      input page from split() method
  * @param   key
  * @param   new_node      returned page from split() method
- * User needs to first find the parent page of old_node, parent node must be
- * adjusted to take info of new_node into account. Remember to deal with split
- * recursively if necessary.
+ * The parent of old_node precedes it in write_set, it is write latched since old_node was not safe. The parent
+ * is split recursively if it overflows, a new root is created (root_latch_ is held) when old_node is the root.
  */
 /* InsertIntoParent */
-void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
-                                 Transaction *transaction) {
-  if(old_node->IsRootPage()){
-    auto newPage=buffer_pool_manager_->NewPage(root_page_id_);
+void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, const GenericKey *key, BPlusTreePage *new_node,
+                                 WriteSet *write_set, bool append) {
+  if(IsRoot(old_node)){
+    ASSERT(write_set->root_latched, "Root changed without root latch.");
+    page_id_t new_root_id;
+    auto newPage=buffer_pool_manager_->NewPage(new_root_id);
+    if(newPage==nullptr){
+      throw std::bad_alloc();
+    }
     InternalPage *newRoot=reinterpret_cast<InternalPage *>(newPage->GetData());
-    newRoot->Init(root_page_id_,INVALID_PAGE_ID,processor_.GetKeySize(),internal_max_size_);
+    newRoot->Init(new_root_id,processor_.GetKeySize(),internal_max_size_);
     newRoot->PopulateNewRoot(old_node->GetPageId(),key,new_node->GetPageId());
-    old_node->SetParentPageId(root_page_id_);
-    new_node->SetParentPageId(root_page_id_);
+    root_page_id_ = new_root_id;
     UpdateRootPageId(0);
-    buffer_pool_manager_->UnpinPage(new_node->GetPageId(),true);
-    buffer_pool_manager_->UnpinPage(newRoot->GetPageId(),true);
+    buffer_pool_manager_->UnpinPage(new_root_id,true);
+    return;
   }
-  else{
-    auto page=buffer_pool_manager_->FetchPage(old_node->GetParentPageId());
-    InternalPage *parent_page=reinterpret_cast<InternalPage *>(page->GetData());
-    if(parent_page->GetSize()<parent_page->GetMaxSize()){
-      parent_page->InsertNodeAfter(old_node->GetPageId(),key,new_node->GetPageId());
-      new_node->SetParentPageId(old_node->GetParentPageId());
-      buffer_pool_manager_->UnpinPage(new_node->GetPageId(),true);
-    }
-    else{
-      auto new_parent=Split(parent_page,transaction);
-      if(processor_.CompareKeys(key,new_parent->KeyAt(0))<0){
-        new_node->SetParentPageId(parent_page->GetPageId());
-        parent_page->InsertNodeAfter(old_node->GetPageId(),key,new_node->GetPageId());
-        buffer_pool_manager_->UnpinPage(new_node->GetPageId(),true);
-      }
-      else if(processor_.CompareKeys(key,new_parent->KeyAt(0))==0){
-        new_node->SetParentPageId(new_parent->GetPageId());
-        new_parent->InsertNodeAfter(old_node->GetPageId(),key,new_node->GetPageId());
-        buffer_pool_manager_->UnpinPage(new_node->GetPageId(),true);
-      }
-      else{
-        new_node->SetParentPageId(new_parent->GetPageId());
-        old_node->SetParentPageId(new_parent->GetPageId());
-        new_parent->InsertNodeAfter(old_node->GetPageId(),key,new_node->GetPageId());
-        buffer_pool_manager_->UnpinPage(new_node->GetPageId(),true);
-        buffer_pool_manager_->UnpinPage(old_node->GetPageId(),true);
-      }
-      InsertIntoParent(parent_page,new_parent->KeyAt(0),new_parent);
-      buffer_pool_manager_->UnpinPage(new_parent->GetPageId(),true);
-    }
-    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(),true);
+  InternalPage *parent=ParentOf(old_node, write_set);
+  if(parent->InsertNodeAfter(old_node->GetPageId(),key,new_node->GetPageId())>parent->GetMaxSize()){
+    // 最右孩子追加分裂时父节点也是所在层的最右页
+    append = append && parent->ValueIndex(new_node->GetPageId()) == parent->GetSize() - 1;
+    InternalPage *new_parent=Split(parent, append);
+    InsertIntoParent(parent,new_parent->KeyAt(0),new_parent,write_set,append);
+    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(),true);
   }
 }
 /*****************************************************************************
@@ -256,236 +473,177 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
 /*
  * Delete key & value pair associated with input key
  * If current tree is empty, return immediately.
- * If not, User needs to first find the right leaf page as deletion target, then
- * delete entry from leaf page. Remember to deal with redistribute or merge if
- * necessary.
+ * The leaf is first write latched optimistically, if it stays above min size the entry is removed there
+ * (separator keys of the parents stay valid bounds). Otherwise the remove retries with write latches from
+ * the highest page that may underflow and redistributes or merges.
  */
 /* Remove */
 void BPlusTree::Remove(const GenericKey *key, Transaction *transaction) {
-    if (IsEmpty()) return;
-    LeafPage *leaf = reinterpret_cast<LeafPage *>(FindLeafPage(key,root_page_id_,false)->GetData());
-    if (leaf == nullptr) return;
-    int index = leaf->KeyIndex(key,processor_);
-    int size_after_delete = leaf->RemoveAndDeleteRecord(key, processor_);
-    if (!leaf->IsRootPage())
-    {
-        auto parent_page=buffer_pool_manager_->FetchPage(leaf->GetParentPageId());
-        while(index==0){
-            InternalPage *parent=reinterpret_cast<InternalPage *>(parent_page->GetData());
-            index=parent->ValueIndex(leaf->GetPageId());
-            if (index==-1) break;
-            if (index!=0)
-            {
-                parent->SetKeyAt(index,leaf->KeyAt(0));
-                buffer_pool_manager_->UnpinPage(parent->GetPageId(),true);
-            }else
-            {
-                if (!parent->IsRootPage())
-                {
-                    parent_page=buffer_pool_manager_->FetchPage(parent->GetParentPageId());
-                    parent=reinterpret_cast<InternalPage *>(parent_page->GetData());
-                }else break;
-
-            }
-        }
-    }
-    bool if_delete=false;
-    if (size_after_delete < leaf->GetMinSize()) {
-        if_delete = CoalesceOrRedistribute(leaf, transaction);
+  RowId value_discard;
+  Page *page = FindLeafPageOptimistic(key);
+  if (page == nullptr) {
+    return;
+  }
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  bool found = leaf->Lookup(key, value_discard, processor_);
+  bool safe = found && IsSafe(leaf, Operation::kRemove);
+  if (safe) {
+    leaf->RemoveAndDeleteRecord(key, processor_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), safe);
+  if (!found || safe) {
+    return;
+  }
+  // 叶子可能下溢，悲观重试
+  WriteSet write_set;
+  page = FindLeafPagePessimistic(key, Operation::kRemove, &write_set);
+  if (page != nullptr) {
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (leaf->RemoveAndDeleteRecord(key, processor_) < MinSize(leaf)) {
+      CoalesceOrRedistribute(leaf, &write_set);
     }
-    //buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+  }
+  Release(&write_set);
 }
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
- * @return: true means target leaf page should be deleted, false means no
- * deletion happens
+ * The parent precedes node in write_set, the sibling (the left one, the right one for the first child)
+ * is write latched here. Merged away pages are queued in write_set for deletion.
  */
 
 /* CoalesceOrRedistribute */
 template <typename N>
-bool BPlusTree::CoalesceOrRedistribute(N *&node, Transaction *transaction) {
-  if(node->IsRootPage()){
-    return AdjustRoot(node);
-  }
-  auto page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
-  InternalPage *parent_page = reinterpret_cast<InternalPage *>(page);
-  if(page == nullptr){
-    LOG(ERROR)<<"out of memory";
-  }
-  int index=parent_page->ValueIndex(node->GetPageId());
-  int siblingIndex = index-1;
-  bool Deletion = false;
-  bool if_delete;
-  if(index == 0){
-    siblingIndex = index+1;
+void BPlusTree::CoalesceOrRedistribute(N *node, WriteSet *write_set) {
+  if(IsRoot(node)){
+    AdjustRoot(node, write_set);
+    return;
   }
-  else{
-    Deletion = true;
-  }
-  N *sibling=reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(parent_page->ValueAt(siblingIndex)));
-  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(),true);
-  if(node->GetSize()+sibling->GetSize()<=node->GetMaxSize()){
-    int remove=parent_page->ValueIndex(node->GetPageId());
-    if_delete=Coalesce(sibling,node,parent_page,remove,transaction);
-    buffer_pool_manager_->UnpinPage(parent_page->ValueAt(siblingIndex),true);
+  InternalPage *parent = ParentOf(node, write_set);
+  int index=parent->ValueIndex(node->GetPageId());
+  int sibling_index = index == 0 ? 1 : index - 1;
+  auto sibling_page = buffer_pool_manager_->FetchPage(parent->ValueAt(sibling_index));
+  sibling_page->WLatch();
+  N *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+  bool can_coalesce = index == 0 ? CanCoalesce(node, sibling) : CanCoalesce(sibling, node);
+  if(can_coalesce){
+    // 总是把右边的页合并到左边
     if(index == 0){
-      buffer_pool_manager_->DeletePage(parent_page->ValueAt(siblingIndex));
+      Coalesce(node, sibling, parent, sibling_index, write_set);
+    } else {
+      Coalesce(sibling, node, parent, index, write_set);
     }
   }
   else{
-    Redistribute(sibling,node,index);
-    buffer_pool_manager_->UnpinPage(sibling->GetPageId(),true);
-  }
-  if(if_delete){
-    buffer_pool_manager_->DeletePage(parent_page->GetPageId());
+    Redistribute(sibling, node, parent, index);
   }
-  return Deletion;
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
 }
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
- * take info of deletion into account. Remember to deal with coalesce or
+ * Whether right fits into left. Leaves are checked with the prefix of the merged range, which can be shorter.
+ */
+bool BPlusTree::CanCoalesce(LeafPage *left, LeafPage *right) const {
+  return left->GetSize() + right->GetSize() <= left->MaxSizeWithFences(left->GetLowFence(), right->GetHighFence());
+}
+
+bool BPlusTree::CanCoalesce(InternalPage *left, InternalPage *right) const {
+  return left->GetSize() + right->GetSize() <= left->GetMaxSize();
+}
+
+/*
+ * Move all the key & value pairs from right to its left sibling and queue right for deletion.
+ * Parent page must be adjusted to take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
- * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
- * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion happened
+ * @param   right_index        index of right in parent
  */
 /* Coalesce */
-bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                         Transaction *transaction) {
-    assert(node->GetSize() + neighbor_node->GetSize() <= node->GetMaxSize());
-    page_id_t nodeId = node->GetPageId();
-    page_id_t neighborId = neighbor_node->GetPageId();
-
-    if (index != 0) { // left sibling
-        node->MoveAllTo(neighbor_node);
-        // remove node from parent
-        buffer_pool_manager_->UnpinPage(nodeId, true);
-        buffer_pool_manager_->DeletePage(nodeId);
-        buffer_pool_manager_->UnpinPage(neighborId, true);
-        parent->Remove(index);
-    } else {
-        neighbor_node->MoveAllTo(node);
-        // remove neighbor from parent
-        buffer_pool_manager_->UnpinPage(nodeId, true);
-        buffer_pool_manager_->UnpinPage(neighborId, true);
-        buffer_pool_manager_->DeletePage(neighborId);
-        parent->Remove(index + 1);
-    }
-
-    if (parent->GetSize() < parent->GetMinSize()) {
-        // recursively if not enough size for parent
-        return CoalesceOrRedistribute(parent, transaction);
-    }
-    return false;
+void BPlusTree::Coalesce(LeafPage *left, LeafPage *right, InternalPage *parent, int right_index,
+                         WriteSet *write_set) {
+  right->MoveAllTo(left);
+  parent->Remove(right_index);
+  write_set->deleted_pages.push_back(right->GetPageId());
+  if (parent->GetSize() < MinSize(parent)) {
+    // recursively if not enough size for parent
+    CoalesceOrRedistribute(parent, write_set);
+  }
 }
-bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                         Transaction *transaction) {
-    assert(node->GetSize() + neighbor_node->GetSize() <= node->GetMaxSize());
-    page_id_t nodeId = node->GetPageId();
-    page_id_t neighborId = neighbor_node->GetPageId();
-
-    if (index != 0) { // left sibling
-        node->MoveAllTo(neighbor_node,parent->KeyAt(index), buffer_pool_manager_);
-        // remove node from parent
-        buffer_pool_manager_->UnpinPage(nodeId, true);
-        buffer_pool_manager_->DeletePage(nodeId);
-        buffer_pool_manager_->UnpinPage(neighborId, true);
-        parent->Remove(index);
-    } else {
-        neighbor_node->MoveAllTo(node,parent->KeyAt(index+1), buffer_pool_manager_);
-        // remove neighbor from parent
-        buffer_pool_manager_->UnpinPage(nodeId, true);
-        buffer_pool_manager_->UnpinPage(neighborId, true);
-        buffer_pool_manager_->DeletePage(neighborId);
-        parent->Remove(index + 1);
-    }
-    if (parent->GetSize() < parent->GetMinSize()) {
-        // recursively if not enough size for parent
-        return CoalesceOrRedistribute(parent, transaction);
-    }
-    return false;
+void BPlusTree::Coalesce(InternalPage *left, InternalPage *right, InternalPage *parent, int right_index,
+                         WriteSet *write_set) {
+  right->MoveAllTo(left, parent->KeyAt(right_index));
+  parent->Remove(right_index);
+  write_set->deleted_pages.push_back(right->GetPageId());
+  if (parent->GetSize() < MinSize(parent)) {
+    // recursively if not enough size for parent
+    CoalesceOrRedistribute(parent, write_set);
+  }
 }
 
 
 /*
- * Redistribute key & value pairs from one page to its sibling page. If index ==
- * 0, move sibling page's first key & value pair into end of input "node",
- * otherwise move sibling page's last key & value pair into head of input
+ * Redistribute key & value pairs from one page to its sibling page until node reaches its min size. If index ==
+ * 0, move sibling page's first key & value pairs into end of input "node",
+ * otherwise move sibling page's last key & value pairs into head of input
  * "node".
- * Using template N to represent either internal page or leaf page.
+ * The two pages do not fit into one, so together they hold more than twice the min size and the sibling keeps
+ * at least the min size. A leaf is refilled to at most its min size, which fits whatever prefix is left.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   index              index of node in parent
  */
 /* Redistribute */
-void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, int index) {
-    page_id_t parentId = node->GetParentPageId();
-    Page *parentPage = buffer_pool_manager_->FetchPage(parentId);
-    InternalPage *parent = reinterpret_cast<InternalPage *>(parentPage->GetData());
-    if (index == 0) { // right sibling
-        neighbor_node->MoveFirstToEndOf(node);
-        // update parent
-        parent->SetKeyAt(index + 1, neighbor_node->KeyAt(0));
-    } else { // left sibling
-        neighbor_node->MoveLastToFrontOf(node);
-        // update parent
-        parent->SetKeyAt(index, node->KeyAt(0));
-    }
-}
-void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, int index) {
-    page_id_t parentId = node->GetParentPageId();
-    Page *parentPage = buffer_pool_manager_->FetchPage(parentId);
-    InternalPage *parent = reinterpret_cast<InternalPage *>(parentPage->GetData());
-    if (index == 0) { // right sibling
-        auto page_index=parent->ValueIndex(neighbor_node->GetPageId());
-        auto key=parent->KeyAt(page_index);
-        neighbor_node->MoveFirstToEndOf(node, key,buffer_pool_manager_);
-        // update parent
-        parent->SetKeyAt(page_index, neighbor_node->KeyAt(0));
-    } else { // left sibling
-        auto page_index=parent->ValueIndex(node->GetPageId());
-        auto key=parent->KeyAt(page_index);
-        neighbor_node->MoveLastToFrontOf(node,key,buffer_pool_manager_);
-        // update parent
-        parent->SetKeyAt(page_index, node->KeyAt(0));
+void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index) {
+    while (node->GetSize() < MinSize(node)) {
+        ASSERT(neighbor_node->GetSize() > MinSize(neighbor_node), "Sibling has no entry to spare.");
+        if (index == 0) { // right sibling
+            neighbor_node->MoveFirstToEndOf(node);
+            // update parent
+            parent->SetKeyAt(1, neighbor_node->GetLowFence());
+        } else { // left sibling
+            neighbor_node->MoveLastToFrontOf(node);
+            // update parent
+            parent->SetKeyAt(index, node->GetLowFence());
+        }
+    }
+}
+void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index) {
+    while (node->GetSize() < MinSize(node)) {
+        ASSERT(neighbor_node->GetSize() > MinSize(neighbor_node), "Sibling has no entry to spare.");
+        if (index == 0) { // right sibling
+            neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1));
+            // update parent
+            parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+        } else { // left sibling
+            neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index));
+            // update parent
+            parent->SetKeyAt(index, node->KeyAt(0));
+        }
     }
 }
 /*
- * Update root page if necessary
+ * Update root page if necessary, root_latch_ is held in write mode
  * NOTE: size of root page can be less than min size and this method is only
  * called within coalesceOrRedistribute() method
  * case 1: when you delete the last element in root page, but root page still
  * has one last child
  * case 2: when you delete the last element in whole b+ tree
- * @return : true means root page should be deleted, false means no deletion
- * happened
  */
 /* AdjustRoot */
-bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
+void BPlusTree::AdjustRoot(BPlusTreePage *old_root_node, WriteSet *write_set) {
+    ASSERT(write_set->root_latched, "Root changed without root latch.");
     if (old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
         root_page_id_ = INVALID_PAGE_ID;
         UpdateRootPageId();
-        buffer_pool_manager_->UnpinPage(old_root_node->GetPageId(), true);
-        buffer_pool_manager_->DeletePage(old_root_node->GetPageId());
-        return true;
-    }else if (old_root_node->GetSize() == 1){
+        write_set->deleted_pages.push_back(old_root_node->GetPageId());
+    } else if (!old_root_node->IsLeafPage() && old_root_node->GetSize() == 1) {
         InternalPage *old_root = static_cast<InternalPage *>(old_root_node);
         root_page_id_ = old_root->RemoveAndReturnOnlyChild();
         UpdateRootPageId();
-        Page *new_root_page = buffer_pool_manager_->FetchPage(root_page_id_);
-        BPlusTreePage *new_root = reinterpret_cast<BPlusTreePage *>(new_root_page->GetData());
-        new_root->SetParentPageId(INVALID_PAGE_ID);
-        buffer_pool_manager_->UnpinPage(root_page_id_, true);
-        buffer_pool_manager_->UnpinPage(old_root_node->GetPageId(), true);
-        buffer_pool_manager_->DeletePage(old_root_node->GetPageId());
-        return true;
+        write_set->deleted_pages.push_back(old_root_node->GetPageId());
     }
-    return false;
 }
 /*****************************************************************************
  * INDEX ITERATOR
@@ -496,15 +654,7 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin() {
-    GenericKey *key;
-    Page *page=FindLeafPage(key,INVALID_PAGE_ID,true);
-    auto leaf_page=reinterpret_cast<LeafPage *>(page->GetData());
-    page_id_t leaf_id=leaf_page->GetPageId();
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(),false);
-    if(leaf_page->GetSize()==0)
-        return IndexIterator(INVALID_PAGE_ID, buffer_pool_manager_);
-    else
-        return IndexIterator(leaf_id, buffer_pool_manager_);
+  return IndexIterator(this, nullptr, true, nullptr, true);
 }
 /*
  * Input parameter is low-key, find the leaf page that contains the input key
@@ -513,15 +663,12 @@ IndexIterator BPlusTree::Begin() {
  */
 /*begin*/
 IndexIterator BPlusTree::Begin(const GenericKey *key) {
-    auto leafpage=FindLeafPage(key,INVALID_PAGE_ID,false);
-    LeafPage *leaf_page = reinterpret_cast<LeafPage *>(leafpage->GetData());
-    page_id_t leaf_id=leaf_page->GetPageId();
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(),false);
-    RowId value;
-    if(leaf_page->Lookup(key,value,processor_))
-        return IndexIterator(leaf_id,buffer_pool_manager_,leaf_page->KeyIndex(key,processor_));
-    else
-        return IndexIterator(INVALID_PAGE_ID,buffer_pool_manager_);
+  return IndexIterator(this, key, true, nullptr, true);
+}
+
+IndexIterator BPlusTree::Begin(const GenericKey *low, bool low_inclusive, const GenericKey *high,
+                               bool high_inclusive) {
+  return IndexIterator(this, low, low_inclusive, high, high_inclusive);
 }
 
 /*
@@ -530,18 +677,7 @@ IndexIterator BPlusTree::Begin(const GenericKey *key) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::End() {
-//  return IndexIterator();
-    Page *page = FindLeafPage(nullptr,INVALID_PAGE_ID,true);
-    LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
-    buffer_pool_manager_->UnpinPage(leaf->GetPageId(),false);
-
-    while(leaf->GetNextPageId()!=INVALID_PAGE_ID){
-        page_id_t nextpage=leaf->GetNextPageId();
-        buffer_pool_manager_->UnpinPage(leaf->GetPageId(),false);
-        Page *next_page=buffer_pool_manager_->FetchPage(nextpage);
-        leaf=reinterpret_cast<LeafPage *>(next_page->GetData());
-    }
-    return IndexIterator(leaf->GetPageId(),buffer_pool_manager_,leaf->GetSize());
+  return IndexIterator();
 }
 /*****************************************************************************
  * UTILITIES AND DEBUG
@@ -549,32 +685,308 @@ IndexIterator BPlusTree::End() {
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
- * Note: the leaf page is pinned, you need to unpin it after use.
+ * Pages are read latched top-down, the parent is released once the child is latched.
+ * Note: the leaf page is pinned and read latched, you need to unlatch and unpin it after use.
  */
-Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool leftMost) {
-    if (IsEmpty()) {
-        LOG(ERROR)<<"empty leaf page";
+Page *BPlusTree::FindLeafPage(const GenericKey *key, bool leftMost) {
+    root_latch_.RLock();
+    if (root_page_id_ == INVALID_PAGE_ID) {
+        root_latch_.RUnlock();
         return nullptr;
     }
-    Page *page;
-    if(page_id==INVALID_PAGE_ID){
-        page=buffer_pool_manager_->FetchPage(root_page_id_);
-    }
-    else{
-        page=buffer_pool_manager_->FetchPage(page_id) ;
-    }
+    Page *page = FetchNode(root_page_id_, 0);
+    page->RLatch();
+    root_latch_.RUnlock();
     BPlusTreePage *node = reinterpret_cast<BPlusTreePage*>(page->GetData());
 
-    while (!node->IsLeafPage()) {
+    for (int depth = 0; !node->IsLeafPage(); depth++) {
         InternalPage *internal_node = reinterpret_cast<InternalPage *>(node);
         page_id_t next_page_id = leftMost ? internal_node->ValueAt(0) : internal_node->Lookup(key,processor_);
-        Page* next_page = buffer_pool_manager_->FetchPage(next_page_id);
-        BPlusTreePage * next_node = reinterpret_cast<BPlusTreePage*>(next_page->GetData());
-        buffer_pool_manager_->UnpinPage(node->GetPageId(), false);
+        Page* next_page = FetchNode(next_page_id, depth + 1);
+        next_page->RLatch();
+        page->RUnlatch();
+        UnpinNode(page, depth);
         page = next_page;
-        node = next_node;
+        node = reinterpret_cast<BPlusTreePage*>(page->GetData());
+    }
+    return page;
+}
+
+/*
+ * Like FindLeafPage, but the leaf is write latched. The page type never changes while a page is reachable,
+ * so it is read before latching to choose the latch mode. In optimistic mode the inner pages are not latched.
+ */
+Page *BPlusTree::FindLeafPageOptimistic(const GenericKey *key) {
+  if (lookup_mode_ == LookupMode::kOptimistic) {
+    optimistic_count_++;
+    Page *page;
+    uint64_t version;
+    while (!DescendOptimistic(key, true, &page, &version)) {
+      std::this_thread::yield();
+    }
+    if (--optimistic_count_ == 0 && reclaim_count_ > 0) {
+      ReclaimPages();
+    }
+    return page;
+  }
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = FetchNode(root_page_id_, 0);
+  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (node->IsLeafPage()) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  root_latch_.RUnlock();
+  for (int depth = 0; !node->IsLeafPage(); depth++) {
+    InternalPage *internal_node = reinterpret_cast<InternalPage *>(node);
+    Page *next_page = FetchNode(internal_node->Lookup(key, processor_), depth + 1);
+    BPlusTreePage *next_node = reinterpret_cast<BPlusTreePage *>(next_page->GetData());
+    if (next_node->IsLeafPage()) {
+      next_page->WLatch();
+    } else {
+      next_page->RLatch();
+    }
+    page->RUnlatch();
+    UnpinNode(page, depth);
+    page = next_page;
+    node = next_node;
+  }
+  return page;
+}
+
+/*
+ * Write latch the path to the leaf with root_latch_ held in write mode at first. Whenever a page is safe for
+ * op, nothing above it can change and the latches above it are released.
+ * @return the leaf, nullptr if the tree is empty (root_latch_ stays held)
+ */
+Page *BPlusTree::FindLeafPagePessimistic(const GenericKey *key, Operation op, WriteSet *write_set) {
+  LockRoot();
+  write_set->root_latched = true;
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    page->WLatch();
+    write_set->pages.push_back(page);
+    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, op)) {
+      ReleaseAncestors(write_set);
+    }
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, processor_);
+  }
+}
+
+bool BPlusTree::IsSafe(BPlusTreePage *node, Operation op) const {
+  if (op == Operation::kInsert) {
+    return node->GetSize() < node->GetMaxSize();
+  }
+  return node->GetSize() > MinSize(node);
+}
+
+int BPlusTree::MinSize(const BPlusTreePage *node) const {
+  // 根的最小值为叶子1、内部节点2
+  if (IsRoot(node)) {
+    return node->IsLeafPage() ? 1 : 2;
+  }
+  // 叶子的最小值不随前缀变化
+  return node->IsLeafPage() ? reinterpret_cast<const LeafPage *>(node)->GetMinSize() : node->GetMinSize();
+}
+
+InternalPage *BPlusTree::ParentOf(const BPlusTreePage *node, WriteSet *write_set) const {
+  auto &pages = write_set->pages;
+  for (size_t i = 1; i < pages.size(); i++) {
+    if (pages[i]->GetPageId() == node->GetPageId()) {
+      return reinterpret_cast<InternalPage *>(pages[i - 1]->GetData());
+    }
+  }
+  ASSERT(false, "Parent is not write latched.");
+  return nullptr;
+}
+
+void BPlusTree::ReleaseAncestors(WriteSet *write_set) {
+  if (write_set->root_latched) {
+    UnlockRoot();
+    write_set->root_latched = false;
+  }
+  Page *last = write_set->pages.back();
+  write_set->pages.pop_back();
+  for (auto page : write_set->pages) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  write_set->pages.assign(1, last);
+}
+
+void BPlusTree::Release(WriteSet *write_set) {
+  if (write_set->root_latched) {
+    UnlockRoot();
+    write_set->root_latched = false;
+  }
+  for (auto page : write_set->pages) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  write_set->pages.clear();
+  if (!write_set->deleted_pages.empty()) {
+    FreePages(write_set->deleted_pages);
+    write_set->deleted_pages.clear();
+  }
+}
+
+bool BPlusTree::DescendOptimistic(const GenericKey *key, bool latch_leaf, Page **leaf_page, uint64_t *leaf_version) {
+  uint64_t parent_version = root_version_;
+  if (parent_version & 1) {
+    return false;
+  }
+  page_id_t page_id = root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    *leaf_page = nullptr;
+    return root_version_ == parent_version;
+  }
+  Page *parent = nullptr;  // nullptr: the page is the root, validated by root_version_
+  for (int depth = 0;; depth++) {
+    Page *page = FetchNode(page_id, depth);
+    if (page == nullptr) {
+      if (parent != nullptr)
+        UnpinNode(parent, depth - 1);
+      return false;
+    }
+    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    bool latched = latch_leaf && node->IsLeafPage();
+    if (latched) {
+      page->WLatch();
     }
+    uint64_t version = page->GetVersion();
+    // 父节点未变，说明读到的子页号有效且该页仍挂在树上
+    bool valid = (latched || (version & 1) == 0) &&
+                 (parent == nullptr ? root_version_ == parent_version : parent->GetVersion() == parent_version);
+    if (parent != nullptr)
+      UnpinNode(parent, depth - 1);
+    if (!valid) {
+      if (latched)
+        page->WUnlatch();
+      UnpinNode(page, depth);
+      return false;
+    }
+    if (node->IsLeafPage()) {
+      *leaf_page = page;
+      *leaf_version = version;
+      return true;
+    }
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, processor_);
+    // 读到的页号可能已被并发修改，先验证再去取页
+    if (page->GetVersion() != version) {
+      UnpinNode(page, depth);
+      return false;
+    }
+    parent = page;
+    parent_version = version;
+  }
+}
+
+/*
+ * Leaves are never resident, the callers of the descents unpin them. A page read without a latch (optimistic
+ * lookups) may be stale, it is pinned all the same and is only deleted after the traversal.
+ */
+Page *BPlusTree::FetchNode(page_id_t page_id, int depth) {
+  if (depth >= resident_levels_) {
+    return buffer_pool_manager_->FetchPage(page_id);
+  }
+  {
+    std::shared_lock<std::shared_mutex> guard(resident_latch_);
+    auto it = resident_pages_.find(page_id);
+    if (it != resident_pages_.end()) {
+      return it->second;
+    }
+  }
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr || reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
     return page;
+  }
+  bool inserted;
+  {
+    std::unique_lock<std::shared_mutex> guard(resident_latch_);
+    inserted = resident_pages_.emplace(page_id, page).second;
+  }
+  // 并发的查找已经让它常驻，多出的pin还回去
+  if (!inserted) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+  return page;
+}
+
+void BPlusTree::UnpinNode(Page *page, int depth) {
+  if (depth < resident_levels_ && !reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    return;
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+}
+
+void BPlusTree::DropResident(page_id_t page_id) {
+  bool resident;
+  {
+    std::unique_lock<std::shared_mutex> guard(resident_latch_);
+    resident = resident_pages_.erase(page_id) > 0;
+  }
+  if (resident) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+}
+
+void BPlusTree::ReleaseResident() {
+  std::unique_lock<std::shared_mutex> guard(resident_latch_);
+  for (auto &entry : resident_pages_) {
+    buffer_pool_manager_->UnpinPage(entry.first, false);
+  }
+  resident_pages_.clear();
+}
+
+void BPlusTree::LockRoot() {
+  root_latch_.WLock();
+  root_version_++;
+}
+
+void BPlusTree::UnlockRoot() {
+  root_version_++;
+  root_latch_.WUnlock();
+}
+
+void BPlusTree::FreePages(const std::vector<page_id_t> &page_ids) {
+  {
+    std::lock_guard<std::mutex> guard(reclaim_latch_);
+    reclaim_pages_.insert(reclaim_pages_.end(), page_ids.begin(), page_ids.end());
+    reclaim_count_ = reclaim_pages_.size();
+  }
+  if (optimistic_count_ == 0) {
+    ReclaimPages();
+  }
+}
+
+/*
+ * The pages were unlinked before they were queued, a traversal starting later cannot reach them. So they are
+ * safe to delete once no traversal is in flight, checked again under the latch.
+ */
+void BPlusTree::ReclaimPages() {
+  std::lock_guard<std::mutex> guard(reclaim_latch_);
+  if (optimistic_count_ != 0) {
+    return;
+  }
+  for (auto page_id : reclaim_pages_) {
+    DropResident(page_id);
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  reclaim_pages_.clear();
+  reclaim_count_ = 0;
 }
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
@@ -583,15 +995,19 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
  * @parameter: insert_record      default value is false. When set to true,
  * insert a record <index_name, current_page_id> into header page instead of
  * updating it.
+ * The roots page is shared by all indexes, so it is write latched.
  */
 /* UpdateRootPageId */
 void BPlusTree::UpdateRootPageId(int insert_record) {
-    IndexRootsPage *root_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+    Page *page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+    page->WLatch();
+    IndexRootsPage *root_page = reinterpret_cast<IndexRootsPage *>(page->GetData());
     if (insert_record) {
         root_page->Insert(index_id_, root_page_id_);
     } else {
         root_page->Update(index_id_, root_page_id_);
     }
+    page->WUnlatch();
     buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 /**
@@ -609,14 +1025,13 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
     // Print data of the node
     out << "label=<<TABLE BORDER=\"0\" CELLBORDER=\"1\" CELLSPACING=\"0\" CELLPADDING=\"4\">\n";
     // Print data
-    out << "<TR><TD COLSPAN=\"" << leaf->GetSize() << "\">P=" << leaf->GetPageId()
-        << ",Parent=" << leaf->GetParentPageId() << "</TD></TR>\n";
+    out << "<TR><TD COLSPAN=\"" << leaf->GetSize() << "\">P=" << leaf->GetPageId() << "</TD></TR>\n";
     out << "<TR><TD COLSPAN=\"" << leaf->GetSize() << "\">"
-        << "max_size=" << leaf->GetMaxSize() << ",min_size=" << leaf->GetMinSize() << ",size=" << leaf->GetSize()
+        << "max_size=" << leaf->GetMaxSize() << ",min_size=" << MinSize(leaf) << ",size=" << leaf->GetSize()
         << "</TD></TR>\n";
     out << "<TR>";
     for (int i = 0; i < leaf->GetSize(); i++) {
-      out << "<TD>" << leaf->KeyAt(i) << "</TD>\n";
+      out << "<TD>" << leaf->ValueAt(i).Get() << "</TD>\n";
     }
     out << "</TR>";
     // Print table end
@@ -626,12 +1041,6 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
       out << leaf_prefix << leaf->GetPageId() << " -> " << leaf_prefix << leaf->GetNextPageId() << ";\n";
       out << "{rank=same " << leaf_prefix << leaf->GetPageId() << " " << leaf_prefix << leaf->GetNextPageId() << "};\n";
     }
-
-    // Print parent links if there is a parent
-    if (leaf->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << leaf->GetParentPageId() << ":p" << leaf->GetPageId() << " -> " << leaf_prefix
-          << leaf->GetPageId() << ";\n";
-    }
   } else {
     auto *inner = reinterpret_cast<InternalPage *>(page);
     // Print node name
@@ -641,10 +1050,9 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
     // Print data of the node
     out << "label=<<TABLE BORDER=\"0\" CELLBORDER=\"1\" CELLSPACING=\"0\" CELLPADDING=\"4\">\n";
     // Print data
-    out << "<TR><TD COLSPAN=\"" << inner->GetSize() << "\">P=" << inner->GetPageId()
-        << ",Parent=" << inner->GetParentPageId() << "</TD></TR>\n";
+    out << "<TR><TD COLSPAN=\"" << inner->GetSize() << "\">P=" << inner->GetPageId() << "</TD></TR>\n";
     out << "<TR><TD COLSPAN=\"" << inner->GetSize() << "\">"
-        << "max_size=" << inner->GetMaxSize() << ",min_size=" << inner->GetMinSize() << ",size=" << inner->GetSize()
+        << "max_size=" << inner->GetMaxSize() << ",min_size=" << MinSize(inner) << ",size=" << inner->GetSize()
         << "</TD></TR>\n";
     out << "<TR>";
     for (int i = 0; i < inner->GetSize(); i++) {
@@ -659,14 +1067,12 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
     out << "</TR>";
     // Print table end
     out << "</TABLE>>];\n";
-    // Print Parent link
-    if (inner->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << inner->GetParentPageId() << ":p" << inner->GetPageId() << " -> " << internal_prefix
-          << inner->GetPageId() << ";\n";
-    }
     // Print leaves
     for (int i = 0; i < inner->GetSize(); i++) {
       auto child_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i))->GetData());
+      // Print child link
+      out << internal_prefix << inner->GetPageId() << ":p" << inner->ValueAt(i) << " -> "
+          << (child_page->IsLeafPage() ? leaf_prefix : internal_prefix) << inner->ValueAt(i) << ";\n";
       ToGraph(child_page, bpm, out);
       if (i > 0) {
         auto sibling_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i - 1))->GetData());
@@ -687,16 +1093,15 @@ void BPlusTree::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstre
 void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
   if (page->IsLeafPage()) {
     auto *leaf = reinterpret_cast<LeafPage *>(page);
-    std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
-              << " next: " << leaf->GetNextPageId() << std::endl;
+    std::cout << "Leaf Page: " << leaf->GetPageId() << " next: " << leaf->GetNextPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
-      std::cout << leaf->KeyAt(i) << ",";
+      std::cout << leaf->ValueAt(i).Get() << ",";
     }
     std::cout << std::endl;
     std::cout << std::endl;
   } else {
     auto *internal = reinterpret_cast<InternalPage *>(page);
-    std::cout << "Internal Page: " << internal->GetPageId() << " parent: " << internal->GetParentPageId() << std::endl;
+    std::cout << "Internal Page: " << internal->GetPageId() << std::endl;
     for (int i = 0; i < internal->GetSize(); i++) {
       std::cout << internal->KeyAt(i) << ": " << internal->ValueAt(i) << ",";
     }
@@ -710,9 +1115,10 @@ void BPlusTree::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
 }
 
 bool BPlusTree::Check() {
+  ReleaseResident();
   bool all_unpinned = buffer_pool_manager_->CheckAllUnpinned();
   if (!all_unpinned) {
     LOG(ERROR) << "problem in page unpin" << endl;
   }
   return all_unpinned;
-}
\ No newline at end of file
+}
@@ -1,28 +1,39 @@
-#include <algorithm>
 #include "index/b_plus_tree_index.h"
 
+#include <algorithm>
+
 #include "index/generic_key.h"
+#include "index/index_sorter.h"
+#include "storage/table_heap.h"
 #include "utils/tree_file_mgr.h"
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
+                               BufferPoolManager *buffer_pool_manager, bool unique, uint32_t include_count)
     : Index(index_id, key_schema),
-      processor_(key_schema_, key_size),
+      unique_(unique),
+      processor_(key_schema_, key_size, !unique, include_count),
       container_(index_id, buffer_pool_manager, processor_) {}
 
 dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  return InsertEntryIfAbsent(key, row_id, txn) == DB_SUCCESS ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t BPlusTreeIndex::InsertEntryIfAbsent(const Row &key, RowId row_id, Transaction *txn) {
   // ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (!unique_) {
+    processor_.SetRowId(index_key, row_id);
+  }
 
-  bool status = container_.Insert(index_key, row_id, txn);
-  delete index_key;
+  bool status = container_.InsertIfAbsent(index_key, row_id, txn);
+  free(index_key);
   //  TreeFileManagers mgr("tree_");
   //  static int i = 0;
   //  if (i % 10 == 0) container_.PrintTree(mgr[i]);
   //  i++;
 
   if (!status) {
-    return DB_FAILED;
+    return DB_ALREADY_EXIST;
   }
   return DB_SUCCESS;
 }
@@ -30,52 +41,99 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *t
 dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
   GenericKey *index_key = processor_.InitKey();
   processor_.SerializeFromKey(index_key, key, key_schema_);
-
-  container_.Remove(index_key, txn);
-  delete index_key;
-  return DB_SUCCESS;
+  dberr_t result = DB_SUCCESS;
+  if (!unique_) {
+    processor_.SetRowId(index_key, row_id);
+    container_.Remove(index_key, txn);
+  } else {
+    // 只删除指向row_id的entry
+    vector<RowId> found;
+    if (container_.GetValue(index_key, found, txn) && found.back() == row_id) {
+      container_.Remove(index_key, txn);
+    } else {
+      result = DB_KEY_NOT_FOUND;
+    }
+  }
+  free(index_key);
+  return result;
 }
 
 dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn, string compare_operator) {
-  GenericKey *index_key = processor_.InitKey();
-  processor_.SerializeFromKey(index_key, key, key_schema_);
-  if (compare_operator == "=") {
+  if (compare_operator == "=" && unique_) {
+    GenericKey *index_key = processor_.InitKey();
+    processor_.SerializeKeyColumns(index_key, key, key_schema_);
     container_.GetValue(index_key, result, txn);
-  } else if (compare_operator == ">") {
-    auto iter = GetBeginIterator(index_key);
-    if (container_.GetValue(index_key, result, txn))
-      ++iter;
-    for (; iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-  } else if (compare_operator == ">=") {
-    for (auto iter = GetBeginIterator(index_key); iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-  } else if (compare_operator == "<") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
-      result.emplace_back((*iter).second);
+    free(index_key);
+  } else {
+    // 比较运算转成区间，<>是key两侧的两个区间
+    auto collect = [&](const Row *low, bool low_inclusive, const Row *high, bool high_inclusive) {
+      for (auto iter = GetRangeIterator(low, low_inclusive, high, high_inclusive); iter != GetEndIterator(); ++iter) {
+        result.emplace_back((*iter).second);
+      }
+    };
+    if (compare_operator == "=") {
+      collect(&key, true, &key, true);
+    } else if (compare_operator == ">") {
+      collect(&key, false, nullptr, false);
+    } else if (compare_operator == ">=") {
+      collect(&key, true, nullptr, false);
+    } else if (compare_operator == "<") {
+      collect(nullptr, false, &key, false);
+    } else if (compare_operator == "<=") {
+      collect(nullptr, false, &key, true);
+    } else if (compare_operator == "<>") {
+      collect(nullptr, false, &key, false);
+      collect(&key, false, nullptr, false);
     }
-  } else if (compare_operator == "<=") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-    container_.GetValue(index_key, result, txn);
-  } else if (compare_operator == "<>") {
-    for (auto iter = GetBeginIterator(); iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-    vector<RowId> temp;
-    if (container_.GetValue(index_key, temp, txn))
-      result.erase(find(result.begin(), result.end(), temp[0]));
   }
-  delete index_key;
   if (!result.empty())
     return DB_SUCCESS;
   else
     return DB_KEY_NOT_FOUND;
 }
 
+IndexIterator BPlusTreeIndex::GetRangeIterator(const Row *low, bool low_inclusive, const Row *high,
+                                               bool high_inclusive) {
+  GenericKey *low_key = nullptr, *high_key = nullptr;
+  // 边界未给出的列和非唯一索引的RowId后缀用最小/最大值填充，区间包含或排除以这些列开头的全部entry
+  if (low != nullptr) {
+    low_key = processor_.InitKey();
+    processor_.SerializeBound(low_key, *low, key_schema_, !low_inclusive);
+  }
+  if (high != nullptr) {
+    high_key = processor_.InitKey();
+    processor_.SerializeBound(high_key, *high, key_schema_, high_inclusive);
+  }
+  auto iter = container_.Begin(low_key, low_inclusive, high_key, high_inclusive);
+  free(low_key);
+  free(high_key);
+  return iter;
+}
+
+dberr_t BPlusTreeIndex::BulkLoad(TableHeap *table_heap, const std::vector<uint32_t> &key_map, Transaction *txn) {
+  // 只解码key列，投影列需升序
+  std::vector<uint32_t> column_ids(key_map);
+  std::sort(column_ids.begin(), column_ids.end());
+  column_ids.erase(std::unique(column_ids.begin(), column_ids.end()), column_ids.end());
+  IndexSorter sorter(container_.GetBufferPoolManager(), processor_);
+  GenericKey *index_key = processor_.InitKey();
+  std::vector<Field> fields;
+  for (auto iter = table_heap->Begin(txn, &column_ids); iter != table_heap->End(); ++iter) {
+    fields.clear();
+    for (uint32_t column_id : key_map) {
+      fields.push_back(*iter->GetField(column_id));
+    }
+    processor_.SerializeFromKey(index_key, Row(fields), key_schema_);
+    if (!unique_) {
+      processor_.SetRowId(index_key, iter->GetRowId());
+    }
+    sorter.Add(index_key, iter->GetRowId());
+  }
+  free(index_key);
+  sorter.Finish();
+  return container_.BulkLoad(&sorter) ? DB_SUCCESS : DB_FAILED;
+}
+
 dberr_t BPlusTreeIndex::Destroy() {
   container_.Destroy();
   return DB_SUCCESS;
@@ -0,0 +1,77 @@
+#include "index/extendible_hash_index.h"
+
+#include <algorithm>
+
+#include "storage/table_heap.h"
+
+ExtendibleHashIndex::ExtendibleHashIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
+                                         BufferPoolManager *buffer_pool_manager, bool unique, uint32_t include_count)
+    : Index(index_id, key_schema),
+      unique_(unique),
+      processor_(key_schema_, key_size, !unique, include_count),
+      container_(index_id, buffer_pool_manager, processor_) {}
+
+dberr_t ExtendibleHashIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  return InsertEntryIfAbsent(key, row_id, txn) == DB_SUCCESS ? DB_SUCCESS : DB_FAILED;
+}
+
+dberr_t ExtendibleHashIndex::InsertEntryIfAbsent(const Row &key, RowId row_id, Transaction *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (!unique_) {
+    processor_.SetRowId(index_key, row_id);
+  }
+  // 桶里查重和插入在同一次加锁中完成
+  bool status = container_.Insert(index_key, row_id, txn);
+  free(index_key);
+  return status ? DB_SUCCESS : DB_ALREADY_EXIST;
+}
+
+dberr_t ExtendibleHashIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (!unique_) {
+    processor_.SetRowId(index_key, row_id);
+  }
+  // 只删除指向row_id的entry
+  bool status = container_.Remove(index_key, row_id, txn);
+  free(index_key);
+  return status ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+dberr_t ExtendibleHashIndex::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn,
+                                     string compare_operator) {
+  if (compare_operator != "=") {
+    return DB_FAILED;
+  }
+  GenericKey *index_key = processor_.InitKey();
+  processor_.SerializeKeyColumns(index_key, key, key_schema_);
+  bool found = container_.GetValue(index_key, result, txn);
+  free(index_key);
+  return found ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+dberr_t ExtendibleHashIndex::BulkLoad(TableHeap *table_heap, const std::vector<uint32_t> &key_map,
+                                      Transaction *txn) {
+  // 只解码key列，投影列需升序
+  std::vector<uint32_t> column_ids(key_map);
+  std::sort(column_ids.begin(), column_ids.end());
+  column_ids.erase(std::unique(column_ids.begin(), column_ids.end()), column_ids.end());
+  std::vector<Field> fields;
+  for (auto iter = table_heap->Begin(txn, &column_ids); iter != table_heap->End(); ++iter) {
+    fields.clear();
+    for (uint32_t column_id : key_map) {
+      fields.push_back(*iter->GetField(column_id));
+    }
+    if (InsertEntry(Row(fields), iter->GetRowId(), txn) != DB_SUCCESS) {
+      container_.Destroy();
+      return DB_FAILED;
+    }
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ExtendibleHashIndex::Destroy() {
+  container_.Destroy();
+  return DB_SUCCESS;
+}
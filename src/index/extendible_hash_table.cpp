@@ -0,0 +1,441 @@
+#include "index/extendible_hash_table.h"
+
+#include <set>
+
+#include "glog/logging.h"
+#include "page/index_roots_page.h"
+
+ExtendibleHashTable::ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager,
+                                         const KeyManager &KM)
+    : index_id_(index_id),
+      buffer_pool_manager_(buffer_pool_manager),
+      processor_(KM),
+      key_size_(KM.GetKeySize()),
+      directory_page_id_(INVALID_PAGE_ID) {
+  ASSERT(HashTableBucketPage::Capacity(key_size_) >= 2, "Hash key too large.");
+  auto page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  page->RLatch();
+  auto roots_page = reinterpret_cast<IndexRootsPage *>(page->GetData());
+  roots_page->GetRootId(index_id_, &directory_page_id_);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+}
+
+HashTableDirectoryPage *ExtendibleHashTable::FetchDirectory() {
+  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
+}
+
+std::vector<page_id_t> ExtendibleHashTable::ChainPageIds(Page *primary) {
+  std::vector<page_id_t> page_ids{primary->GetPageId()};
+  page_id_t next_page_id = AsBucket(primary)->GetNextPageId();
+  while (next_page_id != INVALID_PAGE_ID) {
+    page_ids.push_back(next_page_id);
+    auto page = buffer_pool_manager_->FetchPage(next_page_id);
+    next_page_id = AsBucket(page)->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_ids.back(), false);
+  }
+  return page_ids;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+bool ExtendibleHashTable::GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *) {
+  table_latch_.RLock();
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    table_latch_.RUnlock();
+    return false;
+  }
+  auto directory = FetchDirectory();
+  page_id_t bucket_page_id = directory->GetBucketPageId(KeyToIndex(key, directory));
+  Page *primary = buffer_pool_manager_->FetchPage(bucket_page_id);
+  primary->RLatch();
+  bool found = false;
+  Page *page = primary;
+  while (true) {
+    auto bucket = AsBucket(page);
+    for (uint32_t i = 0; i < bucket->GetSize(); i++) {
+      if (processor_.CompareColumns(bucket->KeyAt(i, key_size_), key) == 0) {
+        result.push_back(bucket->ValueAt(i, key_size_));
+        found = true;
+      }
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    if (page != primary) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page = buffer_pool_manager_->FetchPage(next_page_id);
+  }
+  primary->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+bool ExtendibleHashTable::Insert(const GenericKey *key, const RowId &value, Transaction *) {
+  // 桶内有空位时只需共享的表锁和桶页的写锁
+  table_latch_.RLock();
+  if (directory_page_id_ != INVALID_PAGE_ID) {
+    auto directory = FetchDirectory();
+    page_id_t bucket_page_id = directory->GetBucketPageId(KeyToIndex(key, directory));
+    Page *primary = buffer_pool_manager_->FetchPage(bucket_page_id);
+    primary->WLatch();
+    InsertResult result = InsertIntoChain(primary, key, value, false);
+    primary->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, result == InsertResult::kInserted);
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+    if (result != InsertResult::kFull) {
+      table_latch_.RUnlock();
+      return result == InsertResult::kInserted;
+    }
+  }
+  table_latch_.RUnlock();
+  return SplitInsert(key, value);
+}
+
+ExtendibleHashTable::InsertResult ExtendibleHashTable::InsertIntoChain(Page *primary, const GenericKey *key,
+                                                                        const RowId &value, bool overflow) {
+  auto page_ids = ChainPageIds(primary);
+  for (auto page_id : page_ids) {
+    Page *page = page_id == primary->GetPageId() ? primary : buffer_pool_manager_->FetchPage(page_id);
+    auto bucket = AsBucket(page);
+    bool duplicate = false;
+    for (uint32_t i = 0; i < bucket->GetSize() && !duplicate; i++) {
+      duplicate = processor_.CompareKeys(bucket->KeyAt(i, key_size_), key) == 0;
+    }
+    if (page != primary) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+    if (duplicate) {
+      return InsertResult::kDuplicate;
+    }
+  }
+  return AppendToChain(primary, key, value, overflow) ? InsertResult::kInserted : InsertResult::kFull;
+}
+
+bool ExtendibleHashTable::AppendToChain(Page *primary, const GenericKey *key, const RowId &value, bool overflow) {
+  uint32_t capacity = HashTableBucketPage::Capacity(key_size_);
+  page_id_t last_page_id = INVALID_PAGE_ID;
+  for (auto page_id : ChainPageIds(primary)) {
+    Page *page = page_id == primary->GetPageId() ? primary : buffer_pool_manager_->FetchPage(page_id);
+    auto bucket = AsBucket(page);
+    bool appended = bucket->GetSize() < capacity;
+    if (appended) {
+      bucket->Append(key, value, key_size_);
+    }
+    if (page != primary) {
+      buffer_pool_manager_->UnpinPage(page_id, appended);
+    }
+    if (appended) {
+      return true;
+    }
+    last_page_id = page_id;
+  }
+  if (!overflow) {
+    return false;
+  }
+  // 整条链已满，在链尾接一个溢出页
+  page_id_t new_page_id;
+  auto new_page = buffer_pool_manager_->NewPage(new_page_id);
+  ASSERT(new_page != nullptr, "Out of memory.");
+  auto new_bucket = AsBucket(new_page);
+  new_bucket->Init();
+  new_bucket->Append(key, value, key_size_);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  Page *last_page = last_page_id == primary->GetPageId() ? primary : buffer_pool_manager_->FetchPage(last_page_id);
+  AsBucket(last_page)->SetNextPageId(new_page_id);
+  if (last_page != primary) {
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+  }
+  return true;
+}
+
+bool ExtendibleHashTable::SplitInsert(const GenericKey *key, const RowId &value) {
+  table_latch_.WLock();
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    // 第一次插入时创建目录页和唯一的桶
+    page_id_t bucket_page_id;
+    auto bucket_page = buffer_pool_manager_->NewPage(bucket_page_id);
+    ASSERT(bucket_page != nullptr, "Out of memory.");
+    AsBucket(bucket_page)->Init();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    auto directory_page = buffer_pool_manager_->NewPage(directory_page_id_);
+    ASSERT(directory_page != nullptr, "Out of memory.");
+    reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData())->Init(directory_page_id_, bucket_page_id);
+    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    auto page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+    page->WLatch();
+    reinterpret_cast<IndexRootsPage *>(page->GetData())->Insert(index_id_, directory_page_id_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  }
+  auto directory = FetchDirectory();
+  InsertResult result;
+  while (true) {
+    uint32_t bucket_idx = KeyToIndex(key, directory);
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    Page *primary = buffer_pool_manager_->FetchPage(bucket_page_id);
+    bool overflow = directory->GetLocalDepth(bucket_idx) >= HASH_DIRECTORY_MAX_DEPTH;
+    result = InsertIntoChain(primary, key, value, overflow);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, result == InsertResult::kInserted);
+    if (result != InsertResult::kFull) {
+      break;
+    }
+    SplitBucket(directory, bucket_idx);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  table_latch_.WUnlock();
+  return result == InsertResult::kInserted;
+}
+
+void ExtendibleHashTable::SplitBucket(HashTableDirectoryPage *directory, uint32_t bucket_idx) {
+  uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+  if (local_depth == directory->GetGlobalDepth()) {
+    directory->IncrGlobalDepth();
+  }
+  page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+  page_id_t image_page_id;
+  auto image_page = buffer_pool_manager_->NewPage(image_page_id);
+  ASSERT(image_page != nullptr, "Out of memory.");
+  AsBucket(image_page)->Init();
+  // 新增位为1的槽指向新桶
+  uint32_t high_bit = 1U << local_depth;
+  for (uint32_t i = 0; i < directory->Size(); i++) {
+    if (directory->GetBucketPageId(i) == bucket_page_id) {
+      directory->SetLocalDepth(i, local_depth + 1);
+      if ((i & high_bit) != 0) {
+        directory->SetBucketPageId(i, image_page_id);
+      }
+    }
+  }
+  // 取出旧桶整条链上的entry，按新增位重新分配
+  Page *primary = buffer_pool_manager_->FetchPage(bucket_page_id);
+  uint32_t entry_size = key_size_ + sizeof(RowId);
+  std::vector<char> entries;
+  auto page_ids = ChainPageIds(primary);
+  for (auto page_id : page_ids) {
+    Page *page = page_id == bucket_page_id ? primary : buffer_pool_manager_->FetchPage(page_id);
+    auto bucket = AsBucket(page);
+    if (bucket->GetSize() > 0) {
+      auto begin = reinterpret_cast<char *>(bucket->KeyAt(0, key_size_));
+      entries.insert(entries.end(), begin, begin + bucket->GetSize() * entry_size);
+    }
+    if (page != primary) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+  }
+  AsBucket(primary)->Init();
+  for (size_t offset = 0; offset < entries.size(); offset += entry_size) {
+    auto key = reinterpret_cast<GenericKey *>(entries.data() + offset);
+    RowId value;
+    memcpy(&value, entries.data() + offset + key_size_, sizeof(RowId));
+    Page *target = (processor_.HashColumns(key) & high_bit) != 0 ? image_page : primary;
+    AppendToChain(target, key, value, true);
+  }
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+bool ExtendibleHashTable::Remove(const GenericKey *key, const RowId &value, Transaction *) {
+  table_latch_.RLock();
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    table_latch_.RUnlock();
+    return false;
+  }
+  auto directory = FetchDirectory();
+  page_id_t bucket_page_id = directory->GetBucketPageId(KeyToIndex(key, directory));
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  Page *primary = buffer_pool_manager_->FetchPage(bucket_page_id);
+  primary->WLatch();
+  auto page_ids = ChainPageIds(primary);
+  Page *found_page = nullptr;
+  uint32_t found_index = 0;
+  for (auto page_id : page_ids) {
+    Page *page = page_id == bucket_page_id ? primary : buffer_pool_manager_->FetchPage(page_id);
+    auto bucket = AsBucket(page);
+    for (uint32_t i = 0; i < bucket->GetSize() && found_page == nullptr; i++) {
+      if (processor_.CompareKeys(bucket->KeyAt(i, key_size_), key) == 0 && bucket->ValueAt(i, key_size_) == value) {
+        found_page = page;
+        found_index = i;
+      }
+    }
+    if (found_page != nullptr) {
+      break;
+    }
+    if (page != primary) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+  }
+  if (found_page == nullptr) {
+    primary->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    table_latch_.RUnlock();
+    return false;
+  }
+  // 用链尾页的最后一个entry填补空位，保持除链尾外的页都是满的
+  auto found_bucket = AsBucket(found_page);
+  found_bucket->RemoveAt(found_index, key_size_);
+  page_id_t last_page_id = page_ids.back();
+  Page *last_page = found_page;
+  if (found_page->GetPageId() != last_page_id) {
+    last_page = buffer_pool_manager_->FetchPage(last_page_id);
+    AsBucket(last_page)->MoveLastTo(found_bucket, key_size_);
+  }
+  bool last_empty = last_page != primary && AsBucket(last_page)->GetSize() == 0;
+  if (last_page != found_page) {
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+  }
+  if (found_page != primary) {
+    buffer_pool_manager_->UnpinPage(found_page->GetPageId(), true);
+  }
+  if (last_empty) {
+    // 摘下空的溢出页
+    page_id_t prev_page_id = page_ids[page_ids.size() - 2];
+    Page *prev_page = prev_page_id == bucket_page_id ? primary : buffer_pool_manager_->FetchPage(prev_page_id);
+    AsBucket(prev_page)->SetNextPageId(INVALID_PAGE_ID);
+    if (prev_page != primary) {
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    }
+    buffer_pool_manager_->DeletePage(last_page_id);
+  }
+  bool empty = AsBucket(primary)->GetSize() == 0;
+  primary->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  table_latch_.RUnlock();
+  if (empty) {
+    Merge(key);
+  }
+  return true;
+}
+
+void ExtendibleHashTable::Merge(const GenericKey *key) {
+  table_latch_.WLock();
+  auto directory = FetchDirectory();
+  bool dirty = false;
+  while (true) {
+    uint32_t bucket_idx = KeyToIndex(key, directory);
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    if (local_depth == 0) {
+      break;
+    }
+    uint32_t image_idx = directory->GetSplitImageIndex(bucket_idx);
+    if (directory->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    // 释放表锁期间可能有插入，重新确认桶仍为空
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = directory->GetBucketPageId(image_idx);
+    auto page = buffer_pool_manager_->FetchPage(bucket_page_id);
+    bool empty = AsBucket(page)->GetSize() == 0;
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    if (!empty) {
+      break;
+    }
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      page_id_t page_id = directory->GetBucketPageId(i);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        directory->SetBucketPageId(i, image_page_id);
+        directory->SetLocalDepth(i, local_depth - 1);
+      }
+    }
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+    while (directory->CanShrink()) {
+      directory->DecrGlobalDepth();
+    }
+    dirty = true;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dirty);
+  table_latch_.WUnlock();
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+void ExtendibleHashTable::DeleteChain(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = buffer_pool_manager_->FetchPage(page_id);
+    page_id_t next_page_id = AsBucket(page)->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+void ExtendibleHashTable::Destroy() {
+  table_latch_.WLock();
+  auto page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  page->WLatch();
+  reinterpret_cast<IndexRootsPage *>(page->GetData())->Delete(index_id_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  if (directory_page_id_ != INVALID_PAGE_ID) {
+    auto directory = FetchDirectory();
+    std::set<page_id_t> bucket_page_ids;
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      bucket_page_ids.insert(directory->GetBucketPageId(i));
+    }
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+    for (auto bucket_page_id : bucket_page_ids) {
+      DeleteChain(bucket_page_id);
+    }
+    buffer_pool_manager_->DeletePage(directory_page_id_);
+    directory_page_id_ = INVALID_PAGE_ID;
+  }
+  table_latch_.WUnlock();
+}
+
+uint32_t ExtendibleHashTable::GetGlobalDepth() {
+  table_latch_.RLock();
+  uint32_t global_depth = 0;
+  if (directory_page_id_ != INVALID_PAGE_ID) {
+    global_depth = FetchDirectory()->GetGlobalDepth();
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  }
+  table_latch_.RUnlock();
+  return global_depth;
+}
+
+bool ExtendibleHashTable::Check() {
+  table_latch_.RLock();
+  bool ok = true;
+  if (directory_page_id_ != INVALID_PAGE_ID) {
+    auto directory = FetchDirectory();
+    ok = directory->VerifyIntegrity();
+    uint32_t capacity = HashTableBucketPage::Capacity(key_size_);
+    for (uint32_t i = 0; i < directory->Size() && ok; i++) {
+      uint32_t local_mask = (1U << directory->GetLocalDepth(i)) - 1;
+      page_id_t page_id = directory->GetBucketPageId(i);
+      // 链尾之前的页都是满的
+      while (page_id != INVALID_PAGE_ID && ok) {
+        auto bucket = AsBucket(buffer_pool_manager_->FetchPage(page_id));
+        for (uint32_t j = 0; j < bucket->GetSize(); j++) {
+          if ((processor_.HashColumns(bucket->KeyAt(j, key_size_)) & local_mask) != (i & local_mask)) {
+            LOG(ERROR) << "Entry " << j << " of bucket page " << page_id << " does not belong to slot " << i;
+            ok = false;
+          }
+        }
+        page_id_t next_page_id = bucket->GetNextPageId();
+        if (next_page_id != INVALID_PAGE_ID && bucket->GetSize() != capacity) {
+          LOG(ERROR) << "Unexpected overflow page after bucket page " << page_id;
+          ok = false;
+        }
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        page_id = next_page_id;
+      }
+    }
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  }
+  table_latch_.RUnlock();
+  return ok;
+}
@@ -1,50 +1,161 @@
 #include "index/index_iterator.h"
 
-#include "index/basic_comparator.h"
+#include "index/b_plus_tree.h"
 #include "index/generic_key.h"
 
-IndexIterator::IndexIterator() = default;
-
-// IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index)
-//     : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
-//   page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id));
-// }
-IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index)
-    : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
-  page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id)->GetData());
+IndexIterator::IndexIterator(BPlusTree *tree, const GenericKey *low, bool low_inclusive, const GenericKey *high,
+                             bool high_inclusive)
+    : tree_(tree), high_inclusive_(high_inclusive) {
+  tree_->optimistic_count_++;
+  size_t key_size = tree_->processor_.GetKeySize();
+  key_ = reinterpret_cast<GenericKey *>(malloc(key_size));
+  if (low != nullptr) {
+    memcpy(key_, low, key_size);
+    has_key_ = true;
+    key_inclusive_ = low_inclusive;
+  }
+  if (high != nullptr) {
+    high_ = reinterpret_cast<GenericKey *>(malloc(key_size));
+    memcpy(high_, high, key_size);
+  }
+  Locate();
+  Settle();
 }
 
+IndexIterator::IndexIterator(IndexIterator &&other) noexcept { *this = std::move(other); }
+
 IndexIterator::~IndexIterator() {
-  if (current_page_id != INVALID_PAGE_ID)
-    buffer_pool_manager->UnpinPage(current_page_id, false);
+  Release();
+  free(key_);
+  free(high_);
+}
+
+IndexIterator &IndexIterator::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    free(key_);
+    free(high_);
+    tree_ = other.tree_;
+    page_ = other.page_;
+    version_ = other.version_;
+    index_ = other.index_;
+    key_ = other.key_;
+    has_key_ = other.has_key_;
+    key_inclusive_ = other.key_inclusive_;
+    value_ = other.value_;
+    high_ = other.high_;
+    high_inclusive_ = other.high_inclusive_;
+    other.tree_ = nullptr;
+    other.page_ = nullptr;
+    other.key_ = other.high_ = nullptr;
+  }
+  return *this;
 }
+
 /* IndexIterator */
 std::pair<GenericKey *, RowId> IndexIterator::operator*() {
-  return page->GetItem(item_index);
+  return {key_, value_};
 }
+
 /* IndexIterator */
 IndexIterator &IndexIterator::operator++() {
-  if(item_index >= page->GetSize()-1){
-    buffer_pool_manager->UnpinPage(current_page_id,false);
-    current_page_id = page->GetNextPageId();
-    item_index = 0;
-    if(current_page_id != INVALID_PAGE_ID){
-      page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id));
-    }
-    else{
-      return *this;
-    }
-  }
-  else{
-    item_index++;
+  ASSERT(page_ != nullptr, "Increment of the end iterator.");
+  page_->RLatch();
+  if (page_->GetVersion() == version_) {
+    index_++;
+  } else {
+    // 叶子在两次访问之间被修改，重新查找当前key之后的位置
+    page_->RUnlatch();
+    tree_->buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+    Locate();
   }
+  Settle();
   return *this;
 }
 
 bool IndexIterator::operator==(const IndexIterator &itr) const {
-  return current_page_id == itr.current_page_id && item_index == itr.item_index;
+  return page_ == itr.page_ && (page_ == nullptr || index_ == itr.index_);
 }
 
 bool IndexIterator::operator!=(const IndexIterator &itr) const {
   return !(*this == itr);
-}
\ No newline at end of file
+}
+
+void IndexIterator::Locate() {
+  page_ = tree_->FindLeafPage(has_key_ ? key_ : nullptr, !has_key_);
+  index_ = 0;
+  if (page_ == nullptr || !has_key_) {
+    return;
+  }
+  auto leaf = reinterpret_cast<LeafPage *>(page_->GetData());
+  index_ = leaf->KeyIndex(key_, tree_->processor_);
+  if (!key_inclusive_ && index_ < leaf->GetSize() && leaf->CompareKeyAt(index_, key_, tree_->processor_) == 0) {
+    index_++;
+  }
+}
+
+void IndexIterator::Settle() {
+  BufferPoolManager *bpm = tree_->buffer_pool_manager_;
+  while (page_ != nullptr) {
+    auto leaf = reinterpret_cast<LeafPage *>(page_->GetData());
+    if (index_ < leaf->GetSize()) {
+      break;
+    }
+    page_id_t next_page_id = leaf->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      page_->RUnlatch();
+      Release();
+      return;
+    }
+    // 先释放当前叶子再锁右兄弟，当前叶子版本不变说明右兄弟仍是它的后继
+    uint64_t version = page_->GetVersion();
+    page_->RUnlatch();
+    Page *next_page = bpm->FetchPage(next_page_id);
+    next_page->RLatch();
+    bool unchanged = page_->GetVersion() == version;
+    bpm->UnpinPage(page_->GetPageId(), false);
+    if (unchanged) {
+      page_ = next_page;
+      index_ = 0;
+      continue;
+    }
+    next_page->RUnlatch();
+    bpm->UnpinPage(next_page_id, false);
+    page_ = nullptr;
+    Locate();
+  }
+  if (page_ == nullptr) {
+    Release();
+    return;
+  }
+  auto leaf = reinterpret_cast<LeafPage *>(page_->GetData());
+  if (high_ != nullptr) {
+    int cmp = leaf->CompareKeyAt(index_, high_, tree_->processor_);
+    if (cmp > 0 || (cmp == 0 && !high_inclusive_)) {
+      page_->RUnlatch();
+      Release();
+      return;
+    }
+  }
+  leaf->CopyKeyAt(index_, key_);
+  has_key_ = true;
+  key_inclusive_ = false;
+  value_ = leaf->ValueAt(index_);
+  version_ = page_->GetVersion();
+  page_->RUnlatch();
+}
+
+void IndexIterator::Release() {
+  if (tree_ == nullptr) {
+    return;
+  }
+  if (page_ != nullptr) {
+    tree_->buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
+  if (--tree_->optimistic_count_ == 0 && tree_->reclaim_count_ > 0) {
+    tree_->ReclaimPages();
+  }
+  tree_ = nullptr;
+}
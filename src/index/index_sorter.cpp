@@ -0,0 +1,177 @@
+#include "index/index_sorter.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "common/macros.h"
+
+IndexSorter::IndexSorter(BufferPoolManager *buffer_pool_manager, const KeyManager &key_manager, size_t memory_size)
+    : buffer_pool_manager_(buffer_pool_manager),
+      key_manager_(key_manager),
+      key_size_(key_manager.GetKeySize()),
+      entry_size_(key_size_ + sizeof(RowId)) {
+  // 每个run页至少放下一个entry
+  ASSERT(SIZE_HEADER + entry_size_ <= PAGE_SIZE, "Index entry exceeds a page.");
+  buffer_capacity_ = std::max<size_t>(1, memory_size / entry_size_);
+}
+
+IndexSorter::~IndexSorter() {
+  // 删除未读完的run页
+  std::vector<page_id_t> chains;
+  if (cursors_.empty()) {
+    chains = runs_;
+  } else {
+    for (auto &cursor : cursors_) {
+      if (cursor.page != nullptr) {
+        buffer_pool_manager_->UnpinPage(cursor.page_id, false);
+        chains.push_back(cursor.page_id);
+      }
+    }
+  }
+  for (page_id_t page_id : chains) {
+    while (page_id != INVALID_PAGE_ID) {
+      auto page = buffer_pool_manager_->FetchPage(page_id);
+      if (page == nullptr) {
+        break;
+      }
+      page_id_t next_page_id = MACH_READ_FROM(page_id_t, page->GetData() + OFFSET_NEXT_PAGE_ID);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      page_id = next_page_id;
+    }
+  }
+}
+
+void IndexSorter::Add(const GenericKey *key, const RowId &value) {
+  ASSERT(!finished_, "Add after Finish.");
+  if (buffer_.size() == buffer_capacity_ * entry_size_) {
+    SortBuffer();
+    SpillRun();
+  }
+  size_t offset = buffer_.size();
+  buffer_.resize(offset + entry_size_);
+  memcpy(buffer_.data() + offset, key, key_size_);
+  MACH_WRITE_TO(RowId, buffer_.data() + offset + key_size_, value);
+  size_++;
+}
+
+bool IndexSorter::Less(const char *a, const char *b) const {
+  int cmp = key_manager_.CompareKeys(reinterpret_cast<const GenericKey *>(a), reinterpret_cast<const GenericKey *>(b));
+  if (cmp != 0) {
+    return cmp < 0;
+  }
+  return MACH_READ_FROM(RowId, a + key_size_).Get() < MACH_READ_FROM(RowId, b + key_size_).Get();
+}
+
+void IndexSorter::SortBuffer() {
+  // 只排序下标，再按序拷贝一次entry
+  uint32_t count = buffer_.size() / entry_size_;
+  std::vector<uint32_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  const char *data = buffer_.data();
+  std::sort(order.begin(), order.end(),
+            [&](uint32_t a, uint32_t b) { return Less(data + a * entry_size_, data + b * entry_size_); });
+  sorted_.resize(buffer_.size());
+  for (uint32_t i = 0; i < count; i++) {
+    memcpy(sorted_.data() + i * entry_size_, data + order[i] * entry_size_, entry_size_);
+  }
+  buffer_.clear();
+}
+
+void IndexSorter::SpillRun() {
+  uint32_t per_page = (PAGE_SIZE - SIZE_HEADER) / entry_size_;
+  uint32_t count = sorted_.size() / entry_size_;
+  Page *prev_page = nullptr;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  for (uint32_t start = 0; start < count; start += per_page) {
+    page_id_t page_id;
+    auto page = buffer_pool_manager_->NewPage(page_id);
+    ASSERT(page != nullptr, "New run page failed!");
+    uint32_t n = std::min(per_page, count - start);
+    MACH_WRITE_TO(page_id_t, page->GetData() + OFFSET_NEXT_PAGE_ID, INVALID_PAGE_ID);
+    MACH_WRITE_UINT32(page->GetData() + OFFSET_ENTRY_COUNT, n);
+    memcpy(page->GetData() + SIZE_HEADER, sorted_.data() + start * entry_size_, n * entry_size_);
+    if (prev_page == nullptr) {
+      runs_.push_back(page_id);
+    } else {
+      MACH_WRITE_TO(page_id_t, prev_page->GetData() + OFFSET_NEXT_PAGE_ID, page_id);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    }
+    prev_page = page;
+    prev_page_id = page_id;
+  }
+  if (prev_page != nullptr) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, true);
+  }
+  sorted_.clear();
+}
+
+void IndexSorter::Finish() {
+  ASSERT(!finished_, "Finish called twice.");
+  finished_ = true;
+  SortBuffer();
+  for (page_id_t page_id : runs_) {
+    Cursor cursor;
+    cursor.page_id = page_id;
+    cursor.page = buffer_pool_manager_->FetchPage(page_id);
+    ASSERT(cursor.page != nullptr, "Fetch run page failed!");
+    cursor.data = cursor.page->GetData() + SIZE_HEADER;
+    cursor.count = MACH_READ_UINT32(cursor.page->GetData() + OFFSET_ENTRY_COUNT);
+    cursors_.push_back(cursor);
+  }
+  // 最后一批entry不落盘，直接参与归并
+  if (!sorted_.empty()) {
+    Cursor cursor;
+    cursor.data = sorted_.data();
+    cursor.count = sorted_.size() / entry_size_;
+    cursors_.push_back(cursor);
+  }
+  for (uint32_t i = 0; i < cursors_.size(); i++) {
+    heap_.push_back(i);
+  }
+  auto greater = [this](uint32_t a, uint32_t b) { return Greater(a, b); };
+  std::make_heap(heap_.begin(), heap_.end(), greater);
+}
+
+bool IndexSorter::Advance(Cursor *cursor) {
+  if (++cursor->pos < cursor->count) {
+    return true;
+  }
+  if (cursor->page == nullptr) {
+    return false;
+  }
+  // 当前页读完，删除它并读run的下一页
+  page_id_t next_page_id = MACH_READ_FROM(page_id_t, cursor->page->GetData() + OFFSET_NEXT_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(cursor->page_id, false);
+  buffer_pool_manager_->DeletePage(cursor->page_id);
+  cursor->page_id = next_page_id;
+  cursor->page = nullptr;
+  cursor->pos = 0;
+  if (next_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  cursor->page = buffer_pool_manager_->FetchPage(next_page_id);
+  ASSERT(cursor->page != nullptr, "Fetch run page failed!");
+  cursor->data = cursor->page->GetData() + SIZE_HEADER;
+  cursor->count = MACH_READ_UINT32(cursor->page->GetData() + OFFSET_ENTRY_COUNT);
+  return true;
+}
+
+bool IndexSorter::Next(GenericKey *key, RowId *value) {
+  ASSERT(finished_, "Next before Finish.");
+  if (heap_.empty()) {
+    return false;
+  }
+  auto greater = [this](uint32_t a, uint32_t b) { return Greater(a, b); };
+  std::pop_heap(heap_.begin(), heap_.end(), greater);
+  Cursor &cursor = cursors_[heap_.back()];
+  const char *entry = EntryAt(cursor);
+  memcpy(key, entry, key_size_);
+  *value = MACH_READ_FROM(RowId, entry + key_size_);
+  if (Advance(&cursor)) {
+    std::push_heap(heap_.begin(), heap_.end(), greater);
+  } else {
+    heap_.pop_back();
+  }
+  return true;
+}
@@ -24,8 +24,9 @@ void InputCommand(char *input, const int len) {
   printf("minisql > ");
   int i = 0;
   char ch;
+  // 超长的命令被截断，留出';'和结尾的位置
   while ((ch = getchar()) != ';') {
-    input[i++] = ch;
+    if (i < len - 2) input[i++] = ch;
   }
   input[i] = ch;  // ;
   getchar();      // remove enter
@@ -34,8 +35,9 @@ void InputCommand(char *input, const int len) {
 int main(int argc, char **argv) {
   InitGoogleLog(argv[0]);
   // command buffer
-  const int buf_size = 1024;
-  char cmd[buf_size];
+  // 能容纳一条带最长字符串的insert
+  const int buf_size = VARCHAR_MAX_LEN + 1024;
+  static char cmd[buf_size];
   // executor engine
   ExecuteEngine engine;
   // for print syntax tree
@@ -13,14 +13,13 @@
  *****************************************************************************/
 /*
  * Init method after creating a new internal page
- * Including set page type, set current size, set page id, set parent id and set
+ * Including set page type, set current size, set page id and set
  * max page size
  */
 /* Init */
-void InternalPage::Init(page_id_t page_id, page_id_t parent_id , int key_size, int max_size) {
+void InternalPage::Init(page_id_t page_id, int key_size, int max_size) {
   SetPageType(IndexPageType::INTERNAL_PAGE);
   SetPageId(page_id);
-  SetParentPageId(parent_id);
   SetSize(0);
   SetMaxSize(max_size);
   SetKeySize(key_size);
@@ -33,7 +32,7 @@ GenericKey *InternalPage::KeyAt(int index) {
   return reinterpret_cast<GenericKey *>(pairs_off + index * pair_size + key_off);
 }
 
-void InternalPage::SetKeyAt(int index, GenericKey *key) {
+void InternalPage::SetKeyAt(int index, const GenericKey *key) {
   memcpy(pairs_off + index * pair_size + key_off, key, GetKeySize());
 }
 
@@ -97,7 +96,7 @@ page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
  * NOTE: This method is only called within InsertIntoParent()(b_plus_tree.cpp)
  */
 /* PopulateNewRoot */
-void InternalPage::PopulateNewRoot(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value) {
+void InternalPage::PopulateNewRoot(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value) {
   SetValueAt(0 ,old_value);
   SetKeyAt(1, new_key);
   SetValueAt(1, new_value);
@@ -110,7 +109,7 @@ void InternalPage::PopulateNewRoot(const page_id_t &old_value, GenericKey *new_k
  * @return:  new size after insertion
  */
 /* InsertNodeAfter */
-int InternalPage::InsertNodeAfter(const page_id_t &old_value, GenericKey *new_key, const page_id_t &new_value) {
+int InternalPage::InsertNodeAfter(const page_id_t &old_value, const GenericKey *new_key, const page_id_t &new_value) {
   int size = GetSize();
   int old = ValueIndex(old_value);
   for (int i = size - 1; i > old; i--) {
@@ -129,32 +128,28 @@ int InternalPage::InsertNodeAfter(const page_id_t &old_value, GenericKey *new_ke
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
- * buffer_pool_manager 用于传给CopyNFrom()用于Fetch数据页
+ * The moved children are not touched, pages don't record their parent.
  */
 /* MoveHalfTo */
-void InternalPage::MoveHalfTo(InternalPage *recipient, BufferPoolManager *buffer_pool_manager) {
-    int RightNode=(GetSize()+1)/2;
-    int LeftNode =GetSize() - RightNode;
-    recipient->SetSize(RightNode);
-    recipient->CopyNFrom(PairPtrAt(LeftNode),RightNode,buffer_pool_manager);
+void InternalPage::MoveHalfTo(InternalPage *recipient) {
+    MoveTailTo(recipient, (GetSize() + 1) / 2);
+}
+
+/* MoveTailTo */
+void InternalPage::MoveTailTo(InternalPage *recipient, int count) {
+    int LeftNode = GetSize() - count;
+    ASSERT(0 < LeftNode && count > 0, "Split leaves an empty page.");
+    // 右半部分的第一个key成为recipient无效的KeyAt(0)，由调用者插入父节点
+    recipient->CopyNFrom(PairPtrAt(LeftNode),count);
     SetSize(LeftNode);
 }
 
 /* Copy entries into me, starting from {items} and copy {size} entries.
- * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
- * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
- *
  */
 /* CopyNFrom */
-void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool_manager) {
+void InternalPage::CopyNFrom(void *src, int size) {
   //  std::copy(&src, &src + size, pairs_off + GetSize());
   PairCopy(PairPtrAt(GetSize()), src, size);
-  for (int i = GetSize(); i < GetSize() + size; i++) {
-    Page *child_page = buffer_pool_manager->FetchPage(ValueAt(i));
-    BPlusTreePage *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
-    child->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
-  }
   IncreaseSize(size);
 }
 
@@ -195,14 +190,12 @@ page_id_t InternalPage::RemoveAndReturnOnlyChild() {
  * Remove all key & value pairs from this page to "recipient" page.
  * The middle_key is the separation key you should get from the parent. You need
  * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
  */
 /* Merge */
-void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, BufferPoolManager *buffer_pool_manager) {
+void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key) {
   int size = GetSize();
   SetKeyAt(0, middle_key);
-  recipient->CopyNFrom(pairs_off, size, buffer_pool_manager);
+  recipient->CopyNFrom(pairs_off, size);
   SetSize(0);
 }
 
@@ -214,68 +207,43 @@ void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, Bu
  *
  * The middle_key is the separation key you should get from the parent. You need
  * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
  */
 /* MoveFirstToEndOf */
-void InternalPage::MoveFirstToEndOf(InternalPage *recipient, GenericKey *middle_key,
-                                    BufferPoolManager *buffer_pool_manager) {
-  int size = GetSize();
-  SetKeyAt(0, middle_key);
-  recipient->CopyNFrom(pairs_off, size, buffer_pool_manager);
-  SetSize(0);
+void InternalPage::MoveFirstToEndOf(InternalPage *recipient, GenericKey *middle_key) {
+  recipient->CopyLastFrom(middle_key, ValueAt(0));
+  // 原KeyAt(1)移到KeyAt(0)，它是父节点新的分隔key
+  Remove(0);
 }
 
 /* Append an entry at the end.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 /* CopyLastFrom */
-void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value, BufferPoolManager *buffer_pool_manager) {
+void InternalPage::CopyLastFrom(GenericKey *key, const page_id_t value) {
   int len = GetSize();
-  PairCopy(PairPtrAt(len), key, 1);
-  Page *page = buffer_pool_manager->FetchPage(ValueAt(len));
-  BPlusTreePage *data = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  data->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(page->GetPageId(), true);
+  SetKeyAt(len, key);
+  SetValueAt(len, value);
   IncreaseSize(1);
 }
 
 /*
  * Remove the last key & value pair from this page to head of "recipient" page.
- * You need to handle the original dummy key properly, e.g. updating recipient’s array to position the middle_key at the
- * right place.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those pages that are
- * moved to the recipient
+ * The middle_key becomes the first valid key of the recipient and the moved key is left in the recipient's
+ * KeyAt(0), it is the new separation key the caller puts into the parent.
  */
 /* MoveLastToFrontOf */
-void InternalPage::MoveLastToFrontOf(InternalPage *recipient, GenericKey *middle_key,
-                                     BufferPoolManager *buffer_pool_manager) {
+void InternalPage::MoveLastToFrontOf(InternalPage *recipient, GenericKey *middle_key) {
   int size = GetSize();
   recipient->SetKeyAt(0, middle_key);
-  //  recipient->CopyFirstFrom(array_[size - 1], buffer_pool_manager);
-  recipient->CopyLastFrom(KeyAt(size - 1), ValueAt(size - 1), buffer_pool_manager);
+  recipient->CopyFirstFrom(KeyAt(size - 1), ValueAt(size - 1));
   IncreaseSize(-1);
 }
 /* Append an entry at the beginning.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 /* CopyFirstFrom */
-void InternalPage::CopyFirstFrom(const page_id_t value, BufferPoolManager *buffer_pool_manager) {
+void InternalPage::CopyFirstFrom(GenericKey *key, const page_id_t value) {
   int len = GetSize();
-  for (int i = len; i > 0; i--) {
-    PairCopy(PairPtrAt(i), PairPtrAt(i - 1), 1);
-  }
-  PairCopy(PairPtrAt(0), PairPtrAt(0), 1);
-  Page *page = buffer_pool_manager->FetchPage(ValueAt(0));
-  BPlusTreePage *data = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  data->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(page->GetPageId(), true);
-  Page *parent = buffer_pool_manager->FetchPage(GetParentPageId());
-  BPlusTreeInternalPage *p = reinterpret_cast<BPlusTreeInternalPage *>(parent->GetData());
-  int x = p->ValueIndex(GetPageId());
-  p->SetKeyAt(x, KeyAt(0));
-  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+  memmove(PairPtrAt(1), PairPtrAt(0), len * (GetKeySize() + sizeof(page_id_t)));
+  SetKeyAt(0, key);
+  SetValueAt(0, value);
   IncreaseSize(1);
-}
\ No newline at end of file
+}
@@ -4,30 +4,43 @@
 
 #include "index/generic_key.h"
 
-#define pairs_off (data_)
-#define pair_size (GetKeySize() + sizeof(RowId))
-#define key_off 0
-#define val_off GetKeySize()
+#define entry_size (GetKeySize() + sizeof(RowId))
 /*****************************************************************************
  * HELPER METHODS AND UTILITIES
  *****************************************************************************/
 
 /**
  * Init method after creating a new leaf page
- * Including set page type, set current size to zero, set page id/parent id, set
+ * Including set page type, set current size to zero, set page id, set
  * next page id and set max size
- * 未初始化next_page_id
  */
 /* Init */
-void LeafPage::Init(page_id_t page_id, page_id_t parent_id, int key_size, int max_size) {
+void LeafPage::Init(page_id_t page_id, int key_size, int max_size) {
   SetPageType(IndexPageType::LEAF_PAGE);
   SetPageId(page_id);
   SetSize(0);
-  SetParentPageId(parent_id);
-  SetMaxSize(max_size);
   SetKeySize(key_size);
   SetNextPageId(INVALID_PAGE_ID);
+  prefix_size_ = 0;
+  fence_flags_ = LOW_INFINITE | HIGH_INFINITE;
+  size_limit_ = max_size;
+  SetMaxSize(MaxSizeWithFences(nullptr, nullptr));
 }
+
+int LeafPage::MaxSizeFor(int key_size, int prefix_size) {
+  // 两个fence不压缩
+  return static_cast<int>((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - 2 * key_size) / (key_size - prefix_size + sizeof(RowId))) -
+         1;
+}
+
+int LeafPage::GetMinSize() const {
+  return (MaxSizeWithFences(nullptr, nullptr) + 1) / 2;
+}
+
+int LeafPage::Capacity() const {
+  return static_cast<int>((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - 2 * GetKeySize()) / (SuffixSize() + sizeof(RowId)));
+}
+
 /**
  * Helper methods to set/get next page id
  */
@@ -42,58 +55,109 @@ void LeafPage::SetNextPageId(page_id_t next_page_id) {
   }
 }
 
+const GenericKey *LeafPage::GetLowFence() const {
+  return (fence_flags_ & LOW_INFINITE) != 0 ? nullptr : reinterpret_cast<const GenericKey *>(data_);
+}
+
+const GenericKey *LeafPage::GetHighFence() const {
+  return (fence_flags_ & HIGH_INFINITE) != 0 ? nullptr : reinterpret_cast<const GenericKey *>(data_ + GetKeySize());
+}
+
+int LeafPage::MaxSizeWithFences(const GenericKey *low, const GenericKey *high) const {
+  int prefix_size = 0;
+  if (low != nullptr && high != nullptr) {
+    auto lhs = reinterpret_cast<const char *>(low);
+    auto rhs = reinterpret_cast<const char *>(high);
+    prefix_size = static_cast<int>(std::mismatch(lhs, lhs + GetKeySize(), rhs).first - lhs);
+  }
+  int max_size = MaxSizeFor(GetKeySize(), prefix_size);
+  return size_limit_ == UNDEFINED_SIZE ? max_size : std::min(max_size, size_limit_);
+}
+
+void LeafPage::SetFences(const GenericKey *low, const GenericKey *high) {
+  std::vector<char> entries;
+  ExportEntries(0, GetSize(), &entries);
+  Rebuild(entries.data(), GetSize(), low, high);
+}
+
 /* KeyIndex */
 /**
  * Helper method to find the first index i so that pairs_[i].first >= key
- * NOTE: This method is only used when generating index iterator
- * 二分查找
+ * 先比较前缀，再二分查找后缀
  */
-int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
+int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) const {
+  int cmp = memcmp(data_, key, prefix_size_);
+  if (cmp != 0) {
+    return cmp > 0 ? 0 : GetSize();
+  }
   int st = 0, ed = GetSize() - 1;
   while (st <= ed) {  // find the first key in array >= input
     int mid = (ed - st) / 2 + st;
-    if (KM.CompareKeys(KeyAt(mid), key) >= 0)
+    if (KM.CompareSuffix(SuffixAt(mid), key, prefix_size_) >= 0)
       ed = mid - 1;
     else
       st = mid + 1;
   }
   return ed + 1;
 }
-/*
- * Helper method to find and return the key associated with input "index"(a.k.a
- * array offset)
- */
-GenericKey *LeafPage::KeyAt(int index) {
-  return reinterpret_cast<GenericKey *>(pairs_off + index * pair_size + key_off);
+
+void LeafPage::CopyKeyAt(int index, GenericKey *key) const {
+  auto buf = reinterpret_cast<char *>(key);
+  memcpy(buf, data_, prefix_size_);
+  memcpy(buf + prefix_size_, SuffixAt(index), SuffixSize());
 }
 
-void LeafPage::SetKeyAt(int index, GenericKey *key) {
-  memcpy(pairs_off + index * pair_size + key_off, key, GetKeySize());
+int LeafPage::CompareKeyAt(int index, const GenericKey *key, const KeyManager &KM) const {
+  int cmp = memcmp(data_, key, prefix_size_);
+  return cmp != 0 ? cmp : KM.CompareSuffix(SuffixAt(index), key, prefix_size_);
 }
 
-RowId LeafPage::ValueAt(int index) const {
-  return *reinterpret_cast<const RowId *>(pairs_off + index * pair_size + val_off);
+void LeafPage::SetKeyAt(int index, const GenericKey *key) {
+  ASSERT(memcmp(data_, key, prefix_size_) == 0, "Key outside the leaf range.");
+  memcpy(SuffixAt(index), reinterpret_cast<const char *>(key) + prefix_size_, SuffixSize());
 }
 
-void LeafPage::SetValueAt(int index, RowId value) {
-  *reinterpret_cast<RowId *>(pairs_off + index * pair_size + val_off) = value;
+RowId LeafPage::ValueAt(int index) const {
+  return MACH_READ_FROM(RowId, ValuePtrAt(index));
 }
 
-void *LeafPage::PairPtrAt(int index) {
-  return KeyAt(index);
+void LeafPage::SetValueAt(int index, RowId value) {
+  MACH_WRITE_TO(RowId, ValuePtrAt(index), value);
 }
 
-void LeafPage::PairCopy(void *dest, void *src, int pair_num) {
-  memcpy(dest, src, pair_num * (GetKeySize() + sizeof(RowId)));
+void LeafPage::ExportEntries(int begin, int end, std::vector<char> *entries) const {
+  size_t offset = entries->size();
+  entries->resize(offset + (end - begin) * entry_size);
+  for (int i = begin; i < end; i++, offset += entry_size) {
+    CopyKeyAt(i, reinterpret_cast<GenericKey *>(entries->data() + offset));
+    MACH_WRITE_TO(RowId, entries->data() + offset + GetKeySize(), ValueAt(i));
+  }
 }
 
-/*
- * Helper method to find and return the key & value pair associated with input
- * "index"(a.k.a. array offset)
- */
-/* GetItem */
-std::pair<GenericKey *, RowId> LeafPage::GetItem(int index) {
-  return make_pair(KeyAt(index), ValueAt(index));
+void LeafPage::Rebuild(const char *entries, int count, const GenericKey *low, const GenericKey *high) {
+  int key_size = GetKeySize();
+  // fence可能指向本页，先复制出来
+  std::vector<char> fences(2 * key_size, 0);
+  if (low != nullptr) {
+    memcpy(fences.data(), low, key_size);
+  }
+  if (high != nullptr) {
+    memcpy(fences.data() + key_size, high, key_size);
+  }
+  SetMaxSize(MaxSizeWithFences(low, high));
+  fence_flags_ = (low == nullptr ? LOW_INFINITE : 0) | (high == nullptr ? HIGH_INFINITE : 0);
+  prefix_size_ = 0;
+  if (low != nullptr && high != nullptr) {
+    prefix_size_ = std::mismatch(fences.begin(), fences.begin() + key_size, fences.begin() + key_size).first -
+                   fences.begin();
+  }
+  memcpy(data_, fences.data(), 2 * key_size);
+  ASSERT(count <= Capacity(), "Leaf page overflows.");
+  for (int i = 0; i < count; i++) {
+    SetKeyAt(i, reinterpret_cast<const GenericKey *>(entries + i * entry_size));
+    SetValueAt(i, MACH_READ_FROM(RowId, entries + i * entry_size + key_size));
+  }
+  SetSize(count);
 }
 
 /*****************************************************************************
@@ -101,16 +165,16 @@ std::pair<GenericKey *, RowId> LeafPage::GetItem(int index) {
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
+ * The key lies in the range of the page, so the prefix stays and only the arrays shift.
  * @return page size after insertion
  */
 /* Insert */
-int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM) {
+int LeafPage::Insert(const GenericKey *key, const RowId &value, const KeyManager &KM) {
   int size = GetSize();
+  ASSERT(size < Capacity(), "Leaf page overflows.");
   int now_key = KeyIndex(key, KM);
-  for (int i = size; i > now_key; i--) {
-    SetKeyAt(i, KeyAt(i - 1));
-    SetValueAt(i, ValueAt(i - 1));
-  }
+  memmove(SuffixAt(now_key + 1), SuffixAt(now_key), (size - now_key) * SuffixSize());
+  memmove(ValuePtrAt(now_key + 1), ValuePtrAt(now_key), (size - now_key) * sizeof(RowId));
   SetKeyAt(now_key, key);
   SetValueAt(now_key, value);
   IncreaseSize(1);
@@ -122,23 +186,23 @@ int LeafPage::Insert(GenericKey *key, const RowId &value, const KeyManager &KM)
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * The first moved key separates the two pages, both ranges narrow so their prefixes can only grow.
  */
 /* MoveHalfTo */
 void LeafPage::MoveHalfTo(LeafPage *recipient) {
-  int size = GetSize();
-  int start = GetMaxSize() / 2;
-  int length = size - start;
-  recipient->CopyNFrom(pairs_off + start*GetKeySize(), length);
-  SetSize(start);
+  MoveTailTo(recipient, GetSize() - GetSize() / 2);
 }
-/*
- * Copy starting from items, and copy {size} number of elements into me.
- */
-/* CopyNFrom */
-void LeafPage::CopyNFrom(void *src, int size) {
-  //PairCopy(pairs_off + GetSize() * pair_size, src, size);
-    PairCopy(pairs_off, src, size);
-  IncreaseSize(size);
+
+/* MoveTailTo */
+void LeafPage::MoveTailTo(LeafPage *recipient, int count) {
+  int size = GetSize();
+  int start = size - count;
+  ASSERT(0 < start && start < size, "Split leaves an empty page.");
+  std::vector<char> entries;
+  ExportEntries(0, size, &entries);
+  auto separator = reinterpret_cast<const GenericKey *>(entries.data() + start * entry_size);
+  recipient->Rebuild(entries.data() + start * entry_size, size - start, separator, GetHighFence());
+  Rebuild(entries.data(), start, GetLowFence(), separator);
 }
 
 /*****************************************************************************
@@ -150,27 +214,11 @@ void LeafPage::CopyNFrom(void *src, int size) {
  * If the key does not exist, then return false
  */
 /* Lookup */
-bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) {
-//  int size = GetSize();
-//  int now_key = KeyIndex(key, KM);
-//  if (now_key < size && KM.CompareKeys(key, KeyAt(now_key)) == 0) {
-//    value = ValueAt(now_key);
-//    return true;
-//  }
-//  return false;
-  // 优化为二分查找
-  int left = 0;
-  int right = GetSize() - 1;
-  while (left <= right) {
-    int mid = (left + right) / 2;
-    if (KM.CompareKeys(key, KeyAt(mid)) == 0) {
-      value = ValueAt(mid);
-      return true;
-    } else if (KM.CompareKeys(key, KeyAt(mid)) > 0) {
-      left = mid + 1;
-    } else {
-      right = mid - 1;
-    }
+bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM) const {
+  int index = KeyIndex(key, KM);
+  if (index < GetSize() && CompareKeyAt(index, key, KM) == 0) {
+    value = ValueAt(index);
+    return true;
   }
   return false;
 }
@@ -188,11 +236,9 @@ bool LeafPage::Lookup(const GenericKey *key, RowId &value, const KeyManager &KM)
 int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM) {
   int size = GetSize();
   int now_key = KeyIndex(key, KM);
-  if (now_key < size && KM.CompareKeys(key, KeyAt(now_key)) == 0) {
-    for (int i = now_key; i < size - 1; i++) {
-      SetKeyAt(i, KeyAt(i + 1));
-      SetValueAt(i, ValueAt(i + 1));
-    }
+  if (now_key < size && CompareKeyAt(now_key, key, KM) == 0) {
+    memmove(SuffixAt(now_key), SuffixAt(now_key + 1), (size - now_key - 1) * SuffixSize());
+    memmove(ValuePtrAt(now_key), ValuePtrAt(now_key + 1), (size - now_key - 1) * sizeof(RowId));
     IncreaseSize(-1);
     return GetSize();
   } else
@@ -205,11 +251,15 @@ int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM)
 /*
  * Remove all key & value pairs from this page to "recipient" page. Don't forget
  * to update the next_page id in the sibling page
+ * The recipient is the left sibling, its range extends to the high fence of this page.
  */
 /* MoveAllTo */
 void LeafPage::MoveAllTo(LeafPage *recipient) {
-  int size = GetSize();
-  recipient->CopyNFrom(pairs_off, size);
+  std::vector<char> entries;
+  recipient->ExportEntries(0, recipient->GetSize(), &entries);
+  ExportEntries(0, GetSize(), &entries);
+  recipient->Rebuild(entries.data(), recipient->GetSize() + GetSize(), recipient->GetLowFence(), GetHighFence());
+  recipient->SetNextPageId(GetNextPageId());
   SetSize(0);
 }
 
@@ -218,47 +268,30 @@ void LeafPage::MoveAllTo(LeafPage *recipient) {
  *****************************************************************************/
 /*
  * Remove the first key & value pair from this page to "recipient" page.
- *
+ * The recipient is the left sibling, the new first key of this page becomes the separator.
  */
 /* MoveFirstToEndOf */
 void LeafPage::MoveFirstToEndOf(LeafPage *recipient) {
-  int size = GetSize();
-  recipient->CopyLastFrom(KeyAt(0), ValueAt(0));
-  IncreaseSize(-1);
-  for (int i = 0; i < size - 1; i++) {
-    SetKeyAt(i, KeyAt(i + 1));
-    SetValueAt(i, ValueAt(i + 1));
-  }
-}
-/*
- * Copy the item into the end of my item list. (Append item to my array)
- */
-/* CopyLastFrom */
-void LeafPage::CopyLastFrom(GenericKey *key, const RowId value) {
-  int size = GetSize();
-  SetKeyAt(size, key);
-  SetValueAt(size, value);
-  IncreaseSize(1);
+  std::vector<char> left, right;
+  recipient->ExportEntries(0, recipient->GetSize(), &left);
+  ExportEntries(0, 1, &left);
+  ExportEntries(1, GetSize(), &right);
+  auto separator = reinterpret_cast<const GenericKey *>(right.data());
+  recipient->Rebuild(left.data(), recipient->GetSize() + 1, recipient->GetLowFence(), separator);
+  Rebuild(right.data(), GetSize() - 1, separator, GetHighFence());
 }
 /*
  * Remove the last key & value pair from this page to "recipient" page.
+ * The recipient is the right sibling, the moved key becomes the separator.
  */
 /* MoveLastToFrontOf */
 void LeafPage::MoveLastToFrontOf(LeafPage *recipient) {
   int size = GetSize();
-  recipient->CopyFirstFrom(KeyAt(size - 1), ValueAt(size - 1));
-  IncreaseSize(-1);
+  std::vector<char> left, right;
+  ExportEntries(0, size - 1, &left);
+  ExportEntries(size - 1, size, &right);
+  recipient->ExportEntries(0, recipient->GetSize(), &right);
+  auto separator = reinterpret_cast<const GenericKey *>(right.data());
+  recipient->Rebuild(right.data(), recipient->GetSize() + 1, separator, recipient->GetHighFence());
+  Rebuild(left.data(), size - 1, GetLowFence(), separator);
 }
-/*
- * Insert item at the front of my items. Move items accordingly.
- */
-void LeafPage::CopyFirstFrom(GenericKey *key, const RowId value) {
-  int size = GetSize();
-  for (int i = size - 1; i >= 0; i--) {
-    SetKeyAt(i + 1, KeyAt(i));
-    SetValueAt(i + 1, ValueAt(i));
-  }
-  SetKeyAt(0, key);
-  SetValueAt(0, value);
-  IncreaseSize(1);
-}
\ No newline at end of file
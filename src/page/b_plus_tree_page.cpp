@@ -12,14 +12,6 @@ bool BPlusTreePage::IsLeafPage() const {
     return false;
 }
 
-/* IsRootPage */
-bool BPlusTreePage::IsRootPage() const {
-  if (parent_page_id_ == INVALID_FRAME_ID)
-    return true;
-  else
-    return false;
-}
-
 /* SetPageType */
 void BPlusTreePage::SetPageType(IndexPageType page_type) {
   page_type_ = page_type;
@@ -68,22 +60,7 @@ void BPlusTreePage::SetMaxSize(int size) {
 /* GetMinSize */
 int BPlusTreePage::GetMinSize() const {
 //  return max_size_ / 2;
-  if(IsRootPage())
-    return IsLeafPage()?1:2;
-  else
-    return (max_size_+1)/2;
-}
-
-/*
- * Helper methods to get/set parent page id
- */
-/* GetParentPageId */
-page_id_t BPlusTreePage::GetParentPageId() const {
-  return parent_page_id_;
-}
-
-void BPlusTreePage::SetParentPageId(page_id_t parent_page_id) {
-  parent_page_id_ = parent_page_id;
+  return (max_size_+1)/2;
 }
 
 /*
@@ -0,0 +1,26 @@
+#include "page/hash_table_bucket_page.h"
+
+RowId HashTableBucketPage::ValueAt(uint32_t index, uint32_t key_size) const {
+  return MACH_READ_FROM(RowId, data_ + index * (key_size + sizeof(RowId)) + key_size);
+}
+
+void HashTableBucketPage::Append(const GenericKey *key, const RowId &value, uint32_t key_size) {
+  ASSERT(size_ < Capacity(key_size), "Append to a full bucket.");
+  char *entry = data_ + size_ * (key_size + sizeof(RowId));
+  memcpy(entry, key, key_size);
+  MACH_WRITE_TO(RowId, entry + key_size, value);
+  size_++;
+}
+
+void HashTableBucketPage::RemoveAt(uint32_t index, uint32_t key_size) {
+  uint32_t entry_size = key_size + sizeof(RowId);
+  if (index != size_ - 1) {
+    memcpy(data_ + index * entry_size, data_ + (size_ - 1) * entry_size, entry_size);
+  }
+  size_--;
+}
+
+void HashTableBucketPage::MoveLastTo(HashTableBucketPage *recipient, uint32_t key_size) {
+  recipient->Append(KeyAt(size_ - 1, key_size), ValueAt(size_ - 1, key_size), key_size);
+  size_--;
+}
@@ -0,0 +1,60 @@
+#include "page/hash_table_directory_page.h"
+
+#include <unordered_map>
+
+void HashTableDirectoryPage::Init(page_id_t page_id, page_id_t bucket_page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  global_depth_ = 0;
+  local_depths_[0] = 0;
+  bucket_page_ids_[0] = bucket_page_id;
+}
+
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  uint32_t size = Size();
+  for (uint32_t i = 0; i < size; i++) {
+    local_depths_[size + i] = local_depths_[i];
+    bucket_page_ids_[size + i] = bucket_page_ids_[i];
+  }
+  global_depth_++;
+}
+
+bool HashTableDirectoryPage::CanShrink() const {
+  if (global_depth_ == 0) {
+    return false;
+  }
+  for (uint32_t i = 0; i < Size(); i++) {
+    if (local_depths_[i] >= global_depth_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HashTableDirectoryPage::VerifyIntegrity() const {
+  // 局部深度为d的桶恰好被2^(global - d)个低d位相同的槽共享
+  std::unordered_map<page_id_t, uint32_t> counts;
+  std::unordered_map<page_id_t, uint32_t> first_slot;
+  for (uint32_t i = 0; i < Size(); i++) {
+    if (local_depths_[i] > global_depth_) {
+      return false;
+    }
+    page_id_t page_id = bucket_page_ids_[i];
+    auto iter = first_slot.find(page_id);
+    if (iter == first_slot.end()) {
+      first_slot[page_id] = i;
+    } else {
+      uint32_t mask = (1U << local_depths_[i]) - 1;
+      if (local_depths_[iter->second] != local_depths_[i] || (iter->second & mask) != (i & mask)) {
+        return false;
+      }
+    }
+    counts[page_id]++;
+  }
+  for (auto &entry : counts) {
+    if (entry.second != 1U << (global_depth_ - local_depths_[first_slot[entry.first]])) {
+      return false;
+    }
+  }
+  return true;
+}
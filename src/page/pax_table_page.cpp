@@ -0,0 +1,190 @@
+#include "page/pax_table_page.h"
+
+void PaxTablePage::Init(page_id_t page_id, page_id_t prev_id, Schema *schema, [[maybe_unused]] LogManager *log_mgr,
+                        [[maybe_unused]] Transaction *txn) {
+    memcpy(GetData(), &page_id, sizeof(page_id));
+    SetPrevPageId(prev_id);
+    SetNextPageId(INVALID_PAGE_ID);
+    SetTupleCount(0);
+    uint32_t column_count = schema->GetColumnCount();
+    memcpy(GetData() + OFFSET_COLUMN_COUNT, &column_count, sizeof(uint32_t));
+    // 每条记录占用: 1字节slot状态 + 每列(1字节null标记 + 定长值)
+    uint32_t header_size = AlignUp(SIZE_PAX_PAGE_HEADER + column_count * sizeof(uint32_t));
+    uint32_t tuple_size = 1;
+    for (auto column : schema->GetColumns()) {
+        tuple_size += 1 + GetValueWidth(column);
+    }
+    // 每个minipage两段各自8字节对齐，最多浪费 2 * 7 字节
+    uint32_t padding = 16 * (column_count + 1);
+    uint32_t capacity = PAGE_SIZE > header_size + padding ? (PAGE_SIZE - header_size - padding) / tuple_size : 0;
+    memcpy(GetData() + OFFSET_CAPACITY, &capacity, sizeof(uint32_t));
+    // 划分minipage
+    uint32_t offset = header_size + AlignUp(capacity);
+    for (uint32_t i = 0; i < column_count; i++) {
+        memcpy(GetData() + OFFSET_MINIPAGE + i * sizeof(uint32_t), &offset, sizeof(uint32_t));
+        offset += AlignUp(capacity) + AlignUp(capacity * GetValueWidth(schema->GetColumn(i)));
+    }
+    ASSERT(offset <= PAGE_SIZE, "Pax minipages exceed page size.");
+    memset(GetSlotStates(), SLOT_EMPTY, capacity);
+}
+
+uint32_t PaxTablePage::GetValueWidth(const Column *column) {
+    if (column->GetType() == TypeId::kTypeChar) {
+        return sizeof(uint32_t) + column->GetLength();
+    }
+    return Type::GetTypeSize(column->GetType());
+}
+
+bool PaxTablePage::RowFits(const Row &row, Schema *schema) {
+    if (row.GetFieldCount() != schema->GetColumnCount()) {
+        return false;
+    }
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+        const Column *column = schema->GetColumn(i);
+        Field *field = row.GetField(i);
+        if (column->GetType() == TypeId::kTypeChar && !field->IsNull() && field->GetLength() > column->GetLength()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PaxTablePage::WriteField(uint32_t slot_num, uint32_t column_id, const Column *column, const Field *field) {
+    GetColumnNulls(column_id)[slot_num] = field->IsNull();
+    if (!field->IsNull()) {
+        field->SerializeTo(GetColumnValues(column_id) + slot_num * GetValueWidth(column));
+    }
+}
+
+uint32_t PaxTablePage::ReadField(uint32_t slot_num, uint32_t column_id, const Column *column, Field **field,
+                                 Arena *arena) {
+    bool is_null = GetColumnNulls(column_id)[slot_num];
+    return Field::DeserializeFrom(GetColumnValues(column_id) + slot_num * GetValueWidth(column), column->GetType(),
+                                  field, is_null, arena);
+}
+
+bool PaxTablePage::InsertTuple(Row &row, Schema *schema, [[maybe_unused]] Transaction *txn,
+                               [[maybe_unused]] LockManager *lock_manager, [[maybe_unused]] LogManager *log_manager) {
+    if (!RowFits(row, schema)) {
+        return false;
+    }
+    // 优先复用空slot
+    char *states = GetSlotStates();
+    uint32_t i;
+    for (i = 0; i < GetTupleCount(); i++) {
+        if (states[i] == SLOT_EMPTY) {
+            break;
+        }
+    }
+    if (i == GetTupleCount() && GetTupleCount() >= GetCapacity()) {
+        return false;
+    }
+    for (uint32_t col = 0; col < schema->GetColumnCount(); col++) {
+        WriteField(i, col, schema->GetColumn(col), row.GetField(col));
+    }
+    states[i] = SLOT_LIVE;
+    row.SetRowId(RowId(GetTablePageId(), i));
+    if (i == GetTupleCount()) {
+        SetTupleCount(GetTupleCount() + 1);
+    }
+    return true;
+}
+
+bool PaxTablePage::MarkDelete(const RowId &rid, [[maybe_unused]] Transaction *txn,
+                              [[maybe_unused]] LockManager *lock_manager, [[maybe_unused]] LogManager *log_manager) {
+    uint32_t slot_num = rid.GetSlotNum();
+    if (slot_num >= GetTupleCount() || GetSlotStates()[slot_num] != SLOT_LIVE) {
+        return false;
+    }
+    GetSlotStates()[slot_num] = SLOT_DELETED;
+    return true;
+}
+
+bool PaxTablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Transaction *txn,
+                               LockManager *lock_manager, [[maybe_unused]] LogManager *log_manager) {
+    ASSERT(old_row != nullptr && old_row->GetRowId().Get() != INVALID_ROWID.Get(), "invalid old row.");
+    uint32_t slot_num = old_row->GetRowId().GetSlotNum();
+    // 定长存储，只要每列放得下就能原地更新
+    if (slot_num >= GetTupleCount() || GetSlotStates()[slot_num] != SLOT_LIVE || !RowFits(new_row, schema)) {
+        return false;
+    }
+    GetTuple(old_row, schema, txn, lock_manager);
+    for (uint32_t col = 0; col < schema->GetColumnCount(); col++) {
+        WriteField(slot_num, col, schema->GetColumn(col), new_row.GetField(col));
+    }
+    return true;
+}
+
+void PaxTablePage::ApplyDelete(const RowId &rid, [[maybe_unused]] Transaction *txn,
+                               [[maybe_unused]] LogManager *log_manager) {
+    uint32_t slot_num = rid.GetSlotNum();
+    ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
+    GetSlotStates()[slot_num] = SLOT_EMPTY;
+}
+
+void PaxTablePage::RollbackDelete(const RowId &rid, [[maybe_unused]] Transaction *txn,
+                                  [[maybe_unused]] LogManager *log_manager) {
+    uint32_t slot_num = rid.GetSlotNum();
+    ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
+    if (GetSlotStates()[slot_num] == SLOT_DELETED) {
+        GetSlotStates()[slot_num] = SLOT_LIVE;
+    }
+}
+
+bool PaxTablePage::GetTuple(Row *row, Schema *schema, [[maybe_unused]] Transaction *txn,
+                            [[maybe_unused]] LockManager *lock_manager) {
+    ASSERT(row != nullptr && row->GetRowId().Get() != INVALID_ROWID.Get(), "Invalid row.");
+    ASSERT(row->GetFields().empty(), "Non empty field in row.");
+    uint32_t slot_num = row->GetRowId().GetSlotNum();
+    if (slot_num >= GetTupleCount() || GetSlotStates()[slot_num] != SLOT_LIVE) {
+        return false;
+    }
+    auto &fields = row->GetFields();
+    fields.resize(schema->GetColumnCount(), nullptr);
+    for (uint32_t col = 0; col < schema->GetColumnCount(); col++) {
+        ReadField(slot_num, col, schema->GetColumn(col), &fields[col], row->GetArena());
+    }
+    return true;
+}
+
+bool PaxTablePage::GetTuple(Row *row, Schema *schema, const std::vector<uint32_t> &column_ids,
+                            [[maybe_unused]] Transaction *txn, [[maybe_unused]] LockManager *lock_manager) {
+    ASSERT(row != nullptr && row->GetRowId().Get() != INVALID_ROWID.Get(), "Invalid row.");
+    ASSERT(row->GetFields().empty(), "Non empty field in row.");
+    uint32_t slot_num = row->GetRowId().GetSlotNum();
+    if (slot_num >= GetTupleCount() || GetSlotStates()[slot_num] != SLOT_LIVE) {
+        return false;
+    }
+    // 未引用列的minipage完全不会被访问
+    auto &fields = row->GetFields();
+    fields.resize(schema->GetColumnCount(), nullptr);
+    for (auto col : column_ids) {
+        ReadField(slot_num, col, schema->GetColumn(col), &fields[col], row->GetArena());
+    }
+    return true;
+}
+
+bool PaxTablePage::GetFirstTupleRid(RowId *first_rid) {
+    char *states = GetSlotStates();
+    for (uint32_t i = 0; i < GetTupleCount(); i++) {
+        if (states[i] == SLOT_LIVE) {
+            first_rid->Set(GetTablePageId(), i);
+            return true;
+        }
+    }
+    first_rid->Set(INVALID_PAGE_ID, 0);
+    return false;
+}
+
+bool PaxTablePage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
+    ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
+    char *states = GetSlotStates();
+    for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); i++) {
+        if (states[i] == SLOT_LIVE) {
+            next_rid->Set(GetTablePageId(), i);
+            return true;
+        }
+    }
+    next_rid->Set(INVALID_PAGE_ID, 0);
+    return false;
+}
@@ -67,28 +67,84 @@ bool TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Tr
     uint32_t serialized_size = new_row.GetSerializedSize(schema);
     ASSERT(serialized_size > 0, "Can not have empty row.");
     uint32_t slot_num = old_row->GetRowId().GetSlotNum();
+    //越界、已删除、转发slot或者没有空余空间可以更新
+    if (slot_num >= GetTupleCount())
+        return false;
     uint32_t tuple_size = GetTupleSize(slot_num);
-    //越界或者没有空余空间可以更新
-    if (slot_num >= GetTupleCount()||IsDeleted(tuple_size)||(GetFreeSpaceRemaining() + tuple_size < serialized_size))
+    if (IsDeleted(tuple_size) || IsForwarded(tuple_size) ||
+        GetFreeSpaceRemaining() + GetLength(tuple_size) < serialized_size)
         return false;
     //拷贝旧值
+    uint32_t __attribute__((unused)) read_bytes =
+        old_row->DeserializeFrom(GetData() + GetTupleOffsetAtSlot(slot_num), schema);
+    ASSERT(GetLength(tuple_size) == read_bytes, "Tuple deserialize error.");
+    new_row.SerializeTo(ResizeTuple(slot_num, serialized_size), schema);
+    return true;
+}
+
+char *TablePage::ResizeTuple(uint32_t slot_num, uint32_t new_size) {
+    uint32_t tuple_size = GetTupleSize(slot_num);
+    uint32_t length = GetLength(tuple_size);
     uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-    uint32_t __attribute__((unused)) read_bytes = old_row->DeserializeFrom(GetData() + tuple_offset, schema);
-    ASSERT(tuple_size == read_bytes, "Tuple deserialize error.");
     uint32_t free_space_pointer = GetFreeSpacePointer();
     ASSERT(tuple_offset >= free_space_pointer, "Offset error.");
-    memmove(GetData() + free_space_pointer + tuple_size - serialized_size, GetData() + free_space_pointer,
+    ASSERT(GetFreeSpaceRemaining() + length >= new_size, "Not enough space to resize tuple.");
+    // 本元组之前的数据整体平移，元组尾部位置不变
+    memmove(GetData() + free_space_pointer + length - new_size, GetData() + free_space_pointer,
             tuple_offset - free_space_pointer);
-    SetFreeSpacePointer(free_space_pointer + tuple_size - serialized_size);
-    new_row.SerializeTo(GetData() + tuple_offset + tuple_size - serialized_size, schema);
-    SetTupleSize(slot_num, serialized_size);
-    // 更新所有的元组
+    SetFreeSpacePointer(free_space_pointer + length - new_size);
     for (uint32_t i = 0; i < GetTupleCount(); ++i) {
         uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-        if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-            SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_row.GetSerializedSize(schema));
+        if (GetTupleSize(i) != 0 && tuple_offset_i <= tuple_offset) {
+            SetTupleOffsetAtSlot(i, tuple_offset_i + length - new_size);
         }
     }
+    SetTupleSize(slot_num, (tuple_size & ~LENGTH_MASK) | new_size);
+    return GetData() + GetTupleOffsetAtSlot(slot_num);
+}
+
+void TablePage::ReencodeTuples(Schema *old_schema, Schema *new_schema, const std::function<void(Row *)> &convert) {
+    std::vector<char> buf(PAGE_SIZE);
+    for (uint32_t i = 0; i < GetTupleCount(); i++) {
+        uint32_t tuple_size = GetTupleSize(i);
+        if (GetLength(tuple_size) == 0 || IsForwarded(tuple_size))
+            continue;
+        Row row(RowId(GetTablePageId(), i));
+        row.DeserializeFrom(GetData() + GetTupleOffsetAtSlot(i), old_schema);
+        convert(&row);
+        uint32_t new_size = row.SerializeTo(buf.data(), new_schema);
+        ASSERT(new_size <= GetLength(tuple_size), "Reencoded tuple must not grow.");
+        memcpy(ResizeTuple(i, new_size), buf.data(), new_size);
+    }
+}
+
+bool TablePage::InsertMovedTuple(Row &row, Schema *schema, Transaction *txn, LockManager *lock_manager,
+                                 LogManager *log_manager) {
+    if (!InsertTuple(row, schema, txn, lock_manager, log_manager)) {
+        return false;
+    }
+    uint32_t slot_num = row.GetRowId().GetSlotNum();
+    SetTupleSize(slot_num, GetTupleSize(slot_num) | MOVED_MASK);
+    return true;
+}
+
+void TablePage::SetForward(const RowId &rid, const RowId &target) {
+    uint32_t slot_num = rid.GetSlotNum();
+    ASSERT(slot_num < GetTupleCount() && !IsDeleted(GetTupleSize(slot_num)), "Invalid forward slot.");
+    // 行记录至少包含一个RowId大小的头，缩小到一个RowId一定放得下
+    int64_t value = target.Get();
+    memcpy(ResizeTuple(slot_num, sizeof(value)), &value, sizeof(value));
+    SetTupleSize(slot_num, GetTupleSize(slot_num) | FORWARD_MASK);
+}
+
+bool TablePage::GetForward(const RowId &rid, RowId *target) {
+    uint32_t slot_num = rid.GetSlotNum();
+    if (slot_num >= GetTupleCount() || !IsForwarded(GetTupleSize(slot_num))) {
+        return false;
+    }
+    int64_t value;
+    memcpy(&value, GetData() + GetTupleOffsetAtSlot(slot_num), sizeof(value));
+    *target = RowId(value);
     return true;
 }
 
@@ -97,11 +153,8 @@ void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_
     ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
 
     uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-    uint32_t tuple_size = GetTupleSize(slot_num);
-    // Check if this is a delete operation, i.e. commit a delete.
-    if (IsDeleted(tuple_size)) {
-        tuple_size = UnsetDeletedFlag(tuple_size);
-    }
+    // Strip the delete/forward/moved flags, only the length matters here.
+    uint32_t tuple_size = GetLength(GetTupleSize(slot_num));
 
     uint32_t free_space_pointer = GetFreeSpacePointer();
     ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
@@ -109,8 +162,8 @@ void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_
     memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
             tuple_offset - free_space_pointer);
     SetFreeSpacePointer(free_space_pointer + tuple_size);
+    // 空slot留给之后的插入复用，不能减少TupleCount，否则最后一个slot会丢失
     SetTupleSize(slot_num, 0);
-    SetTupleCount(GetTupleCount() - 1);
     SetTupleOffsetAtSlot(slot_num, 0);
 
     // Update all tuple offsets.
@@ -143,21 +196,55 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager
     }
     // Otherwise get the current tuple size too.
     uint32_t tuple_size = GetTupleSize(slot_num);
-    // If the tuple is deleted, abort the transaction.
-    if (IsDeleted(tuple_size)) {
+    // If the tuple is deleted, abort the transaction. A forwarding slot has to be followed by the caller.
+    if (IsDeleted(tuple_size) || IsForwarded(tuple_size)) {
         return false;
     }
     // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
     uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
     uint32_t __attribute__((unused)) read_bytes = row->DeserializeFrom(GetData() + tuple_offset, schema);
-    ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
+    ASSERT(GetLength(tuple_size) == read_bytes, "Unexpected behavior in tuple deserialize.");
+    // 序列化时row还没有rid，以slot位置为准
+    row->SetRowId(RowId(GetTablePageId(), slot_num));
+    return true;
+}
+
+bool TablePage::GetTuple(Row *row, Schema *schema, const std::vector<uint32_t> &column_ids, Transaction *txn,
+                         LockManager *lock_manager) {
+    ASSERT(row != nullptr && row->GetRowId().Get() != INVALID_ROWID.Get(), "Invalid row.");
+    uint32_t slot_num = row->GetRowId().GetSlotNum();
+    if (slot_num >= GetTupleCount()) {
+        return false;
+    }
+    uint32_t tuple_size = GetTupleSize(slot_num);
+    if (IsDeleted(tuple_size) || IsForwarded(tuple_size)) {
+        return false;
+    }
+    uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+    uint32_t __attribute__((unused)) read_bytes = row->DeserializeFrom(GetData() + tuple_offset, schema, column_ids);
+    ASSERT(read_bytes <= GetLength(tuple_size), "Unexpected behavior in tuple deserialize.");
+    row->SetRowId(RowId(GetTablePageId(), slot_num));
+    return true;
+}
+
+bool TablePage::GetTupleBody(Row *row, Schema *schema) {
+    uint32_t slot_num = row->GetRowId().GetSlotNum();
+    if (slot_num >= GetTupleCount()) {
+        return false;
+    }
+    uint32_t tuple_size = GetTupleSize(slot_num);
+    if (GetLength(tuple_size) == 0 || IsForwarded(tuple_size)) {
+        return false;
+    }
+    row->DeserializeFrom(GetData() + GetTupleOffsetAtSlot(slot_num), schema);
     return true;
 }
 
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
     // Find and return the first valid tuple.
     for (uint32_t i = 0; i < GetTupleCount(); i++) {
-        if (!IsDeleted(GetTupleSize(i))) {
+        // 迁移过来的记录由原slot转发访问
+        if (!IsDeleted(GetTupleSize(i)) && !IsMoved(GetTupleSize(i))) {
             first_rid->Set(GetTablePageId(), i);
             return true;
         }
@@ -170,7 +257,7 @@ bool TablePage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
     ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
     // Find and return the first valid tuple after our current slot number.
     for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); i++) {
-        if (!IsDeleted(GetTupleSize(i))) {
+        if (!IsDeleted(GetTupleSize(i)) && !IsMoved(GetTupleSize(i))) {
             next_rid->Set(GetTablePageId(), i);
             return true;
         }
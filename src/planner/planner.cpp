@@ -39,17 +39,72 @@ AbstractPlanNodeRef Planner::PlanSelect(std::shared_ptr<SelectStatement> stateme
   vector<IndexInfo *> indexes;
   vector<IndexInfo *> available_index;
   context_->GetCatalog()->GetTableIndexes(statement->table_name_, indexes);
+  // 条件中出现索引的第一列时索引可以缩小扫描范围，其余列由执行器按前缀匹配
+  // 哈希索引只能查找等值，需要每个key列都有类型相同的等值条件
+  std::vector<std::pair<uint32_t, const Field *>> equalities;
+  CollectEqualities(statement->where_, equalities);
   for (auto index : indexes) {
-    if (index->GetIndexKeySchema()->GetColumns().size() == 1) {
-      auto col_id = index->GetIndexKeySchema()->GetColumn(0)->GetTableInd();
-      if (std::find(statement->column_in_condition_.begin(), statement->column_in_condition_.end(), col_id) !=
-          statement->column_in_condition_.end()) {
+    if (index->GetIndexType() == "hash") {
+      bool all_equal = true;
+      for (uint32_t i = 0; i < index->GetKeyColumnCount() && all_equal; i++) {
+        const Column *key_column = index->GetIndexKeySchema()->GetColumn(i);
+        all_equal = std::any_of(equalities.begin(), equalities.end(), [&](const auto &equality) {
+          const Field *val = equality.second;
+          return equality.first == key_column->GetTableInd() && val->GetTypeId() == key_column->GetType() &&
+                 (val->GetTypeId() != TypeId::kTypeChar || val->GetLength() <= key_column->GetLength());
+        });
+      }
+      if (all_equal) {
         available_index.push_back(index);
       }
+      continue;
+    }
+    auto col_id = index->GetIndexKeySchema()->GetColumn(0)->GetTableInd();
+    if (std::find(statement->column_in_condition_.begin(), statement->column_in_condition_.end(), col_id) !=
+        statement->column_in_condition_.end()) {
+      available_index.push_back(index);
+    }
+  }
+  TableInfo *info = nullptr;
+  context_->GetCatalog()->GetTable(statement->table_name_, info);
+  // ANALYZE过的表，谓词选不出足够少的行时顺序扫描更便宜
+  TableStatistics *stats = info->GetStatistics();
+  bool index_worthwhile =
+      !stats->IsAnalyzed() || EstimateSelectivity(statement->where_, stats) <= STATS_INDEX_MAX_SELECTIVITY;
+  // 投影下推：只解码输出列和谓词中引用的列
+  std::vector<uint32_t> output_ids;
+  for (const auto &column : statement->column_list_) {
+    output_ids.push_back(dynamic_pointer_cast<ColumnValueExpression>(column.second)->GetColIdx());
+  }
+  std::vector<uint32_t> column_ids(output_ids);
+  CollectColumnIds(statement->where_, column_ids);
+  std::sort(column_ids.begin(), column_ids.end());
+  column_ids.erase(std::unique(column_ids.begin(), column_ids.end()), column_ids.end());
+  if (available_index.empty() || statement->has_or || !index_worthwhile) {
+    if (column_ids.size() == info->GetSchema()->GetColumnCount()) {
+      column_ids.clear();
+    }
+    return make_shared<SeqScanPlanNode>(out_schema, statement->table_name_, statement->where_, std::move(column_ids),
+                                        std::move(output_ids));
+  }
+  // 索引的列(包括INCLUDE列)覆盖了用到的全部列时只扫描索引，不回表
+  vector<IndexInfo *> covering_index;
+  for (auto index : available_index) {
+    if (index->GetIndexType() != "bptree") {
+      continue;
+    }
+    std::vector<uint32_t> index_columns;
+    for (auto column : index->GetIndexKeySchema()->GetColumns()) {
+      index_columns.push_back(column->GetTableInd());
+    }
+    std::sort(index_columns.begin(), index_columns.end());
+    if (std::includes(index_columns.begin(), index_columns.end(), column_ids.begin(), column_ids.end())) {
+      covering_index.push_back(index);
     }
   }
-  if (available_index.empty() || statement->has_or) {
-    return make_shared<SeqScanPlanNode>(out_schema, statement->table_name_, statement->where_);
+  if (!covering_index.empty()) {
+    return make_shared<IndexScanPlanNode>(out_schema, statement->table_name_, covering_index, true, statement->where_,
+                                          true);
   }
   return make_shared<IndexScanPlanNode>(out_schema, statement->table_name_, available_index,
                                         available_index.size() != statement->column_in_condition_.size(),
@@ -90,3 +145,89 @@ Schema *Planner::MakeOutputSchema(const vector<std::pair<std::string, AbstractEx
   }
   return new Schema(cols);
 }
+
+void Planner::CollectColumnIds(const AbstractExpressionRef &expr, std::vector<uint32_t> &column_ids) {
+  if (expr == nullptr) {
+    return;
+  }
+  if (expr->GetType() == ExpressionType::ColumnExpression) {
+    column_ids.push_back(dynamic_pointer_cast<ColumnValueExpression>(expr)->GetColIdx());
+    return;
+  }
+  for (const auto &child : expr->GetChildren()) {
+    CollectColumnIds(child, column_ids);
+  }
+}
+
+void Planner::CollectEqualities(const AbstractExpressionRef &expr,
+                                std::vector<std::pair<uint32_t, const Field *>> &equalities) {
+  if (expr == nullptr) {
+    return;
+  }
+  if (expr->GetType() == ExpressionType::LogicExpression) {
+    if (dynamic_cast<LogicExpression *>(expr.get())->logic_type_ == LogicType::And) {
+      for (const auto &child : expr->GetChildren()) {
+        CollectEqualities(child, equalities);
+      }
+    }
+    return;
+  }
+  if (expr->GetType() != ExpressionType::ComparisonExpression ||
+      dynamic_cast<ComparisonExpression *>(expr.get())->GetComparisonType() != "=") {
+    return;
+  }
+  auto lhs = expr->GetChildAt(0);
+  auto rhs = expr->GetChildAt(1);
+  if (lhs->GetType() == ExpressionType::ConstantExpression) {
+    std::swap(lhs, rhs);
+  }
+  if (lhs->GetType() != ExpressionType::ColumnExpression || rhs->GetType() != ExpressionType::ConstantExpression) {
+    return;
+  }
+  const Field *val = &dynamic_cast<ConstantValueExpression *>(rhs.get())->val_;
+  if (!val->IsNull()) {
+    equalities.emplace_back(dynamic_cast<ColumnValueExpression *>(lhs.get())->GetColIdx(), val);
+  }
+}
+
+double Planner::EstimateSelectivity(const AbstractExpressionRef &expr, const TableStatistics *stats) {
+  if (expr == nullptr) {
+    return 1;
+  }
+  switch (expr->GetType()) {
+    case ExpressionType::LogicExpression: {
+      // 假设各条件相互独立
+      auto logic = dynamic_cast<LogicExpression *>(expr.get());
+      double lhs = EstimateSelectivity(expr->GetChildAt(0), stats);
+      double rhs = EstimateSelectivity(expr->GetChildAt(1), stats);
+      return logic->logic_type_ == LogicType::And ? lhs * rhs : lhs + rhs - lhs * rhs;
+    }
+    case ExpressionType::ComparisonExpression: {
+      auto comparison = dynamic_cast<ComparisonExpression *>(expr.get());
+      std::string op = comparison->GetComparisonType();
+      auto lhs = expr->GetChildAt(0);
+      auto rhs = expr->GetChildAt(1);
+      if (lhs->GetType() == ExpressionType::ConstantExpression && rhs->GetType() == ExpressionType::ColumnExpression) {
+        std::swap(lhs, rhs);
+        static const std::unordered_map<std::string, std::string> flip{
+            {"<", ">"}, {">", "<"}, {"<=", ">="}, {">=", "<="}, {"=", "="}, {"<>", "<>"}};
+        auto iter = flip.find(op);
+        if (iter == flip.end()) {
+          return 1;
+        }
+        op = iter->second;
+      }
+      if (lhs->GetType() != ExpressionType::ColumnExpression || rhs->GetType() != ExpressionType::ConstantExpression) {
+        return 1;
+      }
+      auto column = dynamic_cast<ColumnValueExpression *>(lhs.get());
+      auto constant = dynamic_cast<ConstantValueExpression *>(rhs.get());
+      if (column->GetColIdx() >= stats->GetColumnCount()) {
+        return 1;
+      }
+      return stats->GetColumnStatistics(column->GetColIdx()).EstimateSelectivity(op, constant->val_);
+    }
+    default:
+      return 1;
+  }
+}
@@ -11,9 +11,12 @@ uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
   uint32_t column_count = schema->GetColumnCount();
   uint32_t i;
   for(i=0;i<column_count;i++){
-    MACH_WRITE_TO(bool,buf+offset,fields_[i]->IsNull());
+    bool is_null = fields_[i]->IsNull();
+    MACH_WRITE_TO(bool,buf+offset,is_null);
     offset += sizeof(bool);
-    offset += fields_[i]->SerializeTo(buf+offset);
+    if (!is_null) {
+      offset += schema->GetKernels(i).serialize_to(*fields_[i], buf + offset);
+    }
   }
   return offset;
 }
@@ -25,15 +28,50 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
   this->rid_ = MACH_READ_FROM(RowId, buf+offset);
   offset += sizeof(RowId);
   uint32_t column_count = schema->GetColumnCount();
-  if(column_count>fields_.capacity()) fields_.resize(column_count);
+  fields_.resize(column_count);
   for (uint32_t i = 0; i < column_count; ++i) {
     bool is_null = MACH_READ_FROM(bool,buf+offset);
     offset += sizeof(bool);
-    const Column *temp = schema->GetColumn(i);
-    offset += this->fields_[i]->DeserializeFrom(buf + offset, temp->GetType(), &fields_[i],is_null);
+    offset += DeserializeField(buf + offset, schema, i, is_null);
   }
   return offset;
 }
+/*Row 投影反序列化，只解码column_ids中的列，其余列按长度跳过*/
+uint32_t Row::DeserializeFrom(char *buf, Schema *schema, const std::vector<uint32_t> &column_ids) {
+  uint32_t offset = 0;
+  ASSERT(schema != nullptr, "Schema should be null.");
+  ASSERT(fields_.empty(), "Non empty field in row.");
+  this->rid_ = MACH_READ_FROM(RowId, buf + offset);
+  offset += sizeof(RowId);
+  fields_.resize(schema->GetColumnCount(), nullptr);
+  uint32_t i = 0;
+  for (auto col_id : column_ids) {
+    ASSERT(col_id < schema->GetColumnCount() && col_id >= i, "Projection must be ascending column ids.");
+    // 跳过未被引用的列
+    for (; i < col_id; ++i) {
+      bool is_null = MACH_READ_FROM(bool, buf + offset);
+      offset += sizeof(bool);
+      if (is_null) continue;
+      offset += schema->GetKernels(i).get_stored_size(buf + offset);
+    }
+    bool is_null = MACH_READ_FROM(bool, buf + offset);
+    offset += sizeof(bool);
+    offset += DeserializeField(buf + offset, schema, i, is_null);
+    ++i;
+  }
+  return offset;
+}
+
+/*按列解码一个字段，null字段不占存储*/
+uint32_t Row::DeserializeField(char *buf, Schema *schema, uint32_t column_id, bool is_null) {
+  if (is_null) {
+    TypeId type = schema->GetColumn(column_id)->GetType();
+    fields_[column_id] = arena_ == nullptr ? new Field(type) : arena_->New<Field>(type);
+    return 0;
+  }
+  return schema->GetKernels(column_id).deserialize_from(buf, &fields_[column_id], arena_);
+}
+
 /*Row 序列化大小*/
 uint32_t Row::GetSerializedSize(Schema *schema) const {
     uint32_t offset = 0;
@@ -42,7 +80,9 @@ uint32_t Row::GetSerializedSize(Schema *schema) const {
   ASSERT(schema->GetColumnCount() == fields_.size(), "Fields size don't match schema's column size.");
   for (uint32_t i=0;i<colomn_count;++i) {
     offset += sizeof(bool);
-    offset += this->fields_[i]->GetSerializedSize();
+    if (!fields_[i]->IsNull()) {
+      offset += schema->GetKernels(i).get_serialized_size(*fields_[i]);
+    }
   }
   offset += sizeof(RowId);
   return offset;
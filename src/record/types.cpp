@@ -24,7 +24,7 @@ uint32_t Type::SerializeTo(const Field &field, char *buf) const {
   return 0;
 }
 
-uint32_t Type::DeserializeFrom(char *storage, Field **field, bool is_null) const {
+uint32_t Type::DeserializeFrom(char *storage, Field **field, bool is_null, [[maybe_unused]] Arena *arena) const {
   ASSERT(false, "DeserializeFrom not implemented.");
   return 0;
 }
@@ -84,13 +84,13 @@ uint32_t TypeInt::SerializeTo(const Field &field, char *buf) const {
   return 0;
 }
 
-uint32_t TypeInt::DeserializeFrom(char *storage, Field **field, bool is_null) const {
+uint32_t TypeInt::DeserializeFrom(char *storage, Field **field, bool is_null, Arena *arena) const {
   if (is_null) {
-    *field = new Field(TypeId::kTypeInt);
+    *field = arena == nullptr ? new Field(TypeId::kTypeInt) : arena->New<Field>(TypeId::kTypeInt);
     return 0;
   }
   int32_t val = MACH_READ_FROM(int32_t, storage);
-  *field = new Field(TypeId::kTypeInt, val);
+  *field = arena == nullptr ? new Field(TypeId::kTypeInt, val) : arena->New<Field>(TypeId::kTypeInt, val);
   return GetTypeSize(type_id_);
 }
 
@@ -159,13 +159,13 @@ uint32_t TypeFloat::SerializeTo(const Field &field, char *buf) const {
   return 0;
 }
 
-uint32_t TypeFloat::DeserializeFrom(char *storage, Field **field, bool is_null) const {
+uint32_t TypeFloat::DeserializeFrom(char *storage, Field **field, bool is_null, Arena *arena) const {
   if (is_null) {
-    *field = new Field(TypeId::kTypeFloat);
+    *field = arena == nullptr ? new Field(TypeId::kTypeFloat) : arena->New<Field>(TypeId::kTypeFloat);
     return 0;
   }
   float_t val = MACH_READ_FROM(float_t, storage);
-  *field = new Field(TypeId::kTypeFloat, val);
+  *field = arena == nullptr ? new Field(TypeId::kTypeFloat, val) : arena->New<Field>(TypeId::kTypeFloat, val);
   return GetTypeSize(type_id_);
 }
 
@@ -228,20 +228,27 @@ CmpBool TypeFloat::CompareGreaterThanEquals(const Field &left, const Field &righ
 uint32_t TypeChar::SerializeTo(const Field &field, char *buf) const {
   if (!field.IsNull()) {
     uint32_t len = GetLength(field);
-    memcpy(buf, &len, sizeof(uint32_t));
+    MACH_WRITE_UINT32(buf, field.IsOverflow() ? len | FIELD_OVERFLOW_FLAG : len);
     memcpy(buf + sizeof(uint32_t), field.value_.chars_, len);
     return len + sizeof(uint32_t);
   }
   return 0;
 }
 
-uint32_t TypeChar::DeserializeFrom(char *storage, Field **field, bool is_null) const {
+uint32_t TypeChar::DeserializeFrom(char *storage, Field **field, bool is_null, Arena *arena) const {
   if (is_null) {
-    *field = new Field(TypeId::kTypeChar);
+    *field = arena == nullptr ? new Field(TypeId::kTypeChar) : arena->New<Field>(TypeId::kTypeChar);
     return 0;
   }
   uint32_t len = MACH_READ_UINT32(storage);
-  *field = new Field(TypeId::kTypeChar, storage + sizeof(uint32_t), len, true);
+  bool overflow = (len & FIELD_OVERFLOW_FLAG) != 0;
+  len &= ~FIELD_OVERFLOW_FLAG;
+  if (arena == nullptr) {
+    *field = new Field(TypeId::kTypeChar, storage + sizeof(uint32_t), len, true);
+  } else {
+    *field = arena->New<Field>(TypeId::kTypeChar, arena, storage + sizeof(uint32_t), len);
+  }
+  (*field)->SetOverflow(overflow);
   return len + sizeof(uint32_t);
 }
 
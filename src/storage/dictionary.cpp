@@ -0,0 +1,138 @@
+#include "storage/dictionary.h"
+
+#include "common/macros.h"
+
+Dictionary *Dictionary::Create(BufferPoolManager *buffer_pool_manager) {
+  page_id_t page_id;
+  auto page = buffer_pool_manager->NewPage(page_id);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  MACH_WRITE_TO(page_id_t, page->GetData() + OFFSET_NEXT_PAGE_ID, INVALID_PAGE_ID);
+  MACH_WRITE_UINT32(page->GetData() + OFFSET_ENTRY_COUNT, 0);
+  buffer_pool_manager->UnpinPage(page_id, true);
+  return new Dictionary(buffer_pool_manager, page_id);
+}
+
+Dictionary *Dictionary::Load(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id) {
+  auto dictionary = new Dictionary(buffer_pool_manager, first_page_id);
+  page_id_t page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = buffer_pool_manager->FetchPage(page_id);
+    ASSERT(page != nullptr, "Fetch dictionary page failed!");
+    char *buf = page->GetData() + SIZE_HEADER;
+    uint32_t entry_count = MACH_READ_UINT32(page->GetData() + OFFSET_ENTRY_COUNT);
+    for (uint32_t i = 0; i < entry_count; i++) {
+      uint32_t len = MACH_READ_UINT32(buf);
+      buf += 4;
+      dictionary->codes_.emplace(std::string(buf, len), dictionary->values_.size());
+      dictionary->values_.emplace_back(buf, len);
+      buf += len;
+    }
+    dictionary->last_page_id_ = page_id;
+    dictionary->last_page_used_ = buf - page->GetData();
+    page_id_t next_page_id = MACH_READ_FROM(page_id_t, page->GetData() + OFFSET_NEXT_PAGE_ID);
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return dictionary;
+}
+
+int32_t Dictionary::Encode(const char *data, uint32_t len) {
+  std::string value(data, len);
+  {
+    std::shared_lock<std::shared_mutex> guard(latch_);
+    auto iter = codes_.find(value);
+    if (iter != codes_.end()) {
+      return iter->second;
+    }
+  }
+  std::unique_lock<std::shared_mutex> guard(latch_);
+  auto iter = codes_.find(value);
+  if (iter != codes_.end()) {
+    return iter->second;
+  }
+  int32_t code = values_.size();
+  Append(value);
+  codes_.emplace(value, code);
+  values_.push_back(std::move(value));
+  return code;
+}
+
+int32_t Dictionary::Lookup(const char *data, uint32_t len) const {
+  std::shared_lock<std::shared_mutex> guard(latch_);
+  auto iter = codes_.find(std::string(data, len));
+  return iter == codes_.end() ? NO_CODE : iter->second;
+}
+
+const std::string &Dictionary::Decode(int32_t code) const {
+  std::shared_lock<std::shared_mutex> guard(latch_);
+  ASSERT(code >= 0 && static_cast<uint32_t>(code) < values_.size(), "Invalid dictionary code.");
+  return values_[code];
+}
+
+Field Dictionary::DecodeField(const Field &code) const {
+  if (code.IsNull()) {
+    return Field(TypeId::kTypeChar);
+  }
+  char buf[sizeof(int32_t)];
+  code.SerializeTo(buf);
+  const std::string &value = Decode(MACH_READ_INT32(buf));
+  return Field(TypeId::kTypeChar, const_cast<char *>(value.data()), value.length(), false);
+}
+
+Field Dictionary::EncodeField(const Field &value) {
+  if (value.IsNull()) {
+    return Field(TypeId::kTypeInt);
+  }
+  return Field(TypeId::kTypeInt, Encode(value.GetData(), value.GetLength()));
+}
+
+uint32_t Dictionary::GetSize() const {
+  std::shared_lock<std::shared_mutex> guard(latch_);
+  return values_.size();
+}
+
+void Dictionary::Append(const std::string &value) {
+  uint32_t entry_size = sizeof(uint32_t) + value.length();
+  ASSERT(value.length() <= MAX_VALUE_LENGTH, "Dictionary value exceeds a page.");
+  auto page = buffer_pool_manager_->FetchPage(last_page_id_);
+  ASSERT(page != nullptr, "Fetch dictionary page failed!");
+  if (last_page_used_ + entry_size > PAGE_SIZE) {
+    // 最后一页已满，链接新页
+    page_id_t new_page_id;
+    auto new_page = buffer_pool_manager_->NewPage(new_page_id);
+    ASSERT(new_page != nullptr, "New dictionary page failed!");
+    MACH_WRITE_TO(page_id_t, new_page->GetData() + OFFSET_NEXT_PAGE_ID, INVALID_PAGE_ID);
+    MACH_WRITE_UINT32(new_page->GetData() + OFFSET_ENTRY_COUNT, 0);
+    MACH_WRITE_TO(page_id_t, page->GetData() + OFFSET_NEXT_PAGE_ID, new_page_id);
+    buffer_pool_manager_->UnpinPage(last_page_id_, true);
+    page = new_page;
+    last_page_id_ = new_page_id;
+    last_page_used_ = SIZE_HEADER;
+  }
+  char *buf = page->GetData();
+  MACH_WRITE_UINT32(buf + last_page_used_, value.length());
+  memcpy(buf + last_page_used_ + sizeof(uint32_t), value.data(), value.length());
+  MACH_WRITE_UINT32(buf + OFFSET_ENTRY_COUNT, MACH_READ_UINT32(buf + OFFSET_ENTRY_COUNT) + 1);
+  last_page_used_ += entry_size;
+  buffer_pool_manager_->UnpinPage(last_page_id_, true);
+}
+
+void Dictionary::Destroy() {
+  std::unique_lock<std::shared_mutex> guard(latch_);
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      break;
+    }
+    page_id_t next_page_id = MACH_READ_FROM(page_id_t, page->GetData() + OFFSET_NEXT_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+  first_page_id_ = last_page_id_ = INVALID_PAGE_ID;
+  values_.clear();
+  codes_.clear();
+}
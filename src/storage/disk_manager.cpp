@@ -68,20 +68,17 @@ page_id_t DiskManager::AllocatePage() {
     uint32_t ofs = 0;
     bitmap->AllocatePage(ofs);
     WritePhysicalPage(1 + i * (DiskManager::BITMAP_SIZE + 1), buf);
-    return meta_page->num_allocated_pages_ - 1;
+    return i * DiskManager::BITMAP_SIZE + ofs;
   }
   // 找到了没有非陪满的位图页，直接分配一页，更新元信息，写回磁盘并且返回分配的页号
   ReadPhysicalPage(1 + i * (DiskManager::BITMAP_SIZE + 1), buf);
   BitmapPage<PAGE_SIZE> *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(buf);
-  for (j = 0; j < bitmap->GetMaxSupportedSize(); j++) {  //搜索方式为线性搜索，复杂度为0(N)
-    if (bitmap->IsPageFree(j))
-      break;
-  }
   meta_page->num_allocated_pages_++;
   meta_page->extent_used_page_[i]++;
+  // 位图自己维护下一个空闲页，回收过的页号会被重新分配，所以页号不能由已分配页数推出
   bitmap->AllocatePage(j);
   WritePhysicalPage(1 + i * (DiskManager::BITMAP_SIZE + 1), buf);
-  return meta_page->num_allocated_pages_ - 1;
+  return i * DiskManager::BITMAP_SIZE + j;
 }
 
 /*回收磁盘中逻辑页号对应的物理页*/
@@ -1,87 +1,528 @@
 #include "storage/table_heap.h"
 
+#include <algorithm>
+#include <type_traits>
+
+namespace {
+// 两种页格式的初始化参数不同
+inline void InitTablePage(TablePage *page, page_id_t page_id, page_id_t prev_id, [[maybe_unused]] Schema *schema,
+                          LogManager *log_mgr, Transaction *txn) {
+  page->Init(page_id, prev_id, log_mgr, txn);
+}
+
+inline void InitTablePage(PaxTablePage *page, page_id_t page_id, page_id_t prev_id, Schema *schema,
+                          LogManager *log_mgr, Transaction *txn) {
+  page->Init(page_id, prev_id, schema, log_mgr, txn);
+}
+
+inline bool InsertIntoPage(TablePage *page, Row &row, bool moved, Schema *schema, Transaction *txn,
+                           LockManager *lock_manager, LogManager *log_manager) {
+  return moved ? page->InsertMovedTuple(row, schema, txn, lock_manager, log_manager)
+               : page->InsertTuple(row, schema, txn, lock_manager, log_manager);
+}
+
+inline bool InsertIntoPage(PaxTablePage *page, Row &row, [[maybe_unused]] bool moved, Schema *schema,
+                           Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
+  return page->InsertTuple(row, schema, txn, lock_manager, log_manager);
+}
+}  // namespace
+
+void TableHeap::InitFirstPage(Transaction *txn) {
+  auto page = buffer_pool_manager_->NewPage(first_page_id_);
+  if (layout_ == TableLayout::kPax) {
+    InitTablePage(reinterpret_cast<PaxTablePage *>(page), first_page_id_, INVALID_PAGE_ID, storage_schema_,
+                  log_manager_, txn);
+  } else {
+    InitTablePage(reinterpret_cast<TablePage *>(page), first_page_id_, INVALID_PAGE_ID, storage_schema_,
+                  log_manager_, txn);
+  }
+  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  // 新表从空页开始维护zone map
+  zone_map_.SetBuilt();
+  zone_map_.AppendPage(first_page_id_);
+}
+
+void TableHeap::InitDictionaries(const std::vector<Dictionary *> &dictionaries) {
+  dictionaries_ = dictionaries;
+  dictionaries_.resize(schema_->GetColumnCount(), nullptr);
+  storage_schema_ = MakeStorageSchema(schema_, dictionaries_);
+}
+
+Schema *TableHeap::MakeStorageSchema(Schema *schema, const std::vector<Dictionary *> &dictionaries) {
+  if (std::all_of(dictionaries.begin(), dictionaries.end(), [](Dictionary *d) { return d == nullptr; }))
+    return schema;
+  std::vector<Column *> columns;
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Column *column = schema->GetColumn(i);
+    if (i < dictionaries.size() && dictionaries[i] != nullptr)
+      columns.push_back(new Column(column->GetName(), TypeId::kTypeInt, i, column->IsNullable(), column->IsUnique()));
+    else
+      columns.push_back(new Column(column));
+  }
+  return new Schema(columns, true);
+}
+
+bool TableHeap::EncodeRow(const Row &row, Row *encoded, std::vector<page_id_t> *overflow_pages) {
+  // 列存页按列宽定长存放，长值不溢出
+  auto spills = [this](uint32_t i, const Field *field) {
+    return layout_ == TableLayout::kRow && GetDictionary(i) == nullptr && field->GetTypeId() == TypeId::kTypeChar &&
+           !field->IsNull() && field->GetLength() > TUPLE_INLINE_VALUE_MAX;
+  };
+  bool convert = HasDictionary();
+  for (uint32_t i = 0; !convert && i < row.GetFieldCount(); i++) {
+    convert = spills(i, row.GetField(i));
+  }
+  if (!convert)
+    return false;
+  std::vector<Field> fields;
+  fields.reserve(row.GetFieldCount());
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    Field *field = row.GetField(i);
+    Dictionary *dictionary = GetDictionary(i);
+    page_id_t first_page_id;
+    if (dictionary != nullptr) {
+      fields.emplace_back(dictionary->EncodeField(*field));
+    } else if (spills(i, field) &&
+               (first_page_id = WriteOverflow(field->GetData(), field->GetLength())) != INVALID_PAGE_ID) {
+      overflow_pages->push_back(first_page_id);
+      char reference[2 * sizeof(uint32_t)];
+      MACH_WRITE_UINT32(reference, field->GetLength());
+      MACH_WRITE_TO(page_id_t, reference + sizeof(uint32_t), first_page_id);
+      fields.emplace_back(TypeId::kTypeChar, reference, sizeof(reference), true);
+      fields.back().SetOverflow(true);
+    } else {
+      // 分配溢出页失败时值留在元组中，放不下则插入失败
+      fields.emplace_back(*field);
+    }
+  }
+  *encoded = Row(fields);
+  encoded->SetRowId(row.GetRowId());
+  return true;
+}
+
+page_id_t TableHeap::WriteOverflow(const char *data, uint32_t len) {
+  // 从后往前写，每页只需链接到已写好的下一页
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  uint32_t page_count = (len + OverflowPage::CAPACITY - 1) / OverflowPage::CAPACITY;
+  for (uint32_t i = page_count; i > 0; i--) {
+    page_id_t page_id;
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->NewPage(page_id));
+    if (page == nullptr) {
+      FreeOverflow(next_page_id);
+      return INVALID_PAGE_ID;
+    }
+    uint32_t offset = (i - 1) * OverflowPage::CAPACITY;
+    uint32_t size = std::min(len - offset, OverflowPage::CAPACITY);
+    page->Init();
+    page->SetNextPageId(next_page_id);
+    page->SetDataSize(size);
+    memcpy(page->GetPayload(), data + offset, size);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    next_page_id = page_id;
+  }
+  return next_page_id;
+}
+
+std::string TableHeap::ReadOverflow(const Field &reference) const {
+  const char *data = reference.GetData();
+  std::string value;
+  value.reserve(MACH_READ_UINT32(data));
+  page_id_t page_id = MACH_READ_FROM(page_id_t, data + sizeof(uint32_t));
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    ASSERT(page != nullptr, "Fetch overflow page failed!");
+    value.append(page->GetPayload(), page->GetDataSize());
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return value;
+}
+
+void TableHeap::FreeOverflow(page_id_t first_page_id) {
+  page_id_t page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr)
+      break;
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+void TableHeap::FreeOverflow(const Row &stored) {
+  for (uint32_t i = 0; i < stored.GetFieldCount(); i++) {
+    Field *field = stored.GetField(i);
+    if (field != nullptr && field->IsOverflow())
+      FreeOverflow(MACH_READ_FROM(page_id_t, field->GetData() + sizeof(uint32_t)));
+  }
+}
+
+void TableHeap::ResolveOverflow(Row *row) const {
+  if (layout_ != TableLayout::kRow)
+    return;
+  auto &fields = row->GetFields();
+  for (auto &field : fields) {
+    if (field == nullptr || !field->IsOverflow())
+      continue;
+    std::string value = ReadOverflow(*field);
+    Arena *arena = row->GetArena();
+    if (arena == nullptr) {
+      delete field;
+      field = new Field(TypeId::kTypeChar, value.data(), value.length(), true);
+    } else {
+      field = arena->New<Field>(TypeId::kTypeChar, arena, value.data(), value.length());
+    }
+  }
+}
+
+void TableHeap::DecodeRow(Row *row) const {
+  if (!HasDictionary())
+    return;
+  auto &fields = row->GetFields();
+  for (uint32_t i = 0; i < fields.size(); i++) {
+    Dictionary *dictionary = GetDictionary(i);
+    // 投影扫描时未解码的列是nullptr
+    if (dictionary == nullptr || fields[i] == nullptr)
+      continue;
+    Field *decoded = row->NewField(dictionary->DecodeField(*fields[i]));
+    if (row->GetArena() == nullptr)
+      delete fields[i];
+    fields[i] = decoded;
+  }
+}
+
+bool TableHeap::EnableDictionary(uint32_t column_id, Dictionary *dictionary) {
+  if (layout_ != TableLayout::kRow || column_id >= schema_->GetColumnCount() ||
+      schema_->GetColumn(column_id)->GetType() != TypeId::kTypeChar || dictionaries_[column_id] != nullptr)
+    return false;
+  auto dictionaries = dictionaries_;
+  dictionaries[column_id] = dictionary;
+  Schema *storage_schema = MakeStorageSchema(schema_, dictionaries);
+  // 逐页把该列改写成编码，编码不会比字符串长，记录都能原地缩短
+  auto convert = [this, column_id, dictionary](Row *row) {
+    Field *&field = row->GetFields()[column_id];
+    Field *encoded;
+    if (field->IsOverflow()) {
+      // 溢出的长值按原值编码，溢出页随之回收
+      std::string value = ReadOverflow(*field);
+      encoded = new Field(dictionary->EncodeField(Field(TypeId::kTypeChar, value.data(), value.length(), false)));
+      FreeOverflow(MACH_READ_FROM(page_id_t, field->GetData() + sizeof(uint32_t)));
+    } else {
+      encoded = new Field(dictionary->EncodeField(*field));
+    }
+    delete field;
+    field = encoded;
+  };
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr)
+      break;
+    page->WLatch();
+    page->ReencodeTuples(storage_schema_, storage_schema, convert);
+    page_id = page->GetNextPageId();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  }
+  if (storage_schema_ != schema_)
+    delete storage_schema_;
+  storage_schema_ = storage_schema;
+  dictionaries_.swap(dictionaries);
+  return true;
+}
+
+void TableHeap::BuildZoneMap() {
+  zone_map_.SetBuilt();
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    zone_map_.AppendPage(page_id);
+    // 两种页格式的页链字段位置相同
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr)
+      break;
+    page->RLatch();
+    page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+  }
+  // 被转发的记录按原rid计入原页
+  for (auto iter = Begin(nullptr); iter != End(); ++iter) {
+    zone_map_.Insert(iter->GetRowId().GetPageId(), *iter);
+  }
+}
+
+ZoneMap *TableHeap::GetZoneMap() {
+  std::lock_guard<std::mutex> guard(zone_map_latch_);
+  if (!zone_map_.IsBuilt()) {
+    BuildZoneMap();
+  }
+  return &zone_map_;
+}
+
+bool TableHeap::ValuesFit(const Row &row) const {
+  // 索引键只保存列宽以内的字节，更长的值会和它的前缀编码成相同的键
+  for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+    const Column *column = schema_->GetColumn(i);
+    const Field *field = row.GetField(i);
+    if (column->GetType() == TypeId::kTypeChar && !field->IsNull() && field->GetLength() > column->GetLength())
+      return false;
+  }
+  return true;
+}
+
 /*向堆表中插入一条记录，插入记录后生成的RowId需要通过row对象返回（即row.rid_)*/
 bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
-  if (row.GetSerializedSize(schema_) > PAGE_SIZE - 32)
+  if (!ValuesFit(row))
     return false;
+  // 字典编码列在页中存的是编码，长值存的是溢出页的引用
+  Row encoded;
+  std::vector<page_id_t> overflow_pages;
+  Row &stored = EncodeRow(row, &encoded, &overflow_pages) ? encoded : row;
+  bool res;
+  if (layout_ == TableLayout::kPax) {
+    res = PaxTablePage::RowFits(stored, storage_schema_) && InsertTupleImpl<PaxTablePage>(stored, txn);
+  } else {
+    res = stored.GetSerializedSize(storage_schema_) <= PAGE_SIZE - 32 && InsertTupleImpl<TablePage>(stored, txn);
+  }
+  if (res) {
+    row.SetRowId(stored.GetRowId());
+    zone_map_.Insert(row.GetRowId().GetPageId(), row);
+  } else {
+    for (auto page_id : overflow_pages)
+      FreeOverflow(page_id);
+  }
+  return res;
+}
+
+template <typename PageType>
+bool TableHeap::InsertTupleImpl(Row &row, Transaction *txn, page_id_t home_page_id) {
+  bool moved = home_page_id != INVALID_PAGE_ID;
   // 查找可以包含此元组的页面
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(GetFirstPageId()));
+  auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(GetFirstPageId()));
   while (true) {
     if (page == nullptr)
       return false;
     // 若insert完成,则返回true
-    if (page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
+    if (page->GetTablePageId() != home_page_id &&
+        InsertIntoPage(page, row, moved, storage_schema_, txn, lock_manager_, log_manager_)) {
       buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
       return true;
     }
     // 否则继续找下一个page是否可以insert
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
     page_id_t next = page->GetNextPageId();
     // 若当前page不是最后一个page则继续循环,是最后一个就new一个page
     if (next != INVALID_PAGE_ID) {
-      page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(next));
+      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+      page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(next));
     } else {
-      auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(next));
+      auto new_page = reinterpret_cast<PageType *>(buffer_pool_manager_->NewPage(next));
+      if (new_page == nullptr) {
+        buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+        return false;
+      }
+      // 链接到新页后上一页是脏页
       page->SetNextPageId(next);
-      new_page->Init(next, page->GetPageId(), log_manager_, txn);
-      new_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+      InitTablePage(new_page, next, page->GetTablePageId(), storage_schema_, log_manager_, txn);
+      zone_map_.AppendPage(next);
+      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+      bool res = InsertIntoPage(new_page, row, moved, storage_schema_, txn, lock_manager_, log_manager_);
       buffer_pool_manager_->UnpinPage(next, true);
-      return true;
+      return res;
     }
   }
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  bool res = layout_ == TableLayout::kPax ? MarkDeleteImpl<PaxTablePage>(rid, txn) : MarkDeleteImpl<TablePage>(rid, txn);
+  if (res)
+    zone_map_.Delete(rid.GetPageId());
+  return res;
+}
+
+template <typename PageType>
+PageType *TableHeap::LatchForward(PageType *page, const RowId &rid, RowId *target, bool exclusive) {
+  auto latch = [exclusive](PageType *p) { exclusive ? p->WLatch() : p->RLatch(); };
+  auto unlatch = [exclusive](PageType *p) { exclusive ? p->WUnlatch() : p->RUnlatch(); };
+  // 转发只有一跳，迁移出去的记录不会再被转发
+  while (page->GetForward(rid, target)) {
+    ASSERT(target->GetPageId() != rid.GetPageId(), "A row is never forwarded to its home page.");
+    auto target_page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(target->GetPageId()));
+    ASSERT(target_page != nullptr, "Forward target page should not be null!");
+    if (target->GetPageId() > rid.GetPageId()) {
+      latch(target_page);
+      return target_page;
+    }
+    // 目标页号更小，按页号顺序重新加latch，期间转发可能已经改变
+    unlatch(page);
+    latch(target_page);
+    latch(page);
+    RowId current;
+    if (page->GetForward(rid, &current) && current == *target)
+      return target_page;
+    unlatch(target_page);
+    buffer_pool_manager_->UnpinPage(target->GetPageId(), false);
+  }
+  return nullptr;
+}
+
+template <typename PageType>
+bool TableHeap::MarkDeleteImpl(const RowId &rid, Transaction *txn) {
+  auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   if (page == nullptr)
     return false;
-  // 标记需要删除的页
+  // 标记需要删除的页，转发slot和迁移出去的记录一起标记
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  RowId target;
+  auto target_page = LatchForward(page, rid, &target, true);
+  bool res = page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  if (target_page != nullptr) {
+    if (res)
+      target_page->MarkDelete(target, txn, lock_manager_, log_manager_);
+    target_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(target.GetPageId(), res);
+  }
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-  return true;
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), res);
+  return res;
 }
 
 /*将RowId为rid的记录old_row替换成新的记录new_row，并将new_row的RowId通过new_row.rid_返回*/
 bool TableHeap::UpdateTuple(const Row &row, const RowId &rid, Transaction *txn) {
-  // 得到old_row
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  if (page == nullptr)
-      return false;
-  Row old_row(rid);
-  if (!GetTuple(&old_row, txn))
+  if (!ValuesFit(row))
     return false;
-  // 更新old_row
-  page->WLatch();
-  int type = page->UpdateTuple(row, &old_row, schema_, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  if (type == 0) {
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-    return true;
+  Row encoded;
+  std::vector<page_id_t> overflow_pages;
+  const Row &stored = EncodeRow(row, &encoded, &overflow_pages) ? encoded : row;
+  bool res = layout_ == TableLayout::kPax ? UpdateTupleImpl<PaxTablePage>(stored, rid, txn)
+                                          : UpdateTupleImpl<TablePage>(stored, rid, txn);
+  if (res) {
+    zone_map_.Update(rid.GetPageId(), row);
   } else {
-      // 空间不够，先删除再插入
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    for (auto page_id : overflow_pages)
+      FreeOverflow(page_id);
+  }
+  return res;
+}
+
+template <typename PageType>
+bool TableHeap::UpdateTupleImpl(const Row &row, const RowId &rid, Transaction *txn) {
+  if (row.GetSerializedSize(storage_schema_) > PAGE_SIZE - 32)
+    return false;
+  auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if (page == nullptr)
     return false;
+  page->WLatch();
+  // 已经被转发过的记录，在它当前所在的页上更新
+  RowId body_rid = rid;
+  auto body_page = LatchForward(page, rid, &body_rid, true);
+  if (body_page == nullptr)
+    body_page = page;
+  Row old_row(body_rid);
+  bool res = body_page->UpdateTuple(row, &old_row, storage_schema_, txn, lock_manager_, log_manager_);
+  // 被替换的旧记录，它引用的溢出页在更新成功后回收
+  Row *replaced = res ? &old_row : nullptr;
+  Row probe(body_rid);
+  if constexpr (std::is_same_v<PageType, TablePage>) {
+    // 本页放不下：迁移到别的页，原slot只留转发，rid不变
+    if (!res && body_page->GetTuple(&probe, storage_schema_, txn, lock_manager_)) {
+      Row moved(row);
+      if (InsertTupleImpl<PageType>(moved, txn, rid.GetPageId())) {
+        if (body_page != page) {
+          body_page->ApplyDelete(body_rid, txn, log_manager_);
+        }
+        page->SetForward(rid, moved.GetRowId());
+        res = true;
+        replaced = &probe;
+      }
+    }
+  }
+  if (body_page != page) {
+    body_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(body_page->GetTablePageId(), res);
   }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), res);
+  if (replaced != nullptr)
+    FreeOverflow(*replaced);
+  return res;
 }
 
 /*从物理意义上删除这条记录*/
 void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  bool was_live = layout_ == TableLayout::kPax ? ApplyDeleteImpl<PaxTablePage>(rid, txn)
+                                               : ApplyDeleteImpl<TablePage>(rid, txn);
+  // 标记删除时已经从zone map中减去
+  if (was_live)
+    zone_map_.Delete(rid.GetPageId());
+}
+
+template <typename PageType>
+bool TableHeap::ApplyDeleteImpl(const RowId &rid, Transaction *txn) {
+  auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   assert(page != nullptr);
     //ASSERT(page != nullptr, "Page should not be null!");
   page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  RowId target;
+  auto target_page = LatchForward(page, rid, &target, true);
+  // 记录本身被回收前先取出它引用的溢出页，@return 该slot此前是否未被标记删除
+  auto apply = [&](PageType *slot_page, const RowId &slot, Row *body, bool *has_body) {
+    bool live = slot_page->MarkDelete(slot, txn, lock_manager_, log_manager_);
+    if constexpr (std::is_same_v<PageType, TablePage>) {
+      *has_body = slot_page->GetTupleBody(body, storage_schema_);
+    }
+    slot_page->ApplyDelete(slot, txn, log_manager_);
+    return live;
+  };
+  // 迁移出去的记录和转发slot一起回收
+  Row target_body(target);
+  bool target_has_body = false;
+  if (target_page != nullptr) {
+    apply(target_page, target, &target_body, &target_has_body);
+    target_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(target.GetPageId(), true);
+  }
+  Row body(rid);
+  bool has_body = false;
+  bool was_live = apply(page, rid, &body, &has_body);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  if (target_has_body)
+    FreeOverflow(target_body);
+  if (has_body)
+    FreeOverflow(body);
+  return was_live;
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  Row row(rid);
+  bool was_live = GetTuple(&row, txn);
+  if (layout_ == TableLayout::kPax) {
+    RollbackDeleteImpl<PaxTablePage>(rid, txn);
+  } else {
+    RollbackDeleteImpl<TablePage>(rid, txn);
+  }
+  // 恢复的记录重新计入zone map
+  row.destroy();
+  if (!was_live && GetTuple(&row, txn))
+    zone_map_.Insert(rid.GetPageId(), row);
+}
+
+template <typename PageType>
+void TableHeap::RollbackDeleteImpl(const RowId &rid, Transaction *txn) {
+  auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   assert(page != nullptr);
     //ASSERT(page != nullptr, "Page should not be null!");
   page->WLatch();
+  RowId target;
+  auto target_page = LatchForward(page, rid, &target, true);
+  if (target_page != nullptr) {
+    target_page->RollbackDelete(target, txn, log_manager_);
+    target_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(target.GetPageId(), true);
+  }
   page->RollbackDelete(rid, txn, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
@@ -89,25 +530,66 @@ void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
 
 /* 获取RowId为row->rid_的记录 */
 bool TableHeap::GetTuple(Row *row, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId()));
+  bool res = GetStoredTuple(row, nullptr, txn);
+  if (res)
+    DecodeRow(row);
+  return res;
+}
+
+bool TableHeap::GetTuple(Row *row, const std::vector<uint32_t> &column_ids, Transaction *txn) {
+  bool res = GetStoredTuple(row, &column_ids, txn);
+  if (res)
+    DecodeRow(row);
+  return res;
+}
+
+bool TableHeap::GetStoredTuple(Row *row, const std::vector<uint32_t> *column_ids, Transaction *txn) {
+  return layout_ == TableLayout::kPax ? GetTupleImpl<PaxTablePage>(row, column_ids, txn)
+                                      : GetTupleImpl<TablePage>(row, column_ids, txn);
+}
+
+template <typename PageType>
+bool TableHeap::GetTupleImpl(Row *row, const std::vector<uint32_t> *column_ids, Transaction *txn) {
+  auto page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId()));
   if (page == nullptr)
       return false;
   page->RLatch();
-  if (!page->GetTuple(row, schema_, txn, lock_manager_)) {
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-    return false;
+  RowId rid = row->GetRowId();
+  RowId target;
+  auto target_page = LatchForward(page, rid, &target, false);
+  // 跟随转发读取，返回的仍是原rid
+  auto body_page = page;
+  if (target_page != nullptr) {
+    body_page = target_page;
+    row->SetRowId(target);
+  }
+  bool res = column_ids == nullptr ? body_page->GetTuple(row, storage_schema_, txn, lock_manager_)
+                                   : body_page->GetTuple(row, storage_schema_, *column_ids, txn, lock_manager_);
+  if (res)
+    ResolveOverflow(row);
+  row->SetRowId(rid);
+  if (target_page != nullptr) {
+    target_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(target.GetPageId(), false);
   }
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-  return true;
+  return res;
 }
 
 void TableHeap::DeleteTable(page_id_t page_id) {
   if (page_id != INVALID_PAGE_ID) {
+    // 两种页格式的页链字段位置相同
     auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  // 删除table_heap
     if (temp_table_page->GetNextPageId() != INVALID_PAGE_ID)
       DeleteTable(temp_table_page->GetNextPageId());
+    // 回收本页记录引用的溢出页
+    for (uint32_t slot_num = 0; layout_ == TableLayout::kRow && slot_num < temp_table_page->GetTupleCount();
+         slot_num++) {
+      Row body(RowId(page_id, slot_num));
+      if (temp_table_page->GetTupleBody(&body, storage_schema_))
+        FreeOverflow(body);
+    }
     buffer_pool_manager_->UnpinPage(page_id, false);
     buffer_pool_manager_->DeletePage(page_id);
   } else {
@@ -117,15 +599,24 @@ void TableHeap::DeleteTable(page_id_t page_id) {
 
 /*获取堆表的首迭代器；*/
 TableIterator TableHeap::Begin(Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  RowId rid;
-  page->RLatch();
-  page->GetFirstTupleRid(&rid);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, false);
-  return TableIterator(this, rid);
+  return Begin(txn, nullptr);
+}
+
+TableIterator TableHeap::Begin(Transaction *txn, const std::vector<uint32_t> *column_ids) {
+  // 迭代器自己从首页开始找第一条有效记录，首页为空时会继续向后找
+  return TableIterator(this, RowId(first_page_id_, 0), column_ids);
+}
+TableIterator TableHeap::Begin([[maybe_unused]] Transaction *txn, const std::vector<uint32_t> *column_ids,
+                               page_id_t first_page_id, page_id_t stop_page_id, bool decode) {
+  return TableIterator(this, RowId(first_page_id, 0), column_ids, stop_page_id, decode);
 }
+
+/*按页链顺序得到所有页号，作为并行扫描划分页范围的目录*/
+void TableHeap::GetPageIds(std::vector<page_id_t> &page_ids) {
+  GetZoneMap()->GetPageIds(page_ids);
+}
+
 /*获取堆表的尾迭代器*/
 TableIterator TableHeap::End() {
   return TableIterator(this,INVALID_ROWID);//rowid=(page_id,slot_id)=(-1,0)
-}
\ No newline at end of file
+}
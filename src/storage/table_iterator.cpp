@@ -2,119 +2,170 @@
 #include "common/macros.h"
 #include "storage/table_heap.h"
 
-// 注意，我修改了构造函数的参数
-TableIterator::TableIterator(TableHeap *t, RowId rid) : table_heap_(t) {
+TableIterator::TableIterator(TableHeap *table_heap, RowId rid, const std::vector<uint32_t> *column_ids,
+                             page_id_t stop_page_id, bool decode)
+    : table_heap_(table_heap), column_ids_(column_ids), stop_page_id_(stop_page_id), decode_(decode) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    row_ = new Row(rid);
-    table_heap_->GetTuple(row_, nullptr);
-  } else {
-    row_ = new Row(INVALID_ROWID);
+    // 一页最多放下一条记录，两页大小的块足够容纳它的全部字段
+    arena_ = std::make_unique<Arena>(2 * PAGE_SIZE);
+    row_ = Row(arena_.get());
+    row_.SetRowId(INVALID_ROWID);
+    page_ = table_heap_->buffer_pool_manager_->FetchPage(rid.GetPageId());
+    Seek(rid.GetSlotNum());
+  }
+}
+
+TableIterator::TableIterator(const TableIterator &other)
+    : table_heap_(other.table_heap_),
+      row_(other.row_),
+      column_ids_(other.column_ids_),
+      stop_page_id_(other.stop_page_id_),
+      decode_(other.decode_) {
+  if (other.page_ != nullptr) {
+    // 同一页再pin一次，缓冲池命中
+    page_ = table_heap_->buffer_pool_manager_->FetchPage(other.page_->GetPageId());
   }
 }
 
-TableIterator::TableIterator(const TableIterator &other) {
-  table_heap_ = other.table_heap_;
-  row_ = other.row_;
+TableIterator::TableIterator(TableIterator &&other) noexcept
+    : table_heap_(other.table_heap_),
+      page_(other.page_),
+      arena_(std::move(other.arena_)),
+      row_(std::move(other.row_)),
+      column_ids_(other.column_ids_),
+      stop_page_id_(other.stop_page_id_),
+      decode_(other.decode_) {
+  other.page_ = nullptr;
+  other.row_.SetRowId(INVALID_ROWID);
 }
 
-TableIterator::~TableIterator() {}
+TableIterator::~TableIterator() { Release(); }
 
-bool TableIterator::operator==(const TableIterator &itr) const {
-  if(itr.row_->GetRowId()==INVALID_ROWID&&row_->GetRowId()==INVALID_ROWID){
-    return true;
-  }
-  else if(itr.row_->GetRowId()==INVALID_ROWID||row_->GetRowId()==INVALID_ROWID){
+bool TableIterator::operator==(const TableIterator &itr) const { return row_.GetRowId() == itr.row_.GetRowId(); }
 
-    return false;
-  }
-  else if(itr.row_->GetRowId().GetPageId()==row_->GetRowId().GetPageId()&&row_->GetRowId().GetSlotNum()==itr.row_->GetRowId().GetSlotNum()){
-    return true;
+bool TableIterator::operator!=(const TableIterator &itr) const { return !(*this == itr); }
+
+const Row &TableIterator::operator*() { return row_; }
+
+Row *TableIterator::operator->() { return &row_; }
+
+TableIterator &TableIterator::operator=(const TableIterator &itr) {
+  if (this == &itr) {
+    return *this;
   }
-  else{
-    return false;
+  Release();
+  table_heap_ = itr.table_heap_;
+  column_ids_ = itr.column_ids_;
+  stop_page_id_ = itr.stop_page_id_;
+  decode_ = itr.decode_;
+  row_ = itr.row_;
+  if (itr.page_ != nullptr) {
+    page_ = table_heap_->buffer_pool_manager_->FetchPage(itr.page_->GetPageId());
   }
+  return *this;
 }
 
-bool TableIterator::operator!=(const TableIterator &itr) const {
-  if(itr.row_->GetRowId()==INVALID_ROWID&&row_->GetRowId()==INVALID_ROWID){
-    return false;
-  }
-  else if(itr.row_->GetRowId()==INVALID_ROWID||row_->GetRowId()==INVALID_ROWID){
-    return true;
-  }
-  else if(itr.row_->GetRowId().GetPageId()==row_->GetRowId().GetPageId()&&row_->GetRowId().GetSlotNum()==itr.row_->GetRowId().GetSlotNum()){
-    return false;
-  }
-  else {
-    return true;
+TableIterator &TableIterator::operator=(TableIterator &&itr) noexcept {
+  if (this == &itr) {
+    return *this;
   }
+  Release();
+  table_heap_ = itr.table_heap_;
+  column_ids_ = itr.column_ids_;
+  stop_page_id_ = itr.stop_page_id_;
+  decode_ = itr.decode_;
+  page_ = itr.page_;
+  arena_ = std::move(itr.arena_);
+  row_ = std::move(itr.row_);
+  itr.page_ = nullptr;
+  itr.row_.SetRowId(INVALID_ROWID);
+  return *this;
 }
 
-const Row &TableIterator::operator*(){
-    return *(row_);
+TableIterator &TableIterator::operator++() {
+  if (page_ != nullptr) {
+    Seek(row_.GetRowId().GetSlotNum() + 1);
+  }
+  return *this;
 }
 
-Row *TableIterator::operator->(){
-    return row_;
+TableIterator TableIterator::operator++(int) {
+  TableIterator old(*this);
+  ++(*this);
+  return old;
 }
 
-TableIterator &TableIterator::operator++() {
-  if (row_ == nullptr||row_->GetRowId() == INVALID_ROWID) {
-    delete row_;
-    row_ = new Row(INVALID_ROWID);
-    return *this;
-  }
-  auto page = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(row_->GetRowId().GetPageId()));
-  RowId id_new;
-  page->RLatch();
-  if (page->GetNextTupleRid(row_->GetRowId(), &id_new)) { // 直接找到了那么就直接读取
-    delete row_;
-    row_ = new Row(id_new);
-    if (*this != table_heap_->End()) {
-      table_heap_->GetTuple(row_, nullptr);
-    }
-    page->RUnlatch();
-    table_heap_->buffer_pool_manager_->UnpinPage(row_->GetRowId().GetPageId(), false);
+void TableIterator::Seek(uint32_t slot_num) {
+  if (table_heap_->layout_ == TableLayout::kPax) {
+    SeekImpl<PaxTablePage>(slot_num);
+  } else {
+    SeekImpl<TablePage>(slot_num);
   }
-  else { // 本页没有合适的，去找下一页
-    page_id_t next_page_id = page->GetNextPageId();
-    // 搜索，直到最后一页
-    while (next_page_id != INVALID_PAGE_ID) {
-      auto new_page = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(next_page_id));
+}
+
+template <typename PageType>
+void TableIterator::SeekImpl(uint32_t slot_num) {
+  auto bpm = table_heap_->buffer_pool_manager_;
+  while (page_ != nullptr) {
+    auto page = reinterpret_cast<PageType *>(page_);
+    RowId rid;
+    page->RLatch();
+    bool found = slot_num == 0 ? page->GetFirstTupleRid(&rid)
+                               : page->GetNextTupleRid(RowId(page->GetTablePageId(), slot_num - 1), &rid);
+    RowId target;
+    if (found && page->GetForward(rid, &target)) {
+      // 转发slot：记录在别的页上，放开本页latch再读取，失败说明已被删除，继续向后找
       page->RUnlatch();
-      table_heap_->buffer_pool_manager_->UnpinPage(row_->GetRowId().GetPageId(), false);
-      page = new_page;
-      page->RLatch();
-      if (page->GetFirstTupleRid(&id_new)) {
-        delete row_;
-        row_ = new Row(id_new);
-        break; // 找到了就退出
+      ClearRow();
+      row_.SetRowId(rid);
+      if (table_heap_->GetStoredTuple(&row_, column_ids_, nullptr)) {
+        if (decode_) {
+          table_heap_->DecodeRow(&row_);
+        }
+        return;
       }
-      next_page_id = page->GetNextPageId();
+      slot_num = rid.GetSlotNum() + 1;
+      continue;
     }
-    // 如果next_page_id不是非法的则可以读取tuple,否则需要返回nullptr构成的iter
-    if (next_page_id != INVALID_PAGE_ID) {
-      table_heap_->GetTuple(row_, nullptr);
-    } else {
-      delete row_;
-      row_ = new Row(INVALID_ROWID);
+    if (found) {
+      ClearRow();
+      row_.SetRowId(rid);
+      if (column_ids_ != nullptr) {
+        page->GetTuple(&row_, table_heap_->storage_schema_, *column_ids_, nullptr, table_heap_->lock_manager_);
+      } else {
+        page->GetTuple(&row_, table_heap_->storage_schema_, nullptr, table_heap_->lock_manager_);
+      }
+      // 只有读到的列才去取溢出页
+      table_heap_->ResolveOverflow(&row_);
+      page->RUnlatch();
+      if (decode_) {
+        table_heap_->DecodeRow(&row_);
+      }
+      return;
     }
+    // 本页没有了，换到下一页
+    page_id_t next_page_id = page->GetNextPageId();
     page->RUnlatch();
-    table_heap_->buffer_pool_manager_->UnpinPage(row_->GetRowId().GetPageId(), false);
+    bpm->UnpinPage(page->GetTablePageId(), false);
+    page_ = next_page_id == INVALID_PAGE_ID || next_page_id == stop_page_id_ ? nullptr : bpm->FetchPage(next_page_id);
+    slot_num = 0;
   }
-  return *this;
+  ClearRow();
+  row_.SetRowId(INVALID_ROWID);
 }
 
-TableIterator TableIterator::operator++(int) {
-  TableIterator p(table_heap_, row_->GetRowId());
-  ++(*this);
-  return TableIterator{p};
+void TableIterator::Release() {
+  if (page_ != nullptr) {
+    table_heap_->buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
+  ClearRow();
+  row_.SetRowId(INVALID_ROWID);
 }
 
-// TODO:
-TableIterator &TableIterator::operator=(const TableIterator &itr) noexcept {
-  table_heap_ = itr.table_heap_;
-  row_ = itr.row_;
-  //    txn_ = itr.txn_;
-  return *this;
-};
\ No newline at end of file
+void TableIterator::ClearRow() {
+  row_.destroy();
+  if (arena_ != nullptr) {
+    arena_->Reset();
+  }
+}
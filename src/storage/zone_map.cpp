@@ -0,0 +1,129 @@
+#include "storage/zone_map.h"
+
+void ZoneMap::AppendPage(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  // 还没构建时由构建过程按页链顺序登记
+  if (!built_ || zones_.count(page_id) > 0) {
+    return;
+  }
+  page_ids_.push_back(page_id);
+  ResetZone(&zones_[page_id]);
+}
+
+void ZoneMap::Insert(page_id_t page_id, const Row &row) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto zone = FindZone(page_id);
+  if (zone == nullptr) {
+    return;
+  }
+  zone->row_count_++;
+  Widen(zone, row);
+}
+
+void ZoneMap::Update(page_id_t page_id, const Row &row) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto zone = FindZone(page_id);
+  if (zone == nullptr) {
+    return;
+  }
+  Widen(zone, row);
+}
+
+void ZoneMap::Delete(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto zone = FindZone(page_id);
+  if (zone == nullptr || zone->row_count_ == 0) {
+    return;
+  }
+  // 页空了以后重新变成精确的
+  if (--zone->row_count_ == 0) {
+    ResetZone(zone);
+  }
+}
+
+bool ZoneMap::MayMatch(page_id_t page_id, uint32_t column_id, const std::string &op, const Field &value) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto zone = FindZone(page_id);
+  if (zone == nullptr || column_id >= zone->min_.size()) {
+    return true;
+  }
+  if (zone->row_count_ == 0) {
+    return false;
+  }
+  const Field &min = zone->min_[column_id];
+  const Field &max = zone->max_[column_id];
+  if (!IsNumeric(schema_->GetColumn(column_id)->GetType()) || !min.CheckComparable(value) || value.IsNull()) {
+    return true;
+  }
+  // 全是null的列和任何值比较都不为真
+  if (min.IsNull()) {
+    return false;
+  }
+  if (op == "=")
+    return min.CompareLessThanEquals(value) == CmpBool::kTrue && max.CompareGreaterThanEquals(value) == CmpBool::kTrue;
+  if (op == "<>")
+    return min.CompareNotEquals(value) == CmpBool::kTrue || max.CompareNotEquals(value) == CmpBool::kTrue;
+  if (op == "<")
+    return min.CompareLessThan(value) == CmpBool::kTrue;
+  if (op == "<=")
+    return min.CompareLessThanEquals(value) == CmpBool::kTrue;
+  if (op == ">")
+    return max.CompareGreaterThan(value) == CmpBool::kTrue;
+  if (op == ">=")
+    return max.CompareGreaterThanEquals(value) == CmpBool::kTrue;
+  return true;
+}
+
+bool ZoneMap::MayHaveRows(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto zone = FindZone(page_id);
+  return zone == nullptr || zone->row_count_ > 0;
+}
+
+uint32_t ZoneMap::GetNullCount(page_id_t page_id, uint32_t column_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto zone = FindZone(page_id);
+  return zone == nullptr ? 0 : zone->null_count_[column_id];
+}
+
+void ZoneMap::GetPageIds(std::vector<page_id_t> &page_ids) {
+  std::lock_guard<std::mutex> guard(latch_);
+  page_ids = page_ids_;
+}
+
+ZoneMap::PageZone *ZoneMap::FindZone(page_id_t page_id) {
+  auto iter = zones_.find(page_id);
+  return iter == zones_.end() ? nullptr : &iter->second;
+}
+
+void ZoneMap::ResetZone(PageZone *zone) {
+  zone->row_count_ = 0;
+  zone->min_.clear();
+  zone->max_.clear();
+  for (auto column : schema_->GetColumns()) {
+    zone->min_.emplace_back(column->GetType());
+    zone->max_.emplace_back(column->GetType());
+  }
+  zone->null_count_.assign(schema_->GetColumnCount(), 0);
+}
+
+void ZoneMap::Widen(PageZone *zone, const Row &row) {
+  for (uint32_t i = 0; i < schema_->GetColumnCount() && i < row.GetFieldCount(); i++) {
+    Field *field = row.GetField(i);
+    if (field == nullptr || !IsNumeric(schema_->GetColumn(i)->GetType())) {
+      continue;
+    }
+    if (field->IsNull()) {
+      zone->null_count_[i]++;
+      continue;
+    }
+    if (zone->min_[i].IsNull() || field->CompareLessThan(zone->min_[i]) == CmpBool::kTrue) {
+      Field value(*field);
+      Swap(zone->min_[i], value);
+    }
+    if (zone->max_[i].IsNull() || field->CompareGreaterThan(zone->max_[i]) == CmpBool::kTrue) {
+      Field value(*field);
+      Swap(zone->max_[i], value);
+    }
+  }
+}
@@ -90,6 +90,11 @@ TEST(CatalogTest, CatalogIndexTest) {
   ASSERT_EQ(DB_COLUMN_NAME_NOT_EXIST, r2);
   auto r3 = catalog_01->CreateIndex("table-1", "index-1", index_keys, &txn, index_info, "bptree");
   ASSERT_EQ(DB_SUCCESS, r3);
+  // 只有B+树索引能INCLUDE列
+  IndexInfo *hash_index_info = nullptr;
+  ASSERT_EQ(DB_FAILED,
+            catalog_01->CreateIndex("table-1", "index-2", {"id"}, &txn, hash_index_info, "hash", true, {"name"}));
+  ASSERT_EQ(DB_INDEX_NOT_FOUND, catalog_01->GetIndex("table-1", "index-2", hash_index_info));
   for (int i = 0; i < 10; i++) {
     std::vector<Field> fields{Field(TypeId::kTypeInt, i),
                               Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
@@ -125,4 +130,152 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
   delete db_02;
-}
\ No newline at end of file
+}
+TEST(CatalogTest, CatalogStatisticsTest) {
+  /** Stage 1: analyze and keep the counters current */
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = new Schema(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema, &txn, table_info));
+  ASSERT_EQ(DB_TABLE_NOT_EXIST, catalog_01->AnalyzeTable("table-0"));
+  const int row_nums = 2000;
+  for (int i = 0; i < row_nums; i++) {
+    std::string name = "name-" + std::to_string(i % 50);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.length(), true),
+                              i % 4 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, i * 1.5f)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+  }
+  auto stats = table_info->GetStatistics();
+  ASSERT_FALSE(stats->IsAnalyzed());
+  ASSERT_EQ(DB_SUCCESS, catalog_01->AnalyzeTable("table-1"));
+  ASSERT_TRUE(stats->IsAnalyzed());
+  ASSERT_EQ(row_nums, stats->GetRowCount());
+  ASSERT_LT(0, stats->GetPageCount());
+  // 64个寄存器的HLL标准误差约13%
+  EXPECT_NEAR(row_nums, stats->GetColumnStatistics(0).GetDistinctCount(), row_nums * 0.3);
+  EXPECT_NEAR(50, stats->GetColumnStatistics(1).GetDistinctCount(), 50 * 0.3);
+  EXPECT_NEAR(0.25, stats->GetColumnStatistics(2).GetNullFraction(), 1e-9);
+  EXPECT_EQ(STATS_HISTOGRAM_BUCKETS, stats->GetColumnStatistics(0).GetBucketCount());
+  double less = stats->GetColumnStatistics(0).EstimateSelectivity("<", Field(TypeId::kTypeInt, 500));
+  EXPECT_NEAR(0.25, less, 0.02);
+  EXPECT_NEAR(0.75, stats->GetColumnStatistics(0).EstimateSelectivity(">=", Field(TypeId::kTypeInt, 500)), 0.02);
+  EXPECT_EQ(0, stats->GetColumnStatistics(0).EstimateSelectivity("=", Field(TypeId::kTypeInt, -1)));
+  EXPECT_NEAR(0.75 * 0.5, stats->GetColumnStatistics(2).EstimateSelectivity("<", Field(TypeId::kTypeFloat, 1500.0f)),
+              0.02);
+  std::vector<Field> fields{Field(TypeId::kTypeInt, row_nums), Field(TypeId::kTypeChar, const_cast<char *>("x"), 1, true),
+                            Field(TypeId::kTypeFloat, 0.5f)};
+  Row row(fields);
+  stats->OnInsert(row);
+  delete db_01;
+  /** Stage 2: statistics are loaded from the table meta page */
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  TableInfo *table_info_02 = nullptr;
+  ASSERT_EQ(DB_SUCCESS, db_02->catalog_mgr_->GetTable("table-1", table_info_02));
+  auto stats_02 = table_info_02->GetStatistics();
+  ASSERT_TRUE(stats_02->IsAnalyzed());
+  ASSERT_EQ(row_nums + 1, stats_02->GetRowCount());
+  ASSERT_EQ(1, stats_02->GetModifiedRows());
+  EXPECT_EQ(STATS_HISTOGRAM_BUCKETS, stats_02->GetColumnStatistics(0).GetBucketCount());
+  EXPECT_DOUBLE_EQ(less, stats_02->GetColumnStatistics(0).EstimateSelectivity("<", Field(TypeId::kTypeInt, 500)));
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogDictionaryTest) {
+  /** Stage 1: a column declared as dictionary, another one encoded by ANALYZE */
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("city", TypeId::kTypeChar, 32, 1, true, false),
+                                   new Column("tag", TypeId::kTypeChar, 16, 2, true, false)};
+  auto schema = new Schema(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_FAILED, catalog_01->CreateTable("table-0", schema, &txn, table_info, TableLayout::kRow, {0}));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema, &txn, table_info, TableLayout::kRow, {1}));
+  auto table_heap = table_info->GetTableHeap();
+  ASSERT_NE(nullptr, table_heap->GetDictionary(1));
+  ASSERT_EQ(nullptr, table_heap->GetDictionary(2));
+  const int row_nums = 1000;
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    std::string city = "city-" + std::to_string(i % 10);
+    std::string tag = "tag-" + std::to_string(i % 5);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              i % 7 == 0 ? Field(TypeId::kTypeChar)
+                                         : Field(TypeId::kTypeChar, const_cast<char *>(city.c_str()), city.length(), true),
+                              Field(TypeId::kTypeChar, const_cast<char *>(tag.c_str()), tag.length(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // null不进入字典
+  ASSERT_EQ(10, table_heap->GetDictionary(1)->GetSize());
+  ASSERT_EQ(DB_SUCCESS, catalog_01->AnalyzeTable("table-1"));
+  ASSERT_NE(nullptr, table_heap->GetDictionary(2));
+  ASSERT_EQ(5, table_heap->GetDictionary(2)->GetSize());
+  delete db_01;
+  /** Stage 2: dictionaries are loaded with the table, rows decode to the inserted values */
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  TableInfo *table_info_02 = nullptr;
+  ASSERT_EQ(DB_SUCCESS, db_02->catalog_mgr_->GetTable("table-1", table_info_02));
+  auto table_heap_02 = table_info_02->GetTableHeap();
+  ASSERT_NE(nullptr, table_heap_02->GetDictionary(1));
+  ASSERT_NE(nullptr, table_heap_02->GetDictionary(2));
+  for (int i = 0; i < row_nums; i++) {
+    Row row(rids[i]);
+    ASSERT_TRUE(table_heap_02->GetTuple(&row, nullptr));
+    std::string city = "city-" + std::to_string(i % 10);
+    std::string tag = "tag-" + std::to_string(i % 5);
+    ASSERT_EQ(i % 7 == 0, row.GetField(1)->IsNull());
+    if (i % 7 != 0) {
+      ASSERT_EQ(city, std::string(row.GetField(1)->GetData(), row.GetField(1)->GetLength()));
+    }
+    ASSERT_EQ(tag, std::string(row.GetField(2)->GetData(), row.GetField(2)->GetLength()));
+  }
+  int count = 0;
+  for (auto it = table_heap_02->Begin(nullptr); it != table_heap_02->End(); it++) {
+    ASSERT_EQ(TypeId::kTypeChar, it->GetField(2)->GetTypeId());
+    count++;
+  }
+  ASSERT_EQ(row_nums, count);
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogLongDictionaryTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("text", TypeId::kTypeChar, 6000, 1, true, false)};
+  auto schema = new Schema(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  // 一个值放不进字典页
+  ASSERT_EQ(DB_FAILED, catalog_01->CreateTable("table-0", schema, &txn, table_info, TableLayout::kRow, {1}));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema, &txn, table_info, TableLayout::kRow));
+  auto table_heap = table_info->GetTableHeap();
+  const int row_nums = 200;
+  std::vector<std::string> texts{std::string(5000, 'a'), std::string(5000, 'b'), std::string(5000, 'c')};
+  for (int i = 0; i < row_nums; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(texts[i % 3].c_str()), 5000, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  // 取值少、重复多，但列太长，ANALYZE不改用字典编码
+  ASSERT_EQ(DB_SUCCESS, catalog_01->AnalyzeTable("table-1"));
+  ASSERT_EQ(nullptr, table_heap->GetDictionary(1));
+  int count = 0;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); it++) {
+    int id = count++;
+    ASSERT_EQ(texts[id % 3], std::string(it->GetField(1)->GetData(), it->GetField(1)->GetLength()));
+  }
+  ASSERT_EQ(row_nums, count);
+  delete db_01;
+}
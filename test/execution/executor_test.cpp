@@ -1,6 +1,7 @@
 //
 // Created by njz on 2023/1/26.
 //
+#include "executor/executors/seq_scan_executor.h"
 #include "executor/plans/delete_plan.h"
 #include "executor/plans/insert_plan.h"
 #include "executor/plans/seq_scan_plan.h"
@@ -31,6 +32,82 @@ TEST_F(ExecutorTest, SimpleSeqScanTest) {
   }
 }
 
+// SELECT id FROM table-1 WHERE id >= 3000, on a table large enough to be scanned by morsels in parallel
+TEST_F(ExecutorTest, ParallelSeqScanTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  TableHeap *table_heap = table_info->GetTableHeap();
+  for (int i = 1000; i < 5000; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>("abc"), 3, true),
+                  Field(TypeId::kTypeFloat, 1.f)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  std::vector<page_id_t> page_ids;
+  table_heap->GetPageIds(page_ids);
+  ASSERT_GE(page_ids.size(), SEQ_SCAN_MORSEL_PAGES * SEQ_SCAN_PARALLEL_MIN_MORSELS);
+
+  const Schema *schema = table_info->GetSchema();
+  auto col_a = MakeColumnValueExpression(*schema, 0, "id");
+  auto const3000 = MakeConstantValueExpression(Field(kTypeInt, 3000));
+  auto predicate = MakeComparisonExpression(col_a, const3000, ">=");
+  auto out_schema = MakeOutputSchema({{"id", col_a}});
+  auto plan = make_shared<SeqScanPlanNode>(out_schema, table_info->GetTableName(), predicate);
+  std::vector<Row> result_set{};
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+
+  // morsel results are merged in page order, so the rows come back in insert order
+  ASSERT_EQ(2000, result_set.size());
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(CmpBool::kTrue, result_set[i].GetField(0)->CompareEquals(Field(kTypeInt, 3000 + (int)i)));
+  }
+  ASSERT_TRUE(GetExecutorContext()->GetBufferPoolManager()->CheckAllUnpinned());
+  // a consumer may stop early, the executor waits for the morsels still being scanned
+  {
+    SeqScanExecutor executor(GetExecutorContext(), plan.get());
+    executor.Init();
+    Row row;
+    RowId rid;
+    for (int i = 0; i < 3; i++) {
+      ASSERT_TRUE(executor.Next(&row, &rid));
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(kTypeInt, 3000 + i)));
+    }
+  }
+  ASSERT_TRUE(GetExecutorContext()->GetBufferPoolManager()->CheckAllUnpinned());
+}
+
+// SELECT id FROM table-1 WHERE id < 10, pages holding only larger ids are skipped by the zone map
+TEST_F(ExecutorTest, ZoneMapSkipTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  TableHeap *table_heap = table_info->GetTableHeap();
+  const Schema *schema = table_info->GetSchema();
+  auto col_a = MakeColumnValueExpression(*schema, 0, "id");
+  auto const10 = MakeConstantValueExpression(Field(kTypeInt, 10));
+  auto predicate = MakeComparisonExpression(col_a, const10, "<");
+  auto out_schema = MakeOutputSchema({{"id", col_a}});
+  auto plan = make_shared<SeqScanPlanNode>(out_schema, table_info->GetTableName(), predicate);
+  std::vector<Row> result_set{};
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(10, result_set.size());
+  std::vector<page_id_t> page_ids;
+  table_heap->GetPageIds(page_ids);
+  ASSERT_EQ(page_ids.size() - 1, GetExecutorContext()->GetPagesSkipped());
+
+  // an update widens the synopsis of its page, so the row is still found
+  RowId last_rid;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    last_rid = iter->GetRowId();
+  }
+  char name[] = "updated";
+  Fields fields{Field(TypeId::kTypeInt, 5), Field(TypeId::kTypeChar, name, 7, true), Field(TypeId::kTypeFloat, 0.f)};
+  ASSERT_TRUE(table_heap->UpdateTuple(Row(fields), last_rid, nullptr));
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(11, result_set.size());
+  ASSERT_EQ(last_rid, result_set.back().GetRowId());
+}
+
 // DELETE FROM table-1 WHERE id == 50;
 TEST_F(ExecutorTest, SimpleDeleteTest) {
   // Construct query plan
@@ -112,6 +189,55 @@ TEST_F(ExecutorTest, SimpleRawInsertTest) {
   ASSERT_TRUE(result_set[0].GetField(2)->CompareEquals(Field(kTypeFloat, static_cast<float>(2.33))));
 }
 
+// INSERT INTO table-1 VALUES (1001, "dup", 1.5); INSERT INTO table-1 VALUES (500, "dup", 2.5);
+TEST_F(ExecutorTest, DuplicateInsertTest) {
+  // 唯一索引先建，catalog中它排在非唯一索引后面，插入时仍要先查它
+  IndexInfo *id_index = nullptr;
+  IndexInfo *name_index = nullptr;
+  std::vector<std::string> id_keys{"id"};
+  std::vector<std::string> name_keys{"name"};
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-id", id_keys, GetTxn(),
+                                                                        id_index, "bptree", true));
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-name", name_keys, GetTxn(),
+                                                                        name_index, "bptree", false));
+  Field dup_name(kTypeChar, const_cast<char *>("dup"), 3, false);
+  auto insert = [&](int id, float account) {
+    auto const1 = MakeConstantValueExpression(Field(kTypeInt, id));
+    auto const2 = MakeConstantValueExpression(dup_name);
+    auto const3 = MakeConstantValueExpression(Field(kTypeFloat, account));
+    std::vector<std::vector<AbstractExpressionRef>> raw_values{{const1, const2, const3}};
+    auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+    auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-1");
+    GetExecutionEngine()->ExecutePlan(insert_plan, nullptr, GetTxn(), GetExecutorContext());
+  };
+  insert(1001, 1.5);
+  // id 500已经存在
+  insert(500, 2.5);
+
+  // SELECT * FROM table-1 where name = "dup";
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto predicate = MakeComparisonExpression(col_name, MakeConstantValueExpression(dup_name), "=");
+  auto scan_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(), predicate);
+  std::vector<Row> result_set{};
+  GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_TRUE(result_set[0].GetField(0)->CompareEquals(Field(kTypeInt, 1001)));
+
+  // 被拒绝的行不能在另一个索引中留下entry
+  std::vector<RowId> rids{};
+  Fields name_key{Field(kTypeChar, const_cast<char *>("dup"), 3, false)};
+  name_index->GetIndex()->ScanKey(Row(name_key), rids, GetTxn());
+  ASSERT_EQ(rids.size(), 1);
+  ASSERT_EQ(rids[0], result_set[0].GetRowId());
+  rids.clear();
+  Fields id_key{Field(kTypeInt, 500)};
+  id_index->GetIndex()->ScanKey(Row(id_key), rids, GetTxn());
+  ASSERT_EQ(rids.size(), 1);
+}
+
 // UPDATE table-1 SET name = "minisql" where id = 500;
 TEST_F(ExecutorTest, SimpleUpdateTest) {
   // Construct a sequential scan of the table
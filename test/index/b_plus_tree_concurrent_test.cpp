@@ -0,0 +1,171 @@
+#include <chrono>
+#include <thread>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "index/b_plus_tree.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "bp_tree_concurrent_test.db";
+
+namespace {
+
+std::vector<GenericKey *> MakeKeys(KeyManager &KP, Schema *schema, int n) {
+  std::vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), schema);
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+// 第t个线程处理下标 i % num_threads == t 的key
+template <typename F>
+void RunThreads(int num_threads, F &&f) {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back(f, t);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace
+
+TEST(BPlusTreeConcurrentTests, InsertTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  // 小页让插入频繁分裂
+  BPlusTree tree(0, engine.bpm_, KP, 8, 8);
+  const int n = 4000, num_threads = 4;
+  auto keys = MakeKeys(KP, table_schema, n);
+  ShuffleArray(keys);
+  RunThreads(num_threads, [&](int t) {
+    for (int i = t; i < n; i += num_threads) {
+      ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+    }
+  });
+  ASSERT_TRUE(tree.Check());
+  std::vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(keys[i], ans));
+    ASSERT_EQ(RowId(i), ans.back());
+  }
+  // 重复插入失败
+  RunThreads(num_threads, [&](int t) {
+    for (int i = t; i < n; i += num_threads) {
+      ASSERT_FALSE(tree.Insert(keys[i], RowId(i)));
+    }
+  });
+  ASSERT_TRUE(tree.Check());
+}
+
+// 并发删除、插入和查找，mode决定查找的遍历方式，resident_levels层内部页常驻
+static void MixedWorkload(BPlusTree::LookupMode mode, int resident_levels = 0) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP, 8, 8);
+  tree.SetLookupMode(mode);
+  tree.SetResidentLevels(resident_levels);
+  const int n = 3000, num_threads = 4;
+  auto keys = MakeKeys(KP, table_schema, 2 * n);
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+  }
+  // 线程0、1删除[0, n)中的偶数key并插入[n, 2n)，线程2、3反复查找从不删除的奇数key
+  RunThreads(num_threads, [&](int t) {
+    std::vector<RowId> ans;
+    if (t < 2) {
+      for (int i = t * 2; i < n; i += 4) {
+        tree.Remove(keys[i]);
+        ASSERT_TRUE(tree.Insert(keys[n + i], RowId(n + i)));
+      }
+    } else {
+      for (int round = 0; round < 2; round++) {
+        for (int i = 1; i < n; i += 2) {
+          ASSERT_TRUE(tree.GetValue(keys[i], ans));
+          ASSERT_EQ(RowId(i), ans.back());
+        }
+        // 范围扫描按序看到全部奇数key
+        int next_odd = 1, last = -1;
+        for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+          int i = static_cast<int>((*iter).second.Get());
+          ASSERT_LT(last, i);
+          last = i;
+          if (i == next_odd) {
+            next_odd += 2;
+          }
+        }
+        ASSERT_LE(n, next_odd);
+      }
+    }
+  });
+  // 常驻页在Check释放之前一直被pin住
+  ASSERT_EQ(resident_levels == 0, engine.bpm_->CheckAllUnpinned());
+  ASSERT_TRUE(tree.Check());
+  std::vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i % 2 == 1, tree.GetValue(keys[i], ans));
+    ASSERT_EQ(i % 2 == 0, tree.GetValue(keys[n + i], ans));
+  }
+  // 并发删空整棵树
+  RunThreads(num_threads, [&](int t) {
+    for (int i = t; i < 2 * n; i += num_threads) {
+      tree.Remove(keys[i]);
+    }
+  });
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Check());
+}
+
+TEST(BPlusTreeConcurrentTests, MixedTest) { MixedWorkload(BPlusTree::LookupMode::kCrabbing); }
+
+TEST(BPlusTreeConcurrentTests, OptimisticMixedTest) { MixedWorkload(BPlusTree::LookupMode::kOptimistic); }
+
+TEST(BPlusTreeConcurrentTests, ResidentLevelsTest) {
+  MixedWorkload(BPlusTree::LookupMode::kCrabbing, 2);
+  MixedWorkload(BPlusTree::LookupMode::kOptimistic, 3);
+}
+
+TEST(BPlusTreeConcurrentTests, ThroughputBenchmark) {
+  const int n = 20000;
+  for (auto mode : {BPlusTree::LookupMode::kCrabbing, BPlusTree::LookupMode::kOptimistic}) {
+    for (int num_threads : {1, 2, 4, 8}) {
+      DBStorageEngine engine(db_name);
+      std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+      Schema *table_schema = new Schema(columns);
+      KeyManager KP(table_schema, 16);
+      BPlusTree tree(0, engine.bpm_, KP);
+      tree.SetLookupMode(mode);
+      auto keys = MakeKeys(KP, table_schema, n);
+      ShuffleArray(keys);
+      auto start = std::chrono::steady_clock::now();
+      RunThreads(num_threads, [&](int t) {
+        for (int i = t; i < n; i += num_threads) {
+          tree.Insert(keys[i], RowId(i));
+        }
+      });
+      auto mid = std::chrono::steady_clock::now();
+      RunThreads(num_threads, [&](int t) {
+        std::vector<RowId> ans;
+        for (int i = t; i < n; i += num_threads) {
+          tree.GetValue(keys[i], ans);
+        }
+      });
+      auto end = std::chrono::steady_clock::now();
+      double insert_sec = std::chrono::duration<double>(mid - start).count();
+      double lookup_sec = std::chrono::duration<double>(end - mid).count();
+      std::cout << (mode == BPlusTree::LookupMode::kOptimistic ? "optimistic " : "crabbing ") << num_threads
+                << " threads: " << static_cast<int64_t>(n / insert_sec) << " inserts/s, "
+                << static_cast<int64_t>(n / lookup_sec) << " lookups/s" << std::endl;
+      ASSERT_TRUE(tree.Check());
+    }
+  }
+}
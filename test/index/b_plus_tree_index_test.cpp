@@ -28,6 +28,61 @@ TEST(BPlusTreeTests, BPlusTreeIndexGenericKeyTest) {
   ASSERT_EQ(0, KP.CompareKeys(k1, k2));
 }
 
+TEST(BPlusTreeTests, KeyEncodingOrderTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 1, true, false),
+                                   new Column("name", TypeId::kTypeChar, 8, 2, true, false)};
+  Schema schema(columns);
+  KeyManager KP(&schema, 32);
+  ASSERT_EQ(5u + 5u + 13u, KeyManager::GetEncodedSize(&schema));
+  // keys in ascending order, comparing their encodings must give the same order
+  std::vector<std::vector<Field>> keys = {
+      {Field(kTypeInt), Field(kTypeFloat, 0.0f), Field(kTypeChar, const_cast<char *>("a"), 1, true)},
+      {Field(kTypeInt, INT32_MIN), Field(kTypeFloat, 0.0f), Field(kTypeChar, const_cast<char *>("a"), 1, true)},
+      {Field(kTypeInt, -1), Field(kTypeFloat, -2.5f), Field(kTypeChar, const_cast<char *>("a"), 1, true)},
+      {Field(kTypeInt, -1), Field(kTypeFloat, -0.5f), Field(kTypeChar, const_cast<char *>("a"), 1, true)},
+      {Field(kTypeInt, -1), Field(kTypeFloat, 0.5f), Field(kTypeChar, const_cast<char *>("a"), 1, true)},
+      {Field(kTypeInt, 0), Field(kTypeFloat, 0.5f), Field(kTypeChar)},
+      {Field(kTypeInt, 0), Field(kTypeFloat, 0.5f), Field(kTypeChar, const_cast<char *>("ab"), 2, true)},
+      {Field(kTypeInt, 0), Field(kTypeFloat, 0.5f), Field(kTypeChar, const_cast<char *>("ab\0"), 3, true)},
+      {Field(kTypeInt, 0), Field(kTypeFloat, 0.5f), Field(kTypeChar, const_cast<char *>("abc"), 3, true)},
+      {Field(kTypeInt, 0), Field(kTypeFloat, 0.5f), Field(kTypeChar, const_cast<char *>("b"), 1, true)},
+      {Field(kTypeInt, 7), Field(kTypeFloat, 1e30f), Field(kTypeChar, const_cast<char *>("a"), 1, true)},
+      {Field(kTypeInt, INT32_MAX), Field(kTypeFloat, 0.0f), Field(kTypeChar, const_cast<char *>("a"), 1, true)}};
+  std::vector<GenericKey *> encoded;
+  for (auto &fields : keys) {
+    encoded.push_back(KP.InitKey());
+    KP.SerializeFromKey(encoded.back(), Row(fields), &schema);
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      int cmp = KP.CompareKeys(encoded[i], encoded[j]);
+      ASSERT_EQ(i < j, cmp < 0) << i << " " << j;
+      ASSERT_EQ(i == j, cmp == 0) << i << " " << j;
+    }
+    // the encoding can be decoded back into the key
+    Row decoded;
+    KP.DeserializeToKey(encoded[i], decoded, &schema);
+    for (uint32_t k = 0; k < schema.GetColumnCount(); k++) {
+      ASSERT_EQ(keys[i][k].IsNull(), decoded.GetField(k)->IsNull());
+      if (!keys[i][k].IsNull()) {
+        ASSERT_EQ(CmpBool::kTrue, keys[i][k].CompareEquals(*decoded.GetField(k)));
+      }
+    }
+  }
+  // -0.0 == 0.0, they must get the same encoding
+  std::vector<Field> negative_zero{Field(kTypeInt, 0), Field(kTypeFloat, -0.0f), Field(kTypeChar)};
+  std::vector<Field> positive_zero{Field(kTypeInt, 0), Field(kTypeFloat, 0.0f), Field(kTypeChar)};
+  encoded.push_back(KP.InitKey());
+  KP.SerializeFromKey(encoded.back(), Row(negative_zero), &schema);
+  encoded.push_back(KP.InitKey());
+  KP.SerializeFromKey(encoded.back(), Row(positive_zero), &schema);
+  ASSERT_EQ(0, KP.CompareKeys(encoded[encoded.size() - 2], encoded.back()));
+  for (auto key : encoded) {
+    free(key);
+  }
+}
+
 TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
   //  using INDEX_KEY_TYPE = GenericKey<32>;
   //  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
@@ -47,6 +102,12 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     RowId rid(1000, i);
     ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, rid, nullptr));
   }
+  // 唯一索引中已有的key不会被再次插入，原entry不变
+  for (int i = 0; i < 10; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+    ASSERT_EQ(DB_ALREADY_EXIST, index->InsertEntryIfAbsent(Row(fields), RowId(2000, i), nullptr));
+  }
   // Test Scan
   std::vector<RowId> ret;
   for (int i = 0; i < 10; i++) {
@@ -66,4 +127,128 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     i++;
   }
   delete index;
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, NonUniqueIndexTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("status", TypeId::kTypeInt, 1, true, false)};
+  std::vector<uint32_t> index_key_map{1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new BPlusTreeIndex(0, index_schema, 16, engine.bpm_, false);
+  // 2000条记录的status只有10个取值，跨越多个叶子
+  const int n = 2000, values = 10;
+  auto key = [](int status) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, status)};
+    return Row(fields);
+  };
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(key(i % values), RowId(i / 100, i % 100), nullptr));
+  }
+  // 同一(key, RowId)不能插入两次
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(key(0), RowId(0, 0), nullptr));
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(key(3), ret, nullptr));
+  ASSERT_EQ(n / values, ret.size());
+  for (size_t i = 0; i < ret.size(); i++) {
+    int id = ret[i].GetPageId() * 100 + ret[i].GetSlotNum();
+    ASSERT_EQ(3, id % values);
+    // 同一key的entry按RowId排序
+    ASSERT_TRUE(i == 0 || ret[i - 1].Get() < ret[i].Get());
+  }
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(key(3), ret, nullptr, "<"));
+  ASSERT_EQ(3 * n / values, ret.size());
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(key(3), ret, nullptr, ">"));
+  ASSERT_EQ(6 * n / values, ret.size());
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(key(3), ret, nullptr, "<>"));
+  ASSERT_EQ(9 * n / values, ret.size());
+  // 删除只作用于给定的(key, RowId)
+  ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(key(3), RowId(0, 3), nullptr));
+  ret.clear();
+  index->ScanKey(key(3), ret, nullptr);
+  ASSERT_EQ(n / values - 1, ret.size());
+  ASSERT_TRUE(std::find(ret.begin(), ret.end(), RowId(0, 3)) == ret.end());
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(key(values), ret, nullptr));
+  delete index;
+}
+
+TEST(BPlusTreeTests, CompositePrefixRangeTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("region", TypeId::kTypeInt, 0, false, false),
+                                   new Column("id", TypeId::kTypeInt, 1, false, false)};
+  std::vector<uint32_t> index_key_map{0, 1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  for (bool unique : {true, false}) {
+    auto *index = new BPlusTreeIndex(0, index_schema, 32, engine.bpm_, unique);
+    // 5个region，每个region的id为0..399
+    for (int i = 0; i < 2000; i++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i % 5), Field(TypeId::kTypeInt, i / 5)};
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(i), nullptr));
+    }
+    auto count = [&](std::vector<Field> low, bool low_inclusive, std::vector<Field> high, bool high_inclusive) {
+      Row low_key(low), high_key(high);
+      int n = 0;
+      for (auto iter = index->GetRangeIterator(&low_key, low_inclusive, &high_key, high_inclusive);
+           iter != index->GetEndIterator(); ++iter) {
+        EXPECT_EQ(3, (*iter).second.Get() % 5);
+        n++;
+      }
+      return n;
+    };
+    // region = 3
+    ASSERT_EQ(400, count({Field(TypeId::kTypeInt, 3)}, true, {Field(TypeId::kTypeInt, 3)}, true));
+    // region = 3 and id > 100
+    ASSERT_EQ(299, count({Field(TypeId::kTypeInt, 3), Field(TypeId::kTypeInt, 100)}, false,
+                         {Field(TypeId::kTypeInt, 3)}, true));
+    // region = 3 and id >= 100 and id < 200
+    ASSERT_EQ(100, count({Field(TypeId::kTypeInt, 3), Field(TypeId::kTypeInt, 100)}, true,
+                         {Field(TypeId::kTypeInt, 3), Field(TypeId::kTypeInt, 200)}, false));
+    // region = 3 and id <= 9
+    ASSERT_EQ(10, count({Field(TypeId::kTypeInt, 3)}, true,
+                        {Field(TypeId::kTypeInt, 3), Field(TypeId::kTypeInt, 9)}, true));
+    index->Destroy();
+    delete index;
+  }
+}
+
+TEST(BPlusTreeTests, IncludeColumnsTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 4, 1, true, false)};
+  std::vector<uint32_t> index_key_map{0, 1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  // name是INCLUDE列，只存放不比较
+  auto *index = new BPlusTreeIndex(0, index_schema, 32, engine.bpm_, true, 1);
+  auto key = [](int id, const char *name) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, id),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name), strlen(name), true)};
+    return Row(fields);
+  };
+  for (int i = 100; i > 0; i--) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(key(i, i % 2 ? "odd" : "even"), RowId(i), nullptr));
+  }
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(key(5, "five"), RowId(500), nullptr));
+  // 查找只用key列
+  std::vector<RowId> ret;
+  std::vector<Field> id_field{Field(TypeId::kTypeInt, 5)};
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(id_field), ret, nullptr));
+  ASSERT_EQ(1, ret.size());
+  ASSERT_EQ(RowId(5), ret[0]);
+  int id = 0;
+  for (auto iter = index->GetBeginIterator(); iter != index->GetEndIterator(); ++iter) {
+    Row decoded;
+    ASSERT_TRUE(index->DecodeKey((*iter).first, &decoded));
+    ASSERT_EQ(++id, (*iter).second.Get());
+    ASSERT_EQ(kTrue, decoded.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, id)));
+    ASSERT_EQ(id % 2 ? "odd" : "even", std::string(decoded.GetField(1)->GetData(), decoded.GetField(1)->GetLength()));
+  }
+  ASSERT_EQ(100, id);
+  index->Destroy();
+  delete index;
+}
@@ -3,6 +3,7 @@
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/comparator.h"
+#include "index/index_sorter.h"
 #include "utils/tree_file_mgr.h"
 #include "utils/utils.h"
 
@@ -69,4 +70,250 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, BulkLoadTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  // 小页得到多层树
+  BPlusTree tree(0, engine.bpm_, KP, 8, 8);
+  const int n = 2000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  vector<int> order;
+  for (int i = 0; i < n; i++) {
+    order.push_back(i);
+  }
+  ShuffleArray(order);
+  {
+    // 内存只放100个entry，排序需要多个run
+    IndexSorter sorter(engine.bpm_, KP, 100 * (16 + sizeof(RowId)));
+    for (int i : order) {
+      sorter.Add(keys[i], RowId(i));
+    }
+    sorter.Finish();
+    ASSERT_GT(sorter.GetRunCount(), 1);
+    ASSERT_TRUE(tree.BulkLoad(&sorter, 0.7));
+  }
+  ASSERT_TRUE(tree.Check());
+  vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(keys[i], ans));
+    ASSERT_EQ(RowId(i), ans.back());
+  }
+  // 装入后的树可以继续插入和删除
+  ASSERT_FALSE(tree.Insert(keys[0], RowId(0)));
+  for (int i = 0; i < n; i += 2) {
+    tree.Remove(keys[i]);
+  }
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i % 2 == 1, tree.GetValue(keys[i], ans));
+  }
+  // 非空树或重复的key不能装入
+  BPlusTree other(1, engine.bpm_, KP, 8, 8);
+  IndexSorter sorter(engine.bpm_, KP);
+  for (int i = 0; i < n; i++) {
+    sorter.Add(keys[i / 2], RowId(i));
+  }
+  sorter.Finish();
+  ASSERT_FALSE(tree.BulkLoad(&sorter));
+  ASSERT_FALSE(other.BulkLoad(&sorter));
+  ASSERT_TRUE(other.IsEmpty());
+  ASSERT_TRUE(other.Check());
+}
+
+TEST(BPlusTreeTests, PrefixCompressionTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP);
+  const int n = 20000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  vector<GenericKey *> order(keys);
+  ShuffleArray(order);
+  for (auto key : order) {
+    ASSERT_TRUE(tree.Insert(key, RowId(0)));
+  }
+  ASSERT_TRUE(tree.Check());
+  // 两端之外的叶子都有有限的fence，共享前缀后能放下更多entry
+  int leaves = 0, compressed = 0;
+  Page *page = tree.FindLeafPage(nullptr, true);
+  while (true) {
+    auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaves++;
+    if (leaf->GetPrefixSize() > 0) {
+      compressed++;
+      ASSERT_GT(leaf->GetMaxSize(), LeafPage::MaxSizeFor(KP.GetKeySize(), 0));
+    }
+    page_id_t next_page_id = leaf->GetNextPageId();
+    page->RUnlatch();
+    engine.bpm_->UnpinPage(page->GetPageId(), false);
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page = engine.bpm_->FetchPage(next_page_id);
+    page->RLatch();
+  }
+  ASSERT_GT(leaves, 2);
+  ASSERT_EQ(leaves - 2, compressed);
+  // 迭代器还原出完整的key
+  int i = 0;
+  for (auto it = tree.Begin(); it != tree.End(); ++it, i++) {
+    ASSERT_EQ(0, KP.CompareKeys((*it).first, keys[i]));
+  }
+  ASSERT_EQ(n, i);
+  // 合并和借entry会缩短前缀
+  ShuffleArray(order);
+  vector<RowId> ans;
+  for (int j = 0; j < n; j++) {
+    tree.Remove(order[j]);
+    if (j % 1000 == 0) {
+      ASSERT_FALSE(tree.GetValue(order[j], ans));
+      ASSERT_TRUE(j + 1 == n || tree.GetValue(order[j + 1], ans));
+    }
+  }
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeTests, ShrinkingPrefixRemoveTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("name", TypeId::kTypeChar, 64, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, KeyManager::GetEncodedSize(table_schema));
+  BPlusTree tree(0, engine.bpm_, KP);
+  // 同一组的key共享很长的前缀，跨组的叶子没有前缀，能放下的entry少得多
+  const int groups = 4, per_group = 1000, n = groups * per_group;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    std::string name = std::string(1, 'a' + i / per_group) + std::string(50, 'x') + std::to_string(10000 + i);
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  // 降序插入，每次分裂都对半分
+  for (int i = n - 1; i >= 0; i--) {
+    ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+  }
+  // @return 少于最小值的非根叶子数
+  auto underfull_leaves = [&]() {
+    int underfull = 0;
+    Page *page = tree.FindLeafPage(nullptr, true);
+    if (page == nullptr) {
+      return underfull;
+    }
+    auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    bool is_root = leaf->GetNextPageId() == INVALID_PAGE_ID;
+    while (true) {
+      if (!is_root && leaf->GetSize() < leaf->GetMinSize()) {
+        underfull++;
+      }
+      page_id_t next_page_id = leaf->GetNextPageId();
+      page->RUnlatch();
+      engine.bpm_->UnpinPage(page->GetPageId(), false);
+      if (next_page_id == INVALID_PAGE_ID) {
+        return underfull;
+      }
+      page = engine.bpm_->FetchPage(next_page_id);
+      page->RLatch();
+      leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    }
+  };
+  ASSERT_EQ(0, underfull_leaves());
+  // 删除时合并和借entry常常跨组，前缀变短后叶子仍不少于最小值
+  vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  ShuffleArray(order);
+  for (int j = 0; j < n; j++) {
+    tree.Remove(keys[order[j]]);
+    ASSERT_EQ(0, underfull_leaves()) << j;
+  }
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(BPlusTreeTests, AppendSplitTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  // 小的内部节点使追加分裂也发生在上层
+  BPlusTree tree(0, engine.bpm_, KP, UNDEFINED_SIZE, 16);
+  const int n = 20000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+    ASSERT_TRUE(tree.Insert(key, RowId(i)));
+  }
+  ASSERT_TRUE(tree.Check());
+  // 递增插入时叶子接近装满，而不是只有一半。分裂后左页有了上界，压缩出的空间不计入
+  int entries = 0, leaves = 0;
+  Page *page = tree.FindLeafPage(nullptr, true);
+  while (true) {
+    auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    entries += leaf->GetSize();
+    leaves++;
+    page_id_t next_page_id = leaf->GetNextPageId();
+    page->RUnlatch();
+    engine.bpm_->UnpinPage(page->GetPageId(), false);
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page = engine.bpm_->FetchPage(next_page_id);
+    page->RLatch();
+  }
+  ASSERT_EQ(n, entries);
+  ASSERT_GT(entries, leaves * LeafPage::MaxSizeFor(KP.GetKeySize(), 0) * 0.85);
+  vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(keys[i], ans));
+    ASSERT_EQ(RowId(i), ans.back());
+  }
+  // 右侧不满的页也能正常删除
+  for (int i = n - 1; i >= 0; i--) {
+    tree.Remove(keys[i]);
+    if (i % 1000 == 0) {
+      ASSERT_FALSE(tree.GetValue(keys[i], ans));
+      ASSERT_TRUE(i == 0 || tree.GetValue(keys[i - 1], ans));
+    }
+  }
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+}
@@ -0,0 +1,153 @@
+#include "index/extendible_hash_table.h"
+
+#include <thread>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "hash_table_test.db";
+
+TEST(ExtendibleHashTableTests, InsertRemoveTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  ExtendibleHashTable table(0, engine.bpm_, KP);
+  const int n = 20000;
+  std::vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  ShuffleArray(keys);
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(table.Insert(keys[i], RowId(i)));
+  }
+  ASSERT_TRUE(table.Check());
+  // 一页放不下全部key，目录必须扩张过
+  ASSERT_LT(0u, table.GetGlobalDepth());
+  std::vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ans.clear();
+    ASSERT_TRUE(table.GetValue(keys[i], ans));
+    ASSERT_EQ(1u, ans.size());
+    ASSERT_EQ(RowId(i), ans[0]);
+    ASSERT_FALSE(table.Insert(keys[i], RowId(i)));
+  }
+  // 值不匹配时不删除
+  ASSERT_FALSE(table.Remove(keys[0], RowId(1)));
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_TRUE(table.Remove(keys[i], RowId(i)));
+    ASSERT_FALSE(table.Remove(keys[i], RowId(i)));
+  }
+  ASSERT_TRUE(table.Check());
+  for (int i = 0; i < n; i++) {
+    ans.clear();
+    ASSERT_EQ(i % 2 == 1, table.GetValue(keys[i], ans));
+  }
+  // 删空后桶全部合并，目录缩回一个槽
+  for (int i = 1; i < n; i += 2) {
+    ASSERT_TRUE(table.Remove(keys[i], RowId(i)));
+  }
+  ASSERT_TRUE(table.Check());
+  ASSERT_EQ(0u, table.GetGlobalDepth());
+  // 目录页记录在index roots page中，重新打开后数据仍在
+  ASSERT_TRUE(table.Insert(keys[0], RowId(0)));
+  ExtendibleHashTable reopened(0, engine.bpm_, KP);
+  ans.clear();
+  ASSERT_TRUE(reopened.GetValue(keys[0], ans));
+  ASSERT_EQ(RowId(0), ans[0]);
+  table.Destroy();
+  for (auto key : keys) {
+    free(key);
+  }
+}
+
+TEST(ExtendibleHashTableTests, OverflowChainTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+  Schema *table_schema = new Schema(columns);
+  // 非唯一索引的key带RowId后缀，但只按key列哈希，同一个值的entry都落在同一个桶
+  KeyManager KP(table_schema, 16, true);
+  ExtendibleHashTable table(0, engine.bpm_, KP);
+  const int n = 2000;
+  GenericKey *key = KP.InitKey();
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 42)};
+  KP.SerializeFromKey(key, Row(fields), table_schema);
+  for (int i = 0; i < n; i++) {
+    KP.SetRowId(key, RowId(i));
+    ASSERT_TRUE(table.Insert(key, RowId(i)));
+  }
+  ASSERT_TRUE(table.Check());
+  // 分裂不开的桶到达最大深度后挂溢出页
+  ASSERT_EQ(HASH_DIRECTORY_MAX_DEPTH, table.GetGlobalDepth());
+  std::vector<RowId> ans;
+  ASSERT_TRUE(table.GetValue(key, ans));
+  ASSERT_EQ(static_cast<size_t>(n), ans.size());
+  for (int i = 0; i < n; i += 3) {
+    KP.SetRowId(key, RowId(i));
+    ASSERT_TRUE(table.Remove(key, RowId(i)));
+  }
+  ASSERT_TRUE(table.Check());
+  ans.clear();
+  ASSERT_TRUE(table.GetValue(key, ans));
+  ASSERT_EQ(static_cast<size_t>(n - (n + 2) / 3), ans.size());
+  for (int i = 0; i < n; i++) {
+    if (i % 3 != 0) {
+      KP.SetRowId(key, RowId(i));
+      ASSERT_TRUE(table.Remove(key, RowId(i)));
+    }
+  }
+  ASSERT_TRUE(table.Check());
+  ASSERT_EQ(0u, table.GetGlobalDepth());
+  free(key);
+}
+
+TEST(ExtendibleHashTableTests, ConcurrentTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("int", TypeId::kTypeInt, 0, false, false)};
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  ExtendibleHashTable table(0, engine.bpm_, KP);
+  const int n = 8000, num_threads = 4;
+  std::vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  // 每个线程插入自己的key，再删除其中一半，同时查找从不删除的key
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      std::vector<RowId> ans;
+      for (int i = t; i < n; i += num_threads) {
+        ASSERT_TRUE(table.Insert(keys[i], RowId(i)));
+      }
+      for (int i = t; i < n; i += num_threads) {
+        if (i % 8 < 4) {
+          ASSERT_TRUE(table.Remove(keys[i], RowId(i)));
+        } else {
+          ans.clear();
+          ASSERT_TRUE(table.GetValue(keys[i], ans));
+          ASSERT_EQ(RowId(i), ans[0]);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_TRUE(table.Check());
+  std::vector<RowId> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i % 8 >= 4, table.GetValue(keys[i], ans));
+  }
+  for (auto key : keys) {
+    free(key);
+  }
+}
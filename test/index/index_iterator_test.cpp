@@ -53,3 +53,53 @@ TEST(BPlusTreeTests, IndexIteratorTest) {
     EXPECT_EQ(RowId((2 * i - 1) * 100), (*iter).second);
   }
 }
+
+TEST(BPlusTreeTests, BoundedIndexIteratorTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP, 8, 8);
+  // 偶数key 0, 2, ..., 398
+  vector<GenericKey *> keys;
+  for (int i = 0; i < 400; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.emplace_back(key);
+    if (i % 2 == 0) {
+      tree.Insert(key, RowId(i), nullptr);
+    }
+  }
+  auto count = [&](GenericKey *low, bool low_inclusive, GenericKey *high, bool high_inclusive) {
+    int n = 0;
+    int64_t last = -1;
+    for (auto iter = tree.Begin(low, low_inclusive, high, high_inclusive); iter != tree.End(); ++iter) {
+      EXPECT_LT(last, (*iter).second.Get());
+      last = (*iter).second.Get();
+      n++;
+    }
+    return n;
+  };
+  ASSERT_EQ(200, count(nullptr, true, nullptr, true));
+  ASSERT_EQ(51, count(keys[100], true, keys[200], true));
+  ASSERT_EQ(49, count(keys[100], false, keys[200], false));
+  ASSERT_EQ(50, count(keys[101], true, keys[201], true));
+  ASSERT_EQ(1, count(keys[100], true, keys[100], true));
+  ASSERT_EQ(0, count(keys[100], false, keys[100], true));
+  ASSERT_EQ(0, count(keys[200], true, keys[100], true));
+  ASSERT_EQ(10, count(nullptr, true, keys[20], false));
+  ASSERT_EQ(10, count(keys[379], false, nullptr, true));
+  // 中途放弃的迭代器释放叶子，修改后的叶子从当前key之后继续
+  {
+    auto iter = tree.Begin(keys[10], true, nullptr, true);
+    ++iter;
+    tree.Remove(keys[12]);
+    tree.Insert(keys[13], RowId(13), nullptr);
+    ++iter;
+    ASSERT_EQ(RowId(13), (*iter).second);
+  }
+  ASSERT_TRUE(tree.Check());
+}
@@ -6,6 +6,7 @@
 #include "record/field.h"
 #include "record/row.h"
 #include "record/schema.h"
+#include "record/type_kernels.h"
 
 char *chars[] = {const_cast<char *>(""), const_cast<char *>("hello"), const_cast<char *>("world!"),
                  const_cast<char *>("\0")};
@@ -98,6 +99,90 @@ TEST(TupleTest, RowTest) {
   for (size_t i = 0; i < row2_fields.size(); i++) {
     ASSERT_EQ(CmpBool::kTrue, row2_fields[i]->CompareEquals(fields[i]));
   }
+  // projected read only decodes the requested columns
+  Row row3(row.GetRowId());
+  ASSERT_TRUE(table_page.GetTuple(&row3, schema.get(), {2}, nullptr, nullptr));
+  ASSERT_EQ(3, row3.GetFieldCount());
+  ASSERT_EQ(nullptr, row3.GetField(0));
+  ASSERT_EQ(nullptr, row3.GetField(1));
+  ASSERT_EQ(CmpBool::kTrue, row3.GetField(2)->CompareEquals(fields[2]));
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
-}
\ No newline at end of file
+}
+TEST(TupleTest, ArenaRowTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name = "arena-row";
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 188),
+                            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.length(), true),
+                            Field(TypeId::kTypeFloat)};
+  Row heap_row(fields);
+  char buffer[PAGE_SIZE];
+  heap_row.SerializeTo(buffer, schema.get());
+  auto arena = std::make_unique<Arena>(256);
+  // 反序列化和拷贝都只占用arena
+  Row arena_row(arena.get());
+  arena_row.DeserializeFrom(buffer, schema.get());
+  ASSERT_EQ(arena.get(), arena_row.GetArena());
+  ASSERT_TRUE(heap_row == arena_row);
+  Row arena_copy(heap_row, arena.get());
+  ASSERT_TRUE(heap_row == arena_copy);
+  EXPECT_EQ(1, arena->GetBlockCount());
+  EXPECT_LT(0, arena->GetBytesUsed());
+  // 移动带走arena，普通拷贝在堆上，arena释放后仍然有效
+  Row moved(std::move(arena_row));
+  ASSERT_EQ(arena.get(), moved.GetArena());
+  ASSERT_EQ(nullptr, arena_row.GetArena());
+  Row copy(moved);
+  ASSERT_EQ(nullptr, copy.GetArena());
+  moved.destroy();
+  arena_copy.destroy();
+  arena.reset();
+  ASSERT_TRUE(heap_row == copy);
+  ASSERT_EQ(name, copy.GetField(1)->toString());
+  // 超过块大小的分配单独成块，Reset只保留第一块
+  Arena small(64);
+  small.Allocate(16);
+  small.Allocate(1000);
+  EXPECT_EQ(2, small.GetBlockCount());
+  small.Reset();
+  EXPECT_EQ(1, small.GetBlockCount());
+  EXPECT_EQ(0, small.GetBytesUsed());
+}
+
+TEST(TupleTest, TypeKernelTest) {
+  // 特化的比较和编解码与Type的虚函数实现结果一致
+  char lhs_buf[64];
+  char rhs_buf[64];
+  auto check = [&](Field *fields, size_t count, TypeId type) {
+    const FieldKernels &kernels = FieldKernels::Get(type);
+    for (size_t i = 0; i < count; i++) {
+      ASSERT_EQ(fields[i].GetSerializedSize(), kernels.get_serialized_size(fields[i]));
+      ASSERT_EQ(fields[i].SerializeTo(lhs_buf), kernels.serialize_to(fields[i], rhs_buf));
+      ASSERT_EQ(0, memcmp(lhs_buf, rhs_buf, fields[i].GetSerializedSize()));
+      for (size_t j = 0; j < count; j++) {
+        const Field &l = fields[i];
+        const Field &r = fields[j];
+        EXPECT_EQ(l.CompareEquals(r), GetCompareKernel(type, CompareOp::kEquals)(l, r));
+        EXPECT_EQ(l.CompareNotEquals(r), GetCompareKernel(type, CompareOp::kNotEquals)(l, r));
+        EXPECT_EQ(l.CompareLessThan(r), GetCompareKernel(type, CompareOp::kLessThan)(l, r));
+        EXPECT_EQ(l.CompareLessThanEquals(r), GetCompareKernel(type, CompareOp::kLessThanEquals)(l, r));
+        EXPECT_EQ(l.CompareGreaterThan(r), GetCompareKernel(type, CompareOp::kGreaterThan)(l, r));
+        EXPECT_EQ(l.CompareGreaterThanEquals(r), GetCompareKernel(type, CompareOp::kGreaterThanEquals)(l, r));
+        l.SerializeTo(lhs_buf);
+        r.SerializeTo(rhs_buf);
+        EXPECT_EQ(kernels.compare(l, r), kernels.compare_stored(lhs_buf, rhs_buf));
+        EXPECT_EQ(l.CompareLessThan(r) == kTrue, kernels.compare(l, r) < 0);
+        EXPECT_EQ(l.CompareEquals(r) == kTrue, kernels.compare(l, r) == 0);
+      }
+    }
+  };
+  check(int_fields, 5, kTypeInt);
+  check(float_fields, 4, kTypeFloat);
+  check(char_fields, 4, kTypeChar);
+  // null与任何值比较都是kNull
+  EXPECT_EQ(kNull, GetCompareKernel(kTypeInt, CompareOp::kEquals)(null_fields[0], int_fields[0]));
+  EXPECT_EQ(kNull, GetCompareKernel(kTypeChar, CompareOp::kLessThan)(char_fields[1], null_fields[2]));
+}
@@ -1,10 +1,14 @@
 #include "storage/table_heap.h"
 
+#include <algorithm>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
+#include "page/disk_file_meta_page.h"
 #include "record/field.h"
 #include "record/schema.h"
 #include "utils/utils.h"
@@ -47,6 +51,17 @@ TEST(TableHeapTest, TableHeapSampleTest) {
 
   ASSERT_EQ(row_nums, row_values.size());
   ASSERT_EQ(row_nums, size);
+  // full scan visits every row once and leaves no page pinned
+  {
+    uint32_t scanned = 0;
+    for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+      ASSERT_NE(row_values.end(), row_values.find(iter->GetRowId().Get()));
+      ASSERT_EQ(CmpBool::kTrue, iter->GetField(0)->CompareEquals(row_values[iter->GetRowId().Get()]->at(0)));
+      scanned++;
+    }
+    ASSERT_EQ(row_nums, scanned);
+    ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  }
   for (auto row_kv : row_values) {
     size--;
     Row row(RowId(row_kv.first));
@@ -59,4 +74,262 @@ TEST(TableHeapTest, TableHeapSampleTest) {
     delete row_kv.second;
   }
   ASSERT_EQ(size, 0);
+  // a char value longer than its column can neither be inserted nor written by an update
+  char long_name[65];
+  memset(long_name, 'a', sizeof(long_name));
+  Fields too_long{Field(TypeId::kTypeInt, row_nums), Field(TypeId::kTypeChar, long_name, 65, true),
+                  Field(TypeId::kTypeFloat, 0.f)};
+  Row long_row(too_long);
+  ASSERT_FALSE(table_heap->InsertTuple(long_row, nullptr));
+  ASSERT_FALSE(table_heap->UpdateTuple(long_row, RowId(row_values.begin()->first), nullptr));
+}
+
+TEST(TableHeapTest, PaxTableHeapTest) {
+  DBStorageEngine engine(db_file_name);
+  const int row_nums = 1000;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap =
+      TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, TableLayout::kPax);
+  std::unordered_map<int64_t, Fields *> row_values;
+  for (int i = 0; i < row_nums; i++) {
+    int32_t len = RandomUtils::RandomInt(0, 64);
+    char *characters = new char[len];
+    RandomUtils::RandomString(characters, len);
+    Fields *fields =
+        new Fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(characters), len, true),
+                   i % 10 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, static_cast<float>(i))};
+    Row row(*fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_values.emplace(row.GetRowId().Get(), fields);
+    delete[] characters;
+  }
+  // a char value longer than the declared length does not fit the fixed width minipage
+  char too_long[65] = {0};
+  Fields long_fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, too_long, 65, true),
+                     Field(TypeId::kTypeFloat, 0.f)};
+  Row long_row(long_fields);
+  ASSERT_FALSE(table_heap->InsertTuple(long_row, nullptr));
+
+  for (auto row_kv : row_values) {
+    Row row(RowId(row_kv.first));
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    for (size_t j = 0; j < schema->GetColumnCount(); j++) {
+      ASSERT_EQ(row_kv.second->at(j).IsNull(), row.GetField(j)->IsNull());
+      if (!row.GetField(j)->IsNull()) {
+        ASSERT_EQ(CmpBool::kTrue, row.GetField(j)->CompareEquals(row_kv.second->at(j)));
+      }
+    }
+  }
+  // projected scan only decodes the account minipage
+  std::vector<uint32_t> column_ids{2};
+  uint32_t scanned = 0;
+  for (auto iter = table_heap->Begin(nullptr, &column_ids); iter != table_heap->End(); ++iter) {
+    ASSERT_EQ(nullptr, iter->GetField(0));
+    ASSERT_NE(nullptr, iter->GetField(2));
+    scanned++;
+  }
+  ASSERT_EQ(row_nums, scanned);
+  // deleted slots are no longer visible
+  auto first = row_values.begin();
+  ASSERT_TRUE(table_heap->MarkDelete(RowId(first->first), nullptr));
+  table_heap->ApplyDelete(RowId(first->first), nullptr);
+  Row deleted(RowId(first->first));
+  ASSERT_FALSE(table_heap->GetTuple(&deleted, nullptr));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  for (auto row_kv : row_values) {
+    delete row_kv.second;
+  }
+  delete table_heap;
+}
+
+TEST(TableHeapTest, ForwardedUpdateTest) {
+  DBStorageEngine engine(db_file_name);
+  const int row_nums = 100;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 2000, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr);
+  char name[2000];
+  memset(name, 'a', sizeof(name));
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, 100, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // the first page is full, growing a row on it moves the row but keeps its rid
+  // (values stay below TUPLE_INLINE_VALUE_MAX, longer ones would go to overflow pages)
+  RowId rid = rids[0];
+  for (uint32_t len : {200u, TUPLE_INLINE_VALUE_MAX, 50u}) {
+    memset(name, 'a' + len % 26, len);
+    Fields fields{Field(TypeId::kTypeInt, 0), Field(TypeId::kTypeChar, name, len, true)};
+    ASSERT_TRUE(table_heap->UpdateTuple(Row(fields), rid, nullptr));
+    Row row(rid);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(rid, row.GetRowId());
+    ASSERT_EQ(len, row.GetField(1)->GetLength());
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(fields[1]));
+  }
+  // a scan sees the moved row once, under its original rid
+  uint32_t scanned = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    ASSERT_EQ(rids[scanned], iter->GetRowId());
+    scanned++;
+  }
+  ASSERT_EQ(row_nums, scanned);
+  // deleting through the forward removes the moved row as well
+  ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+  table_heap->ApplyDelete(rid, nullptr);
+  Row deleted(rid);
+  ASSERT_FALSE(table_heap->GetTuple(&deleted, nullptr));
+  scanned = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    scanned++;
+  }
+  ASSERT_EQ(row_nums - 1, scanned);
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  delete table_heap;
+}
+
+TEST(TableHeapTest, CrossForwardConcurrentTest) {
+  DBStorageEngine engine(db_file_name);
+  const int row_nums = 100;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 2000, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr);
+  char name[2000];
+  memset(name, 'a', sizeof(name));
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, 100, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  page_id_t first = rids[0].GetPageId();
+  auto second_begin = std::find_if(rids.begin(), rids.end(), [&](const RowId &rid) { return rid.GetPageId() != first; });
+  ASSERT_NE(rids.end(), second_begin);
+  int second = static_cast<int>(second_begin - rids.begin());
+  page_id_t second_page = rids[second].GetPageId();
+  auto remove = [&](std::initializer_list<int> ids) {
+    for (int i : ids) {
+      ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+      table_heap->ApplyDelete(rids[i], nullptr);
+    }
+  };
+  auto update = [&](const RowId &rid, int id, uint32_t len, char c) {
+    std::vector<char> value(len, c);
+    Fields fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar, value.data(), len, true)};
+    return table_heap->UpdateTuple(Row(fields), rid, nullptr);
+  };
+  // forward a row of each page to the other one: make room on one page, then grow a row of the other
+  // (values stay below TUPLE_INLINE_VALUE_MAX, so they cannot shrink into overflow references)
+  RowId down = rids[second], up = rids[0];
+  remove({1, 2, 3, 4, 5});
+  ASSERT_TRUE(update(down, second, 250, 'd'));
+  for (bool filled = false; !filled;) {
+    Fields fields{Field(TypeId::kTypeInt, row_nums), Field(TypeId::kTypeChar, name, 1, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    filled = row.GetRowId().GetPageId() != first;
+  }
+  remove({second + 1, second + 2, second + 3, second + 4, second + 5});
+  ASSERT_TRUE(update(up, 0, 250, 'u'));
+  auto forward_page = [&](const RowId &rid) {
+    auto page = reinterpret_cast<TablePage *>(engine.bpm_->FetchPage(rid.GetPageId()));
+    RowId target;
+    page_id_t res = page->GetForward(rid, &target) ? target.GetPageId() : INVALID_PAGE_ID;
+    engine.bpm_->UnpinPage(rid.GetPageId(), false);
+    return res;
+  };
+  ASSERT_EQ(first, forward_page(down));
+  ASSERT_EQ(second_page, forward_page(up));
+  // each thread latches its row's home page and the forward target, in opposite page orders
+  std::vector<std::thread> threads;
+  for (auto [rid, id, c] : {std::make_tuple(down, second, 'x'), std::make_tuple(up, 0, 'y')}) {
+    threads.emplace_back([&, rid = rid, id = id, c = c] {
+      for (int i = 0; i < 2000; i++) {
+        ASSERT_TRUE(update(rid, id, 250, static_cast<char>(c + i % 2)));
+        Row row(rid);
+        ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+        ASSERT_EQ(250u, row.GetField(1)->GetLength());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(first, forward_page(down));
+  ASSERT_EQ(second_page, forward_page(up));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  delete table_heap;
+}
+
+TEST(TableHeapTest, OverflowValueTest) {
+  DBStorageEngine engine(db_file_name);
+  auto meta_page = reinterpret_cast<DiskFileMetaPage *>(engine.disk_mgr_->GetMetaData());
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("body", TypeId::kTypeChar, 5 * PAGE_SIZE, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr);
+  uint32_t empty_pages = meta_page->GetAllocatedPages();
+  auto random_body = [](size_t len) {
+    std::string body(len, ' ');
+    RandomUtils::RandomString(body.data(), len);
+    return body;
+  };
+  // values larger than a page are stored in overflow pages, short ones stay inline
+  std::vector<std::string> bodies;
+  std::vector<RowId> rids;
+  for (uint32_t len : {3u * PAGE_SIZE + 7, 10u, 4u * PAGE_SIZE, TUPLE_INLINE_VALUE_MAX + 1}) {
+    bodies.emplace_back(random_body(len));
+    Fields fields{Field(TypeId::kTypeInt, static_cast<int32_t>(rids.size())),
+                  Field(TypeId::kTypeChar, bodies.back().data(), len, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // all rows share the first table page
+  for (auto &rid : rids) {
+    ASSERT_EQ(table_heap->GetFirstPageId(), rid.GetPageId());
+  }
+  uint32_t used_pages = meta_page->GetAllocatedPages();
+  ASSERT_EQ(empty_pages + 4 + 5 + 1, used_pages);
+  for (size_t i = 0; i < rids.size(); i++) {
+    Row row(rids[i]);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(bodies[i], row.GetField(1)->toString());
+    ASSERT_FALSE(row.GetField(1)->IsOverflow());
+  }
+  size_t scanned = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter, ++scanned) {
+    ASSERT_EQ(bodies[scanned], iter->GetField(1)->toString());
+  }
+  ASSERT_EQ(bodies.size(), scanned);
+  // a projected read does not touch the long column
+  std::vector<uint32_t> column_ids{0};
+  Row id_only(rids[0]);
+  ASSERT_TRUE(table_heap->GetTuple(&id_only, column_ids, nullptr));
+  ASSERT_EQ(nullptr, id_only.GetField(1));
+  // updating a long value releases the old chain
+  bodies[0] = random_body(PAGE_SIZE + 1);
+  Fields fields{Field(TypeId::kTypeInt, 0), Field(TypeId::kTypeChar, bodies[0].data(), bodies[0].size(), true)};
+  ASSERT_TRUE(table_heap->UpdateTuple(Row(fields), rids[0], nullptr));
+  ASSERT_EQ(used_pages - 2, meta_page->GetAllocatedPages());
+  Row updated(rids[0]);
+  ASSERT_TRUE(table_heap->GetTuple(&updated, nullptr));
+  ASSERT_EQ(bodies[0], updated.GetField(1)->toString());
+  // deleting the rows frees their chains
+  for (auto &rid : rids) {
+    ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+    table_heap->ApplyDelete(rid, nullptr);
+  }
+  ASSERT_EQ(empty_pages, meta_page->GetAllocatedPages());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  delete table_heap;
 }